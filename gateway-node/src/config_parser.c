@@ -0,0 +1,334 @@
+#include "config_parser.h"
+#include <string.h>
+
+typedef enum
+{
+    STATE_VALUE,      // Expecting a value
+    STATE_NEXT_VALUE, // Expecting a value after a comma
+    STATE_KEY_OR_END, // Expecting a key or the end of an object
+    STATE_NEXT_KEY,   // Expecting a key after a comma
+    STATE_KEY,
+    STATE_COLON,
+    STATE_STRING,
+    STATE_NUMBER,
+    STATE_LITERAL,    // true, false or null
+    STATE_AFTER_VALUE,
+    STATE_DONE,
+    STATE_ERROR
+} parser_state_t;
+
+typedef enum
+{
+    KEY_UNKNOWN,
+    KEY_ID,
+    KEY_VERSION,
+    KEY_INTERVAL,
+    KEY_LED_STATE
+} parser_key_t;
+
+static bool _is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool _in_array(const config_parser_t *parser)
+{
+    return parser->depth > 0 && (parser->arrays & (1 << (parser->depth - 1)));
+}
+
+static bool _token_is(const config_parser_t *parser, const char *text)
+{
+    size_t len = strlen(text);
+    return !parser->overflow && parser->token_len == len && memcmp(parser->token, text, len) == 0;
+}
+
+static void _token_add(config_parser_t *parser, char c)
+{
+    if (parser->token_len < CONFIG_PARSER_MAX_TOKEN) {
+        parser->token[parser->token_len++] = c;
+    } else {
+        parser->overflow = true;
+    }
+}
+
+static void _token_reset(config_parser_t *parser)
+{
+    parser->token_len = 0;
+    parser->overflow = false;
+}
+
+static int _hex_nibble(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool _parse_id(const config_parser_t *parser, uint8_t uuid[16])
+{
+    if (parser->overflow || parser->token_len != 32) return false;
+    for (int i = 0; i < 16; i++) {
+        int high = _hex_nibble(parser->token[i * 2]);
+        int low = _hex_nibble(parser->token[i * 2 + 1]);
+        if (high < 0 || low < 0) return false;
+        uuid[i] = (high << 4) | low;
+    }
+    return true;
+}
+
+static bool _is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// Integer part of a non-negative JSON number with the exponent applied, so 3.7e5 is 370000 and 3.7 is 3.
+// Values above max are rejected rather than wrapped.
+static bool _parse_unsigned(const config_parser_t *parser, uint32_t max, uint32_t *value)
+{
+    if (parser->overflow) return false;
+    const char *token = parser->token;
+    uint8_t len = parser->token_len;
+
+    // Split into the digits of the mantissa, the number of them before the point and the exponent
+    uint8_t i = 0;
+    while (i < len && _is_digit(token[i])) i++;
+    uint8_t int_digits = i;
+    if (int_digits == 0) return false; // Also rejects negative numbers
+    uint8_t frac_start = i;
+    if (i < len && token[i] == '.') {
+        frac_start = ++i;
+        while (i < len && _is_digit(token[i])) i++;
+        if (i == frac_start) return false;
+    }
+    uint8_t mantissa_end = i;
+    int32_t exponent = 0;
+    if (i < len && (token[i] == 'e' || token[i] == 'E')) {
+        i++;
+        bool negative = i < len && token[i] == '-';
+        if (i < len && (token[i] == '-' || token[i] == '+')) i++;
+        uint8_t exp_start = i;
+        for (; i < len && _is_digit(token[i]); i++) {
+            if (exponent < 1000) exponent = exponent * 10 + (token[i] - '0');
+        }
+        if (i == exp_start) return false;
+        if (negative) exponent = -exponent;
+    }
+    if (i != len) return false;
+
+    // The integer part is the first int_digits + exponent digits of the mantissa, zero padded
+    int32_t keep = int_digits + exponent;
+    uint64_t result = 0;
+    for (int32_t digit = 0; digit < keep; digit++) {
+        char c = '0';
+        if (digit < int_digits) {
+            c = token[digit];
+        } else if (frac_start + digit - int_digits < mantissa_end) {
+            c = token[frac_start + digit - int_digits];
+        }
+        result = result * 10 + (c - '0');
+        if (result > max) return false;
+    }
+    *value = (uint32_t)result;
+    return true;
+}
+
+static void _finish_value(config_parser_t *parser, parser_state_t kind)
+{
+    if (parser->object_depth == 0 || parser->depth != parser->object_depth || parser->key == KEY_UNKNOWN) {
+        return;
+    }
+
+    if (parser->key == KEY_ID) {
+        if (kind == STATE_STRING) {
+            parser->has_id = _parse_id(parser, parser->config.uuid);
+        }
+        return;
+    }
+
+    // The nodes keep version and interval as 16 bit values
+    uint32_t max = parser->key == KEY_LED_STATE ? UINT32_MAX : UINT16_MAX;
+    uint32_t value;
+    if (kind == STATE_NUMBER) {
+        if (!_parse_unsigned(parser, max, &value)) return;
+    } else if (kind == STATE_LITERAL && (_token_is(parser, "true") || _token_is(parser, "false"))) {
+        value = _token_is(parser, "true");
+    } else {
+        return;
+    }
+
+    uint8_t tag = parser->key == KEY_VERSION    ? MESH_WIRE_FIELD_VERSION
+                  : parser->key == KEY_INTERVAL ? MESH_WIRE_FIELD_INTERVAL
+                                                : MESH_WIRE_FIELD_LED_STATE;
+    mesh_wire_set(&parser->config, tag, value);
+}
+
+static void _open(config_parser_t *parser, bool array)
+{
+    if (parser->depth == CONFIG_PARSER_MAX_DEPTH) {
+        parser->state = STATE_ERROR;
+        return;
+    }
+    // Config objects are the top level object or the objects of a top level array
+    bool config_level = !array && (parser->depth == 0 || (parser->depth == 1 && _in_array(parser)));
+    parser->depth++;
+    if (array) {
+        parser->arrays |= 1 << (parser->depth - 1);
+        parser->state = STATE_VALUE;
+    } else {
+        parser->arrays &= ~(1 << (parser->depth - 1));
+        parser->state = STATE_KEY_OR_END;
+    }
+    if (config_level) {
+        parser->object_depth = parser->depth;
+        parser->has_id = false;
+        mesh_wire_init(&parser->config, MESH_WIRE_MSG_CONFIG);
+    }
+}
+
+static void _close(config_parser_t *parser, bool array)
+{
+    if (parser->depth == 0 || _in_array(parser) != array) {
+        parser->state = STATE_ERROR;
+        return;
+    }
+    if (!array && parser->depth == parser->object_depth) {
+        parser->object_depth = 0;
+        parser->callback(&parser->config, parser->has_id, parser->ctx);
+    }
+    parser->depth--;
+    parser->state = parser->depth == 0 ? STATE_DONE : STATE_AFTER_VALUE;
+}
+
+// A scalar value ended, where to go next depends on the container it was in
+static void _after_scalar(config_parser_t *parser)
+{
+    parser->state = parser->depth == 0 ? STATE_DONE : STATE_AFTER_VALUE;
+}
+
+static void _step(config_parser_t *parser, char c)
+{
+    switch (parser->state) {
+    case STATE_VALUE:
+    case STATE_NEXT_VALUE:
+        if (_is_space(c)) break;
+        _token_reset(parser);
+        if (c == '{') {
+            _open(parser, false);
+        } else if (c == '[') {
+            _open(parser, true);
+        } else if (c == ']' && parser->state == STATE_VALUE) {
+            _close(parser, true); // Empty array
+        } else if (c == '"') {
+            parser->escape = false;
+            parser->state = STATE_STRING;
+        } else if (c == '-' || (c >= '0' && c <= '9')) {
+            _token_add(parser, c);
+            parser->state = STATE_NUMBER;
+        } else if (c >= 'a' && c <= 'z') {
+            _token_add(parser, c);
+            parser->state = STATE_LITERAL;
+        } else {
+            parser->state = STATE_ERROR;
+        }
+        break;
+
+    case STATE_KEY_OR_END:
+    case STATE_NEXT_KEY:
+        if (_is_space(c)) break;
+        if (c == '"') {
+            _token_reset(parser);
+            parser->escape = false;
+            parser->state = STATE_KEY;
+        } else if (c == '}' && parser->state == STATE_KEY_OR_END) {
+            _close(parser, false);
+        } else {
+            parser->state = STATE_ERROR;
+        }
+        break;
+
+    case STATE_KEY:
+    case STATE_STRING:
+        if (parser->escape) {
+            parser->escape = false;
+            _token_add(parser, c);
+        } else if (c == '\\') {
+            parser->escape = true;
+        } else if (c != '"') {
+            _token_add(parser, c);
+        } else if (parser->state == STATE_KEY) {
+            parser->key = KEY_UNKNOWN;
+            if (parser->depth == parser->object_depth) {
+                if (_token_is(parser, "id")) parser->key = KEY_ID;
+                else if (_token_is(parser, "version")) parser->key = KEY_VERSION;
+                else if (_token_is(parser, "interval")) parser->key = KEY_INTERVAL;
+                else if (_token_is(parser, "led_state")) parser->key = KEY_LED_STATE;
+            }
+            parser->state = STATE_COLON;
+        } else {
+            _finish_value(parser, STATE_STRING);
+            _after_scalar(parser);
+        }
+        break;
+
+    case STATE_COLON:
+        if (_is_space(c)) break;
+        parser->state = c == ':' ? STATE_VALUE : STATE_ERROR;
+        break;
+
+    case STATE_NUMBER:
+    case STATE_LITERAL:
+        if ((parser->state == STATE_NUMBER && ((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-'))
+            || (parser->state == STATE_LITERAL && c >= 'a' && c <= 'z')) {
+            _token_add(parser, c);
+            break;
+        }
+        _finish_value(parser, (parser_state_t)parser->state);
+        _after_scalar(parser);
+        _step(parser, c); // The character that ended the value belongs to what follows
+        break;
+
+    case STATE_AFTER_VALUE:
+        if (_is_space(c)) break;
+        if (c == ',') {
+            parser->state = _in_array(parser) ? STATE_NEXT_VALUE : STATE_NEXT_KEY;
+        } else if (c == '}' || c == ']') {
+            _close(parser, c == ']');
+        } else {
+            parser->state = STATE_ERROR;
+        }
+        break;
+
+    case STATE_DONE:
+        if (!_is_space(c)) parser->state = STATE_ERROR;
+        break;
+
+    default:
+        break;
+    }
+}
+
+void config_parser_init(config_parser_t *parser, config_parser_cb_t callback, void *ctx)
+{
+    memset(parser, 0, sizeof(config_parser_t));
+    parser->state = STATE_VALUE;
+    parser->callback = callback;
+    parser->ctx = ctx;
+}
+
+bool config_parser_feed(config_parser_t *parser, const char *data, size_t len)
+{
+    for (size_t i = 0; i < len && parser->state != STATE_ERROR; i++) {
+        _step(parser, data[i]);
+    }
+    return parser->state != STATE_ERROR;
+}
+
+bool config_parser_finish(config_parser_t *parser)
+{
+    // A top level number or literal only ends with the input
+    if (parser->depth == 0 && (parser->state == STATE_NUMBER || parser->state == STATE_LITERAL)) {
+        parser->state = STATE_DONE;
+    }
+    return parser->state == STATE_DONE;
+}
@@ -0,0 +1,89 @@
+/**
+ * @file
+ * Streaming parser for the node config JSON received on mesh/in.
+ *
+ * Accepts a single config object or an array of config objects:
+ *
+ *   {"id": "<32 hex digits>", "version": 3, "interval": 600, "led_state": 0}
+ *   [{"id": ...}, {"id": ...}]
+ *
+ * Input is fed in chunks as it arrives, the parser keeps no more than one token and never allocates.
+ * Numbers are cut to their integer part after applying the exponent, negative numbers and values a node can't store
+ * (above 65535 for version and interval) leave the field out. Unknown keys and nested values are skipped.
+ * Every config object is passed to a callback as soon as it closes,
+ * so configs before a syntax error in a batch are still delivered.
+ */
+
+#pragma once
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "stddef.h"
+#include "mesh_wire.h"
+
+/**
+ * @brief Deepest nesting the parser follows, deeper documents are rejected.
+ */
+#define CONFIG_PARSER_MAX_DEPTH 16
+
+/**
+ * @brief Longest key or value kept, longer ones are skipped. Fits a hex encoded uuid.
+ */
+#define CONFIG_PARSER_MAX_TOKEN 40
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief Called for every config object, in the order they appear.
+     *
+     * @param[in] config Config frame with the version, interval and led_state fields that were present.
+     * @param[in] has_id True if the object had a valid "id", the uuid of the frame is only set then.
+     * @param[in] ctx Context given to config_parser_init.
+     */
+    typedef void (*config_parser_cb_t)(const mesh_wire_frame_t *config, bool has_id, void *ctx);
+
+    /**
+     * @brief Parser state. Treat as opaque.
+     */
+    typedef struct
+    {
+        uint8_t state;
+        uint8_t depth;
+        uint8_t object_depth; ///< Depth of the config object being filled, 0 outside of one.
+        uint16_t arrays;      ///< Bit n - 1 set if nesting level n is an array.
+        uint8_t key;
+        bool escape;
+        bool overflow;
+        char token[CONFIG_PARSER_MAX_TOKEN];
+        uint8_t token_len;
+        bool has_id;
+        mesh_wire_frame_t config;
+        config_parser_cb_t callback;
+        void *ctx;
+    } config_parser_t;
+
+    /**
+     * @brief Start a new document.
+     */
+    void config_parser_init(config_parser_t *parser, config_parser_cb_t callback, void *ctx);
+
+    /**
+     * @brief Feed the next chunk of the document.
+     *
+     * @return False once the document is known to be malformed, the rest of it is ignored.
+     */
+    bool config_parser_feed(config_parser_t *parser, const char *data, size_t len);
+
+    /**
+     * @brief End of input.
+     *
+     * @return True if a complete document was parsed.
+     */
+    bool config_parser_finish(config_parser_t *parser);
+
+#ifdef __cplusplus
+}
+#endif
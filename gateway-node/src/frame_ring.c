@@ -0,0 +1,99 @@
+#include "frame_ring.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+typedef struct
+{
+    uint8_t len;
+    uint8_t data[MESH_WIRE_MAX_FRAME_SIZE];
+} frame_ring_record_t;
+
+struct frame_ring
+{
+    atomic_uint head; // Next record to write, only the producer stores it
+    atomic_uint tail; // Next record to read, the producer moves it too when dropping the oldest
+    frame_ring_policy_t policy;
+    atomic_uint pushed;
+    atomic_uint dropped_newest;
+    atomic_uint dropped_oldest;
+    atomic_uint high_water;
+    frame_ring_record_t records[FRAME_RING_CAPACITY];
+};
+
+_Static_assert((FRAME_RING_CAPACITY & (FRAME_RING_CAPACITY - 1)) == 0, "FRAME_RING_CAPACITY must be a power of two");
+
+frame_ring_t *frame_ring_create(frame_ring_policy_t policy)
+{
+    frame_ring_t *ring = calloc(1, sizeof(frame_ring_t));
+    if (ring == NULL) return NULL;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->pushed, 0);
+    atomic_init(&ring->dropped_newest, 0);
+    atomic_init(&ring->dropped_oldest, 0);
+    atomic_init(&ring->high_water, 0);
+    ring->policy = policy;
+    return ring;
+}
+
+bool frame_ring_push(frame_ring_t *ring, const uint8_t *data, size_t len)
+{
+    if (len > MESH_WIRE_MAX_FRAME_SIZE) return false;
+
+    // Indexes run freely and wrap at 2^32, the difference is the fill level
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - tail == FRAME_RING_CAPACITY) {
+        if (ring->policy == FRAME_RING_DROP_NEWEST) {
+            atomic_fetch_add_explicit(&ring->dropped_newest, 1, memory_order_relaxed);
+            return false;
+        }
+        // If the swap fails the consumer just took the oldest record, which makes room as well
+        if (atomic_compare_exchange_strong_explicit(&ring->tail, &tail, tail + 1, memory_order_acq_rel, memory_order_acquire)) {
+            atomic_fetch_add_explicit(&ring->dropped_oldest, 1, memory_order_relaxed);
+        }
+    }
+
+    frame_ring_record_t *record = &ring->records[head & (FRAME_RING_CAPACITY - 1)];
+    record->len = len;
+    memcpy(record->data, data, len);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+    atomic_fetch_add_explicit(&ring->pushed, 1, memory_order_relaxed);
+    unsigned level = head + 1 - atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if (level > atomic_load_explicit(&ring->high_water, memory_order_relaxed)) {
+        atomic_store_explicit(&ring->high_water, level, memory_order_relaxed);
+    }
+    return true;
+}
+
+bool frame_ring_pop(frame_ring_t *ring, uint8_t *data, size_t *len)
+{
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    while (1) {
+        unsigned head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (tail == head) return false;
+
+        const frame_ring_record_t *record = &ring->records[tail & (FRAME_RING_CAPACITY - 1)];
+        uint8_t record_len = record->len;
+        if (record_len > MESH_WIRE_MAX_FRAME_SIZE) record_len = MESH_WIRE_MAX_FRAME_SIZE;
+        memcpy(data, record->data, record_len);
+
+        // Fails if the producer dropped this record meanwhile, the copy may be torn then, tail is reloaded
+        if (atomic_compare_exchange_strong_explicit(&ring->tail, &tail, tail + 1, memory_order_acq_rel, memory_order_acquire)) {
+            *len = record_len;
+            return true;
+        }
+    }
+}
+
+void frame_ring_get_stats(frame_ring_t *ring, frame_ring_stats_t *stats)
+{
+    stats->pushed = atomic_load_explicit(&ring->pushed, memory_order_relaxed);
+    stats->dropped_newest = atomic_load_explicit(&ring->dropped_newest, memory_order_relaxed);
+    stats->dropped_oldest = atomic_load_explicit(&ring->dropped_oldest, memory_order_relaxed);
+    stats->high_water = atomic_load_explicit(&ring->high_water, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    stats->queued = atomic_load_explicit(&ring->head, memory_order_acquire) - tail;
+}
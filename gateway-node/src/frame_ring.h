@@ -0,0 +1,86 @@
+/**
+ * @file
+ * Bounded single producer, single consumer queue of mesh_wire frames.
+ *
+ * Connects the UART task, which must never block, with the MQTT publish task, which may wait on the network.
+ * Records have a fixed size and are copied in and out, there is no locking and no allocation after creation.
+ *
+ * When the queue is full the configured policy decides what is lost:
+ *   - FRAME_RING_DROP_NEWEST: the frame being pushed is rejected.
+ *   - FRAME_RING_DROP_OLDEST: the oldest queued frame is discarded to make room. The producer moves the read
+ *     index with a compare-and-swap, a consumer that was copying that record at the same time notices the failed
+ *     swap and retries with the next one.
+ */
+
+#pragma once
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "stddef.h"
+#include "mesh_wire.h"
+
+/**
+ * @brief Number of records, must be a power of two.
+ */
+#define FRAME_RING_CAPACITY 32
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief What to drop when the queue is full.
+     */
+    typedef enum
+    {
+        FRAME_RING_DROP_NEWEST,
+        FRAME_RING_DROP_OLDEST
+    } frame_ring_policy_t;
+
+    /**
+     * @brief Queue counters.
+     */
+    typedef struct
+    {
+        uint32_t pushed;         ///< Frames accepted.
+        uint32_t dropped_newest; ///< Frames rejected because the queue was full.
+        uint32_t dropped_oldest; ///< Queued frames discarded to make room.
+        uint32_t high_water;     ///< Highest number of queued frames seen.
+        uint32_t queued;         ///< Frames queued now.
+    } frame_ring_stats_t;
+
+    typedef struct frame_ring frame_ring_t;
+
+    /**
+     * @brief Allocate an empty queue.
+     *
+     * @return The queue, NULL if there is not enough memory.
+     */
+    frame_ring_t *frame_ring_create(frame_ring_policy_t policy);
+
+    /**
+     * @brief Queue a frame. Producer side only.
+     *
+     * @return False if the frame was dropped or is longer than MESH_WIRE_MAX_FRAME_SIZE.
+     */
+    bool frame_ring_push(frame_ring_t *ring, const uint8_t *data, size_t len);
+
+    /**
+     * @brief Take the oldest frame. Consumer side only.
+     *
+     * @param[out] data Buffer of at least MESH_WIRE_MAX_FRAME_SIZE bytes.
+     * @param[out] len Frame length.
+     *
+     * @return False if the queue is empty.
+     */
+    bool frame_ring_pop(frame_ring_t *ring, uint8_t *data, size_t *len);
+
+    /**
+     * @brief Copy the counters, from any task.
+     */
+    void frame_ring_get_stats(frame_ring_t *ring, frame_ring_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,42 +1,336 @@
 #include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
+#include "freertos/semphr.h"
 #include "esp_system.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_random.h"
 #include "nvs_flash.h"
 #include "mqtt_client.h"
 #include "driver/uart.h"
 #include "cJSON.h"
 #include "secrets.h"
+#include "mesh_wire.h"
+#include "spool.h"
+#include "config_parser.h"
+#include "frame_ring.h"
+#include "publish_window.h"
 
 #define MQTT_BROKER_URL "mqtt://192.168.1.47"
 #define MQTT_PORT 1883
 #define MQTT_TOPIC_PUBLISH "mesh/out"
 #define MQTT_TOPIC_SUBSCRIBE "mesh/in"
+#define MQTT_TOPIC_TELEMETRY "mesh/telemetry"
+#define MQTT_TOPIC_BATCH "mesh/out/batch"
+#define MQTT_TOPIC_NODE_PREFIX "mesh/out/"
+#define MQTT_TOPIC_SNAPSHOT_GET "mesh/snapshot/get"
+#define MQTT_TOPIC_SNAPSHOT "mesh/snapshot"
+#define MQTT_TOPIC_CONFIG_PREFIX "mesh/in/"
+
+// Payload encoding, chosen per topic. Binary payloads are mesh_wire frames (see mesh_wire.h and mesh_wire.hpp)
+// in uuid form: node index 0 followed by the node's uuid, so consumers don't need the node table.
+#define PAYLOAD_JSON 0
+#define PAYLOAD_BINARY 1
+#define PAYLOAD_FORMAT_OUT PAYLOAD_JSON       // Readings on MQTT_TOPIC_PUBLISH or the per-node topics
+#define PAYLOAD_FORMAT_TELEMETRY PAYLOAD_JSON // Wake cost on MQTT_TOPIC_TELEMETRY, the binary frame is the whole reading
+
+// Publish every node's readings retained on its own topic, MQTT_TOPIC_NODE_PREFIX + id, instead of MQTT_TOPIC_PUBLISH
+#define PER_NODE_TOPICS 0
+
+// Batched publishing: readings are collected for up to BATCH_MAX_DELAY_MS or BATCH_MAX_RECORDS
+// and published as one message on MQTT_TOPIC_BATCH instead of one retained message each on MQTT_TOPIC_PUBLISH
+#define BATCH_MODE_OFF 0
+#define BATCH_MODE_JSON 1 // [{"id":...,"moisture":...}, ...]
+#define BATCH_MODE_LINE_PROTOCOL 2 // InfluxDB line protocol, one reading per line
+#define BATCH_MODE BATCH_MODE_OFF
+#define BATCH_MAX_RECORDS 32
+#define BATCH_MAX_DELAY_MS 1000
+#define BATCH_BUFFER_SIZE 4096
+#define BATCH_RECORD_SIZE 160
+#define BATCH_LINE_MEASUREMENT "soil"
+
+// Reconnect delay doubles with every failed attempt, a random half of it is cut off so gateways don't retry in sync
+#define WIFI_BACKOFF_BASE_MS 500
+#define WIFI_BACKOFF_MAX_MS 60000
+#define WIFI_CACHED_AP_ATTEMPTS 2 // Attempts on the last good BSSID and channel before scanning all channels
 
 #define UART_PORT UART_NUM_1
 #define UART_TX_PIN 17
 #define UART_RX_PIN 16
 #define BUF_SIZE 1024
+#define UART_FRAME_SYNC 0xA5
+
+// Readings spooled during an outage are published one by one at this rate once MQTT is back
+#define SPOOL_DRAIN_INTERVAL_MS 50
+#define SPOOL_ACK_TIMEOUT_MS 5000
+#define SPOOL_PUBLISHED_BIT BIT0
+#define SPOOL_ACKED_IDS 16 // PUBACKs remembered while the drain task waits for its own
+
+// Readings wait here between the UART task and the publish task, when it's full
+// FRAME_RING_DROP_OLDEST keeps the newest readings and FRAME_RING_DROP_NEWEST the oldest
+#define READING_QUEUE_DROP_POLICY FRAME_RING_DROP_OLDEST
+
+// Delivery guarantee and retain flag of one class of messages
+typedef struct {
+    int qos;
+    bool retain;
+} publish_policy;
+
+// MQTT settings of the gateway in one place
+typedef struct {
+    publish_policy reading;         // Live readings, consumers detect lost ones by gaps in "seq"
+    publish_policy reading_spooled; // Readings drained from the spool, QoS 1 since the spool waits for the PUBACK
+    publish_policy telemetry;
+    publish_policy batch;
+    publish_policy snapshot;
+    int subscribe_qos;              // Configs on mesh/in and mesh/in/<id>
+    int keepalive_s;
+    int buffer_size;                // Receive and send buffer of the MQTT client in bytes
+    int outbox_limit;               // Bytes of unacknowledged messages the MQTT client keeps, 0 for no limit
+    // Live readings go to the spool while any of these is reached, 0 for no limit
+    uint32_t inflight_limit;        // QoS > 0 publishes waiting for their PUBACK
+    uint32_t outbox_high_water;     // Bytes in the MQTT client outbox
+    uint32_t backlog_limit;         // Readings queued for the publish task, grows while QoS 0 publishes stall
+} gateway_config_t;
+
+static const gateway_config_t gateway_config = {
+    .reading = { .qos = 0, .retain = true },
+    .reading_spooled = { .qos = 1, .retain = true },
+    .telemetry = { .qos = 0, .retain = false },
+    .batch = { .qos = 1, .retain = false },
+    .snapshot = { .qos = 1, .retain = false },
+    .subscribe_qos = 1,
+    .keepalive_s = 30,
+    .buffer_size = 1024,
+    .outbox_limit = 16 * 1024,
+    .inflight_limit = 16,
+    .outbox_high_water = 12 * 1024,
+    .backlog_limit = FRAME_RING_CAPACITY / 2,
+};
 
 static const char *TAG = "mqtt_gateway";
 static esp_mqtt_client_handle_t mqtt_client = NULL;
+static volatile bool mqtt_connected = false;
+static publish_window_t *publish_window = NULL;
+
+// Access point of the last successful connection, saved in NVS so a reconnect can skip the scan
+typedef struct {
+    uint8_t bssid[6];
+    uint8_t channel;
+} wifi_ap_cache;
+
+typedef struct {
+    uint32_t count;
+    uint32_t last_ms;
+    uint32_t max_ms;
+    uint64_t total_ms;
+} reconnect_stats;
+
+static wifi_ap_cache cached_ap;
+static bool cached_ap_valid = false;
+static bool using_cached_ap = false;
+static esp_timer_handle_t wifi_reconnect_timer = NULL;
+static uint32_t wifi_attempts = 0;
+static int64_t wifi_outage_start_us = 0;
+static reconnect_stats wifi_stats = {};
+static EventGroupHandle_t spool_events = NULL;
+// Message ids of PUBACKs since the drain task's last publish. The PUBACK can arrive before
+// esp_mqtt_client_publish has returned the id, so the drain task looks its id up here afterwards.
+static int spool_acked_ids[SPOOL_ACKED_IDS];
+static uint32_t spool_acked_count = 0;
+static SemaphoreHandle_t spool_acked_mutex = NULL;
+static volatile bool snapshot_requested = false;
+static frame_ring_t *reading_queue = NULL;
+static TaskHandle_t publish_task_handle = NULL;
+
+// Topic of the MQTT message whose data is being received
+typedef enum {
+    TOPIC_OTHER,
+    TOPIC_CONFIG,
+    TOPIC_CONFIG_CACHE
+} data_topic_t;
+
+static data_topic_t data_topic = TOPIC_OTHER;
+static uint8_t data_topic_uuid[16];
+static config_parser_t config_parser;
+
+// Mesh carries only node indexes, uuids are looked up here at the MQTT boundary.
+// Enrollments come in on the UART task while the publish task, the drain task and the MQTT handler read the table,
+// so every access holds nodes_mutex.
+typedef struct {
+    bool enrolled;
+    uint8_t uuid[16];
+    char id_hex[33]; // Cached so readings don't hex-encode the uuid every time
+    uint32_t publish_seq;
+    // Last value cache, kept as the wire frame so the table stays small
+    uint8_t last_reading[MESH_WIRE_MAX_FRAME_SIZE];
+    uint8_t last_reading_len;
+    int64_t last_reading_us;
+} node_entry;
+
+static node_entry nodes[MESH_WIRE_MAX_NODES + 1];
+static SemaphoreHandle_t nodes_mutex = NULL;
+
+// Config of every node as pushed by the backend on the retained mesh/in/<id> topics.
+// Keyed by uuid since the backend may push a config before the node enrolls.
+// Each change is passed on to the master, which answers stale nodes while they are still listening.
+typedef struct {
+    bool valid;
+    mesh_wire_frame_t config;
+} config_entry;
+
+static config_entry configs[MESH_WIRE_MAX_NODES];
+static SemaphoreHandle_t configs_mutex = NULL;
+
+static void uart_write_frame(const uint8_t *data, uint8_t len);
+static void request_enroll_sync(void);
+
+static void id_to_hex(const uint8_t id[16], char out[33])
+{
+    static const char digits[] = "0123456789abcdef";
+    for (int i = 0; i < 16; i++) {
+        out[i*2] = digits[id[i] >> 4];
+        out[i*2 + 1] = digits[id[i] & 0x0F];
+    }
+    out[32] = '\0';
+}
+
+static int hex_nibble(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool hex_to_id(const char *hex, size_t len, uint8_t out[16])
+{
+    if (len != 32) return false;
+    for (int i = 0; i < 16; i++) {
+        int high = hex_nibble(hex[i*2]);
+        int low = hex_nibble(hex[i*2 + 1]);
+        if (high < 0 || low < 0) return false;
+        out[i] = (high << 4) | low;
+    }
+    return true;
+}
+
+static uint16_t find_node_index(const uint8_t uuid[16])
+{
+    uint16_t found = 0;
+    xSemaphoreTake(nodes_mutex, portMAX_DELAY);
+    for (uint16_t index = 1; index <= MESH_WIRE_MAX_NODES; index++) {
+        if (nodes[index].enrolled && memcmp(nodes[index].uuid, uuid, 16) == 0) {
+            found = index;
+            break;
+        }
+    }
+    xSemaphoreGive(nodes_mutex);
+    return found;
+}
+
+// Copies the uuid of an enrolled node, false if the index isn't enrolled
+static bool node_uuid(uint16_t index, uint8_t uuid[16])
+{
+    if (index < 1 || index > MESH_WIRE_MAX_NODES) return false;
+    xSemaphoreTake(nodes_mutex, portMAX_DELAY);
+    bool enrolled = nodes[index].enrolled;
+    if (enrolled) memcpy(uuid, nodes[index].uuid, 16);
+    xSemaphoreGive(nodes_mutex);
+    return enrolled;
+}
 
-typedef struct __attribute__((packed)) {
-    uint8_t id[16];
-    uint16_t moisture;
-    uint16_t version;
-} sensor_node_message;
+static void load_cached_ap(void)
+{
+    nvs_handle_t nvs_handle;
+    if (nvs_open("wifi", NVS_READONLY, &nvs_handle) != ESP_OK) {
+        return;
+    }
+    size_t size = sizeof(cached_ap);
+    cached_ap_valid = nvs_get_blob(nvs_handle, "last_ap", &cached_ap, &size) == ESP_OK && size == sizeof(cached_ap);
+    nvs_close(nvs_handle);
+}
 
-typedef struct __attribute__((packed)) {
-    uint8_t id[16];
-    uint16_t version;
-    uint16_t interval;
-    bool led_state;
-} node_config;
+static void save_cached_ap(void)
+{
+    wifi_ap_record_t ap_info;
+    if (esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK) {
+        return;
+    }
+    if (cached_ap_valid && memcmp(cached_ap.bssid, ap_info.bssid, 6) == 0 && cached_ap.channel == ap_info.primary) {
+        return;
+    }
+    memcpy(cached_ap.bssid, ap_info.bssid, 6);
+    cached_ap.channel = ap_info.primary;
+    cached_ap_valid = true;
+
+    nvs_handle_t nvs_handle;
+    if (nvs_open("wifi", NVS_READWRITE, &nvs_handle) != ESP_OK) {
+        return;
+    }
+    if (nvs_set_blob(nvs_handle, "last_ap", &cached_ap, sizeof(cached_ap)) != ESP_OK || nvs_commit(nvs_handle) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to save access point");
+    }
+    nvs_close(nvs_handle);
+}
+
+// Either connects straight to the cached access point or scans all channels for the SSID
+static void set_wifi_config(bool use_cached_ap)
+{
+    wifi_config_t wifi_config = { 0 };
+    strcpy((char*)wifi_config.sta.ssid, WIFI_SSID);
+    strcpy((char*)wifi_config.sta.password, WIFI_PASSWORD);
+    if (use_cached_ap && cached_ap_valid) {
+        wifi_config.sta.scan_method = WIFI_FAST_SCAN;
+        wifi_config.sta.bssid_set = 1;
+        memcpy(wifi_config.sta.bssid, cached_ap.bssid, 6);
+        wifi_config.sta.channel = cached_ap.channel;
+    } else {
+        wifi_config.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+        wifi_config.sta.bssid_set = 0;
+        wifi_config.sta.channel = 0;
+    }
+    wifi_config.sta.listen_interval = 0;
+    wifi_config.sta.pmf_cfg.capable = true;
+    wifi_config.sta.pmf_cfg.required = false;
+    wifi_config.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
+
+    using_cached_ap = use_cached_ap && cached_ap_valid;
+    esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+}
+
+static void wifi_reconnect_cb(void *arg)
+{
+    esp_wifi_connect();
+}
+
+static void schedule_wifi_reconnect(void)
+{
+    if (wifi_attempts == 0 && cached_ap_valid && !using_cached_ap) {
+        // New outage, the access point we were on is the best guess again
+        set_wifi_config(true);
+    } else if (using_cached_ap && wifi_attempts >= WIFI_CACHED_AP_ATTEMPTS) {
+        ESP_LOGI(TAG, "Cached access point not reachable, scanning");
+        set_wifi_config(false);
+    }
+
+    uint32_t delay_ms = WIFI_BACKOFF_MAX_MS;
+    if (wifi_attempts < 16) {
+        delay_ms = WIFI_BACKOFF_BASE_MS << wifi_attempts;
+        if (delay_ms > WIFI_BACKOFF_MAX_MS) delay_ms = WIFI_BACKOFF_MAX_MS;
+    }
+    delay_ms = delay_ms / 2 + esp_random() % (delay_ms / 2 + 1);
+    wifi_attempts++;
+
+    esp_timer_stop(wifi_reconnect_timer);
+    esp_timer_start_once(wifi_reconnect_timer, (uint64_t)delay_ms * 1000);
+}
 
 static void wifi_event_handler(void *arg, esp_event_base_t event_base,
                              int32_t event_id, void *event_data)
@@ -44,12 +338,112 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base,
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
         esp_wifi_connect();
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
-        esp_wifi_connect();
+        // Every failed attempt ends up here as well
+        if (wifi_outage_start_us == 0) {
+            wifi_outage_start_us = esp_timer_get_time();
+        }
+        schedule_wifi_reconnect();
     } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
         ESP_LOGI(TAG, "Connected to WiFi");
+        if (wifi_outage_start_us != 0) {
+            uint32_t latency_ms = (esp_timer_get_time() - wifi_outage_start_us) / 1000;
+            wifi_stats.count++;
+            wifi_stats.last_ms = latency_ms;
+            wifi_stats.total_ms += latency_ms;
+            if (latency_ms > wifi_stats.max_ms) wifi_stats.max_ms = latency_ms;
+            ESP_LOGI(TAG, "Reconnected after %lu ms in %lu attempts (%s), average %llu ms, max %lu ms over %lu outages",
+                latency_ms, wifi_attempts, using_cached_ap ? "cached AP" : "scan",
+                wifi_stats.total_ms / wifi_stats.count, wifi_stats.max_ms, wifi_stats.count);
+        }
+        wifi_outage_start_us = 0;
+        wifi_attempts = 0;
+        save_cached_ap();
+    }
+}
+
+static void send_config(mesh_wire_frame_t *config)
+{
+    // Falls back to addressing by uuid if the node is not enrolled yet
+    config->node_index = find_node_index(config->uuid);
+
+    uint8_t frame[MESH_WIRE_MAX_FRAME_SIZE];
+    size_t frame_len = mesh_wire_encode(config, frame, sizeof(frame));
+    if (frame_len) uart_write_frame(frame, frame_len);
+}
+
+static void cache_config(const mesh_wire_frame_t *config, bool remove)
+{
+    xSemaphoreTake(configs_mutex, portMAX_DELAY);
+    config_entry *free_entry = NULL;
+    config_entry *entry = NULL;
+    for (int i = 0; i < MESH_WIRE_MAX_NODES; i++) {
+        if (configs[i].valid && memcmp(configs[i].config.uuid, config->uuid, 16) == 0) {
+            entry = &configs[i];
+            break;
+        }
+        if (!configs[i].valid && free_entry == NULL) free_entry = &configs[i];
+    }
+    if (entry == NULL) entry = free_entry;
+
+    if (remove) {
+        if (entry) entry->valid = false;
+    } else if (entry) {
+        entry->config = *config;
+        entry->valid = true;
+    } else {
+        ESP_LOGW(TAG, "Config cache full");
+    }
+    xSemaphoreGive(configs_mutex);
+
+    // Without fields the master drops its entry too
+    mesh_wire_frame_t update = *config;
+    update.type = MESH_WIRE_MSG_CONFIG_CACHE;
+    send_config(&update);
+}
+
+// Master restarted and lost its copy of the cache
+static void push_config_cache(void)
+{
+    for (int i = 0; i < MESH_WIRE_MAX_NODES; i++) {
+        mesh_wire_frame_t config;
+        xSemaphoreTake(configs_mutex, portMAX_DELAY);
+        bool valid = configs[i].valid;
+        config = configs[i].config;
+        xSemaphoreGive(configs_mutex);
+
+        if (valid) {
+            config.type = MESH_WIRE_MSG_CONFIG_CACHE;
+            send_config(&config);
+        }
     }
 }
 
+// Called by the parser for every config object, ctx is the uuid from the topic for mesh/in/<id>
+static void on_config(const mesh_wire_frame_t *parsed, bool has_id, void *ctx)
+{
+    mesh_wire_frame_t config = *parsed;
+    if (ctx != NULL) {
+        memcpy(config.uuid, ctx, 16);
+        cache_config(&config, false);
+    } else if (has_id) {
+        send_config(&config);
+    } else {
+        ESP_LOGE(TAG, "Invalid node id");
+    }
+}
+
+// Binary config on mesh/in or mesh/in/<id>, a whole frame always fits in one MQTT_EVENT_DATA
+static void on_binary_config(const char *data, int data_len, void *ctx)
+{
+    mesh_wire_frame_t config;
+    if (!mesh_wire_decode(&config, (const uint8_t *)data, data_len) || config.type != MESH_WIRE_MSG_CONFIG) {
+        ESP_LOGE(TAG, "Invalid config frame");
+        return;
+    }
+    bool has_id = config.node_index == 0 || node_uuid(config.node_index, config.uuid);
+    on_config(&config, has_id, ctx);
+}
+
 static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data)
 {
     esp_mqtt_event_t *event = (esp_mqtt_event_t *)event_data;
@@ -57,43 +451,66 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
     switch (event->event_id) {
         case MQTT_EVENT_CONNECTED:
             ESP_LOGI(TAG, "MQTT Connected");
-            esp_mqtt_client_subscribe(mqtt_client, MQTT_TOPIC_SUBSCRIBE, 1);
+            esp_mqtt_client_subscribe(mqtt_client, MQTT_TOPIC_SUBSCRIBE, gateway_config.subscribe_qos);
+            esp_mqtt_client_subscribe(mqtt_client, MQTT_TOPIC_SNAPSHOT_GET, gateway_config.subscribe_qos);
+            esp_mqtt_client_subscribe(mqtt_client, MQTT_TOPIC_CONFIG_PREFIX "+", gateway_config.subscribe_qos);
+            mqtt_connected = true;
             break;
 
         case MQTT_EVENT_DISCONNECTED:
             ESP_LOGI(TAG, "MQTT Disconnected");
+            mqtt_connected = false;
+            publish_window_reset(publish_window);
             break;
 
+        case MQTT_EVENT_PUBLISHED: {
+            publish_window_acked(publish_window);
+            xSemaphoreTake(spool_acked_mutex, portMAX_DELAY);
+            spool_acked_ids[spool_acked_count++ % SPOOL_ACKED_IDS] = event->msg_id;
+            xSemaphoreGive(spool_acked_mutex);
+            xEventGroupSetBits(spool_events, SPOOL_PUBLISHED_BIT);
+            break;
+        }
+
         case MQTT_EVENT_DATA:
-            if (strncmp(event->topic, MQTT_TOPIC_SUBSCRIBE, event->topic_len) == 0) {
-                cJSON *root = cJSON_ParseWithLength(event->data, event->data_len);
-                if (root == NULL) {
-                    ESP_LOGE(TAG, "JSON Parse Error");
-                    return;
+            // Long payloads arrive in several events, only the first one carries the topic
+            if (event->current_data_offset == 0) {
+                data_topic = TOPIC_OTHER;
+                if ((size_t)event->topic_len == strlen(MQTT_TOPIC_SNAPSHOT_GET)
+                    && strncmp(event->topic, MQTT_TOPIC_SNAPSHOT_GET, event->topic_len) == 0) {
+                    // Served by the publish task, which may wait on the network
+                    snapshot_requested = true;
+                } else if ((size_t)event->topic_len == strlen(MQTT_TOPIC_CONFIG_PREFIX) + 32
+                           && strncmp(event->topic, MQTT_TOPIC_CONFIG_PREFIX, strlen(MQTT_TOPIC_CONFIG_PREFIX)) == 0
+                           && hex_to_id(event->topic + strlen(MQTT_TOPIC_CONFIG_PREFIX), 32, data_topic_uuid)) {
+                    data_topic = TOPIC_CONFIG_CACHE;
+                } else if ((size_t)event->topic_len == strlen(MQTT_TOPIC_SUBSCRIBE)
+                           && strncmp(event->topic, MQTT_TOPIC_SUBSCRIBE, event->topic_len) == 0) {
+                    data_topic = TOPIC_CONFIG;
                 }
+                config_parser_init(&config_parser, on_config, data_topic == TOPIC_CONFIG_CACHE ? data_topic_uuid : NULL);
+            }
 
-                node_config config;
-                memset(&config, 0, sizeof(config));
-
-                cJSON *id = cJSON_GetObjectItem(root, "id");
-                if (id && id->valuestring) {
-                    for (int i = 0; i < 16; i++) {
-                        sscanf(&id->valuestring[i*2], "%2hhx", &config.id[i]);
-                    }
+            if (data_topic == TOPIC_CONFIG || data_topic == TOPIC_CONFIG_CACHE) {
+                // The schema version byte a binary frame starts with never starts a JSON document
+                if (event->current_data_offset == 0 && event->data_len > 0 && event->data[0] == MESH_WIRE_SCHEMA_VERSION) {
+                    on_binary_config(event->data, event->data_len, data_topic == TOPIC_CONFIG_CACHE ? data_topic_uuid : NULL);
+                    data_topic = TOPIC_OTHER;
+                    break;
+                }
+                config_parser_feed(&config_parser, event->data, event->data_len);
+                if (event->current_data_offset + event->data_len < event->total_data_len) {
+                    break;
+                }
+                if (data_topic == TOPIC_CONFIG_CACHE && event->total_data_len == 0) {
+                    // An empty retained message clears the topic, and with it the cached config
+                    mesh_wire_frame_t config;
+                    mesh_wire_init(&config, MESH_WIRE_MSG_CONFIG);
+                    memcpy(config.uuid, data_topic_uuid, 16);
+                    cache_config(&config, true);
+                } else if (!config_parser_finish(&config_parser)) {
+                    ESP_LOGE(TAG, "JSON Parse Error");
                 }
-
-                cJSON *version = cJSON_GetObjectItem(root, "version");
-                if (version) config.version = version->valueint;
-
-                cJSON *interval = cJSON_GetObjectItem(root, "interval");
-                if (interval) config.interval = interval->valueint;
-
-                cJSON *led_state = cJSON_GetObjectItem(root, "led_state");
-                if (led_state) config.led_state = led_state->valueint;
-
-                uart_write_bytes(UART_PORT, (const char*)&config, sizeof(node_config));
-
-                cJSON_Delete(root);
             }
             break;
 
@@ -114,19 +531,14 @@ static void init_wifi(void)
     ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_event_handler, NULL));
     ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &wifi_event_handler, NULL));
 
-    wifi_config_t wifi_config = { 0 };
-    strcpy((char*)wifi_config.sta.ssid, WIFI_SSID);
-    strcpy((char*)wifi_config.sta.password, WIFI_PASSWORD);
-    wifi_config.sta.scan_method = WIFI_FAST_SCAN;
-    wifi_config.sta.bssid_set = 0;
-    wifi_config.sta.channel = 0;
-    wifi_config.sta.listen_interval = 0;
-    wifi_config.sta.pmf_cfg.capable = true;
-    wifi_config.sta.pmf_cfg.required = false;
-    wifi_config.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
+    esp_timer_create_args_t timer_args = {};
+    timer_args.callback = wifi_reconnect_cb;
+    timer_args.name = "wifi_reconnect";
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &wifi_reconnect_timer));
 
+    load_cached_ap();
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
-    ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
+    set_wifi_config(true);
     ESP_ERROR_CHECK(esp_wifi_start());
 }
 
@@ -144,32 +556,494 @@ void init_uart() {
     uart_driver_install(UART_PORT, BUF_SIZE, BUF_SIZE, 0, NULL, 0);
 }
 
+// Frames are variable length, each one goes over UART as sync byte, length byte and payload
+static void uart_write_frame(const uint8_t *data, uint8_t len)
+{
+    // One write per frame, frames are sent from both the MQTT handler and the UART task
+    uint8_t buffer[2 + MESH_WIRE_MAX_FRAME_SIZE];
+    if (len > MESH_WIRE_MAX_FRAME_SIZE) return;
+    buffer[0] = UART_FRAME_SYNC;
+    buffer[1] = len;
+    memcpy(&buffer[2], data, len);
+    uart_write_bytes(UART_PORT, (const char *)buffer, len + 2);
+}
+
+static int uart_read_frame(uint8_t *buffer, TickType_t ticks_to_wait)
+{
+    uint8_t header = 0;
+    if (uart_read_bytes(UART_PORT, &header, 1, ticks_to_wait) != 1 || header != UART_FRAME_SYNC) {
+        return 0;
+    }
+    uint8_t len = 0;
+    if (uart_read_bytes(UART_PORT, &len, 1, 10 / portTICK_PERIOD_MS) != 1 || len == 0 || len > MESH_WIRE_MAX_FRAME_SIZE) {
+        return 0;
+    }
+    if (uart_read_bytes(UART_PORT, buffer, len, 20 / portTICK_PERIOD_MS) != len) {
+        return 0;
+    }
+    return len;
+}
+
+// Publishes with the given policy and counts QoS > 0 messages until their PUBACK
+static int mqtt_publish(const char *topic, const char *data, int len, const publish_policy &policy)
+{
+    int msg_id = esp_mqtt_client_publish(mqtt_client, topic, data, len, policy.qos, policy.retain);
+    if (msg_id > 0) {
+        publish_window_sent(publish_window, policy.qos);
+    }
+    return msg_id;
+}
+
+// Re-encodes a reading in uuid form for binary payloads, returns 0 if the node's uuid isn't known
+static size_t encode_public_frame(const mesh_wire_frame_t *msg, uint8_t *out, size_t size)
+{
+    mesh_wire_frame_t frame = *msg;
+    if (frame.node_index != 0) {
+        if (!node_uuid(frame.node_index, frame.uuid)) return 0;
+        frame.node_index = 0;
+    }
+    return mesh_wire_encode(&frame, out, size);
+}
+
+// Wake cost of a sensor node, sent along with every Nth reading
+static void publish_telemetry(const char *id_hex, const mesh_wire_frame_t *msg)
+{
+#if PAYLOAD_FORMAT_TELEMETRY == PAYLOAD_BINARY
+    uint8_t frame[MESH_WIRE_MAX_FRAME_SIZE];
+    size_t frame_len = encode_public_frame(msg, frame, sizeof(frame));
+    if (frame_len) {
+        mqtt_publish(MQTT_TOPIC_TELEMETRY, (const char *)frame, frame_len, gateway_config.telemetry);
+    }
+#else
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "id", id_hex);
+    cJSON_AddNumberToObject(root, "battery_mv", mesh_wire_get(msg, MESH_WIRE_FIELD_BATTERY_MV, 0));
+    cJSON_AddNumberToObject(root, "wake_ms", mesh_wire_get(msg, MESH_WIRE_FIELD_WAKE_MS, 0));
+    cJSON_AddNumberToObject(root, "send_attempts", mesh_wire_get(msg, MESH_WIRE_FIELD_SEND_ATTEMPTS, 0));
+    cJSON_AddNumberToObject(root, "config_rtt_ms", mesh_wire_get(msg, MESH_WIRE_FIELD_CONFIG_RTT_MS, 0));
+
+    char *json_string = cJSON_PrintUnformatted(root);
+    mqtt_publish(MQTT_TOPIC_TELEMETRY, json_string, 0, gateway_config.telemetry);
+
+    free(json_string);
+    cJSON_Delete(root);
+#endif
+}
+
+// Asks the master to resend the whole node table
+static void request_enroll_sync(void)
+{
+    mesh_wire_frame_t sync;
+    mesh_wire_init(&sync, MESH_WIRE_MSG_ENROLL_SYNC);
+
+    uint8_t frame[MESH_WIRE_MAX_FRAME_SIZE];
+    size_t frame_len = mesh_wire_encode(&sync, frame, sizeof(frame));
+    uart_write_frame(frame, frame_len);
+}
+
+// Copies the id a reading is published under, false if the node is not known yet
+static bool reading_id(const mesh_wire_frame_t *msg, char id_hex[33])
+{
+    if (msg->node_index == 0) {
+        id_to_hex(msg->uuid, id_hex);
+        return true;
+    }
+    if (msg->node_index > MESH_WIRE_MAX_NODES) return false;
+    xSemaphoreTake(nodes_mutex, portMAX_DELAY);
+    bool enrolled = nodes[msg->node_index].enrolled;
+    if (enrolled) memcpy(id_hex, nodes[msg->node_index].id_hex, 33);
+    xSemaphoreGive(nodes_mutex);
+    return enrolled;
+}
+
+// Number of the next reading published for a node, consumers detect lost readings by gaps.
+// Readings spooled from a batch that couldn't be published keep the number they had in it.
+static uint32_t next_publish_seq(const mesh_wire_frame_t *msg)
+{
+    if (mesh_wire_has(msg, MESH_WIRE_FIELD_SEQUENCE)) {
+        return mesh_wire_get(msg, MESH_WIRE_FIELD_SEQUENCE, 0);
+    }
+    // Not enrolled nodes share the unused entry 0. The publish and drain tasks both count here.
+    xSemaphoreTake(nodes_mutex, portMAX_DELAY);
+    uint32_t seq = ++nodes[msg->node_index <= MESH_WIRE_MAX_NODES ? msg->node_index : 0].publish_seq;
+    xSemaphoreGive(nodes_mutex);
+    return seq;
+}
+
+static cJSON *reading_json(const char *id_hex, const mesh_wire_frame_t *msg)
+{
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "id", id_hex);
+    cJSON_AddNumberToObject(root, "version", mesh_wire_get(msg, MESH_WIRE_FIELD_VERSION, 0));
+    cJSON_AddNumberToObject(root, "moisture", mesh_wire_get(msg, MESH_WIRE_FIELD_MOISTURE, 0));
+    // Optional sensors, only published when the node reports them
+    if (mesh_wire_has(msg, MESH_WIRE_FIELD_TEMPERATURE)) {
+        cJSON_AddNumberToObject(root, "temperature", mesh_wire_get_signed(msg, MESH_WIRE_FIELD_TEMPERATURE, 0) / 10.0);
+    }
+    if (mesh_wire_has(msg, MESH_WIRE_FIELD_BATTERY_MV)) {
+        cJSON_AddNumberToObject(root, "battery_mv", mesh_wire_get(msg, MESH_WIRE_FIELD_BATTERY_MV, 0));
+    }
+    return root;
+}
+
+#if BATCH_MODE != BATCH_MODE_OFF
+static char batch_buffer[BATCH_BUFFER_SIZE];
+static size_t batch_len = 0;
+static int batch_count = 0;
+static TickType_t batch_started = 0;
+// Wire frames of the readings in the batch, spooled if the batch can't be published
+static uint8_t batch_frames[BATCH_MAX_RECORDS][MESH_WIRE_MAX_FRAME_SIZE];
+static uint8_t batch_frame_lens[BATCH_MAX_RECORDS];
+
+// Writes one reading in the batch format, returns its length or 0 if it doesn't fit
+static size_t format_reading(char *out, size_t size, const char *id_hex, const mesh_wire_frame_t *msg, uint32_t seq)
+{
+#if BATCH_MODE == BATCH_MODE_JSON
+    cJSON *root = reading_json(id_hex, msg);
+    cJSON_AddNumberToObject(root, "seq", seq);
+    char *json_string = cJSON_PrintUnformatted(root);
+    size_t len = json_string ? strlen(json_string) : 0;
+    if (len >= size) {
+        len = 0;
+    } else if (len) {
+        memcpy(out, json_string, len + 1);
+    }
+    free(json_string);
+    cJSON_Delete(root);
+    return len;
+#else
+    // No timestamp, the database stamps the points when the batch arrives
+    int len = snprintf(out, size, BATCH_LINE_MEASUREMENT ",id=%s version=%lui,moisture=%lui,seq=%lui", id_hex,
+                       mesh_wire_get(msg, MESH_WIRE_FIELD_VERSION, 0), mesh_wire_get(msg, MESH_WIRE_FIELD_MOISTURE, 0), seq);
+    if (len > 0 && len < (int)size && mesh_wire_has(msg, MESH_WIRE_FIELD_TEMPERATURE)) {
+        int32_t temperature = mesh_wire_get_signed(msg, MESH_WIRE_FIELD_TEMPERATURE, 0);
+        len += snprintf(out + len, size - len, ",temperature=%s%ld.%ld", temperature < 0 ? "-" : "",
+                        labs(temperature) / 10, labs(temperature) % 10);
+    }
+    if (len > 0 && len < (int)size && mesh_wire_has(msg, MESH_WIRE_FIELD_BATTERY_MV)) {
+        len += snprintf(out + len, size - len, ",battery_mv=%lui", mesh_wire_get(msg, MESH_WIRE_FIELD_BATTERY_MV, 0));
+    }
+    return (len > 0 && len < (int)size) ? len : 0;
+#endif
+}
+
+// Publishes the collected readings as one message, or spools them if that fails. Only the publish task batches:
+// it flushes when the batch is full, when its 50 ms wait finds the batch older than BATCH_MAX_DELAY_MS, and
+// before a reading goes to the spool.
+static int batch_flush(void)
+{
+    if (batch_count == 0) return 0;
+    int msg_id = -1;
+    if (mqtt_connected) {
+#if BATCH_MODE == BATCH_MODE_JSON
+        batch_buffer[batch_len++] = ']';
+#endif
+        msg_id = mqtt_publish(MQTT_TOPIC_BATCH, batch_buffer, batch_len, gateway_config.batch);
+    }
+    if (msg_id < 0) {
+        // Same as a single reading, the drain task publishes them one by one once MQTT is back
+        for (int i = 0; i < batch_count; i++) {
+            if (spool_append(batch_frames[i], batch_frame_lens[i]) != ESP_OK) {
+                ESP_LOGE(TAG, "Failed to spool reading");
+            }
+        }
+    }
+    batch_len = 0;
+    batch_count = 0;
+    return msg_id;
+}
+
+static void batch_add(const uint8_t *frame, size_t frame_len, const char *id_hex, const mesh_wire_frame_t *msg)
+{
+    uint32_t seq = next_publish_seq(msg);
+    char record[BATCH_RECORD_SIZE];
+    size_t len = format_reading(record, sizeof(record), id_hex, msg, seq);
+    if (!len) return;
+
+    // Room for the separator and the closing bracket
+    if (batch_len + len + 2 > BATCH_BUFFER_SIZE) {
+        batch_flush();
+    }
+    if (batch_count == 0) {
+        batch_started = xTaskGetTickCount();
+#if BATCH_MODE == BATCH_MODE_JSON
+        batch_buffer[batch_len++] = '[';
+#endif
+    } else {
+        batch_buffer[batch_len++] = BATCH_MODE == BATCH_MODE_JSON ? ',' : '\n';
+    }
+    memcpy(&batch_buffer[batch_len], record, len);
+    batch_len += len;
+    // Numbered, so the reading keeps its seq if the batch ends up in the spool
+    mesh_wire_frame_t numbered = *msg;
+    mesh_wire_set(&numbered, MESH_WIRE_FIELD_SEQUENCE, seq);
+    size_t numbered_len = mesh_wire_encode(&numbered, batch_frames[batch_count], MESH_WIRE_MAX_FRAME_SIZE);
+    if (!numbered_len) {
+        memcpy(batch_frames[batch_count], frame, frame_len);
+        numbered_len = frame_len;
+    }
+    batch_frame_lens[batch_count] = numbered_len;
+    batch_count++;
+
+    if (batch_count >= BATCH_MAX_RECORDS) {
+        batch_flush();
+    }
+}
+#endif
+
+// Returns the message id of the reading, -1 if it could not be published
+static int publish_reading(const char *id_hex, const mesh_wire_frame_t *msg, const publish_policy &policy)
+{
+#if BATCH_MODE == BATCH_MODE_OFF
+#if PER_NODE_TOPICS
+    char topic[sizeof(MQTT_TOPIC_NODE_PREFIX) + 32];
+    snprintf(topic, sizeof(topic), MQTT_TOPIC_NODE_PREFIX "%s", id_hex);
+#else
+    const char *topic = MQTT_TOPIC_PUBLISH;
+#endif
+    uint32_t seq = next_publish_seq(msg);
+#if PAYLOAD_FORMAT_OUT == PAYLOAD_BINARY
+    mesh_wire_frame_t numbered = *msg;
+    mesh_wire_set(&numbered, MESH_WIRE_FIELD_SEQUENCE, seq);
+    uint8_t frame[MESH_WIRE_MAX_FRAME_SIZE];
+    size_t frame_len = encode_public_frame(&numbered, frame, sizeof(frame));
+    if (!frame_len) return -1;
+    int msg_id = mqtt_publish(topic, (const char *)frame, frame_len, policy);
+#else
+    cJSON *root = reading_json(id_hex, msg);
+    cJSON_AddNumberToObject(root, "seq", seq);
+    char *json_string = cJSON_PrintUnformatted(root);
+    int msg_id = mqtt_publish(topic, json_string, 0, policy);
+
+    free(json_string);
+    cJSON_Delete(root);
+#endif
+#else
+    // Spooled readings go out one per message so each one can be acked, still in the batch format
+    char payload[BATCH_RECORD_SIZE + 2];
+    size_t offset = BATCH_MODE == BATCH_MODE_JSON ? 1 : 0;
+    size_t len = format_reading(&payload[offset], BATCH_RECORD_SIZE, id_hex, msg, next_publish_seq(msg));
+    if (!len) return -1;
+#if BATCH_MODE == BATCH_MODE_JSON
+    payload[0] = '[';
+    payload[++len] = ']';
+    len++;
+#endif
+    int msg_id = mqtt_publish(MQTT_TOPIC_BATCH, payload, len, policy);
+#endif
+
+    if (mesh_wire_has(msg, MESH_WIRE_FIELD_WAKE_MS)) {
+        publish_telemetry(id_hex, msg);
+    }
+    return msg_id;
+}
+
+// Last reading of every enrolled node in one message, so a new subscriber doesn't wait for a full interval
+static void publish_snapshot(void)
+{
+    cJSON *root = cJSON_CreateArray();
+    int64_t now = esp_timer_get_time();
+    for (uint16_t index = 1; index <= MESH_WIRE_MAX_NODES; index++) {
+        // A copy, so the table isn't locked while cJSON allocates
+        xSemaphoreTake(nodes_mutex, portMAX_DELAY);
+        node_entry node = nodes[index];
+        xSemaphoreGive(nodes_mutex);
+
+        mesh_wire_frame_t msg;
+        if (!node.enrolled || !node.last_reading_len || !mesh_wire_decode(&msg, node.last_reading, node.last_reading_len)) {
+            continue;
+        }
+        cJSON *reading = reading_json(node.id_hex, &msg);
+        cJSON_AddNumberToObject(reading, "age_s", (now - node.last_reading_us) / 1000000);
+        cJSON_AddItemToArray(root, reading);
+    }
+
+    char *json_string = cJSON_PrintUnformatted(root);
+    mqtt_publish(MQTT_TOPIC_SNAPSHOT, json_string, 0, gateway_config.snapshot);
+
+    free(json_string);
+    cJSON_Delete(root);
+}
+
+// Only parses and routes frames, anything that can wait on the network is left to the publish task
 static void uart_rx_task(void *arg)
 {
-    uint8_t buffer[BUF_SIZE];
+    uint8_t buffer[MESH_WIRE_MAX_FRAME_SIZE];
     while (1) {
-        int len = uart_read_bytes(UART_PORT, buffer, BUF_SIZE - 1, 50 / portTICK_PERIOD_MS);
-        
-        if (len == sizeof(sensor_node_message)) {
-            sensor_node_message *msg = (sensor_node_message*)buffer;
-
-            char id_hex[33];
-            for(int i = 0; i < 16; i++) {
-                sprintf(&id_hex[i*2], "%02x", msg->id[i]);
+        int len = uart_read_frame(buffer, portMAX_DELAY);
+
+        mesh_wire_frame_t msg;
+        if (!len || !mesh_wire_decode(&msg, buffer, len)) {
+            continue;
+        }
+
+        if (msg.type == MESH_WIRE_MSG_ENROLL) {
+            uint32_t index = mesh_wire_get(&msg, MESH_WIRE_FIELD_NODE_INDEX, 0);
+            if (index >= 1 && index <= MESH_WIRE_MAX_NODES) {
+                char id_hex[33];
+                id_to_hex(msg.uuid, id_hex);
+                xSemaphoreTake(nodes_mutex, portMAX_DELAY);
+                memcpy(nodes[index].uuid, msg.uuid, 16);
+                memcpy(nodes[index].id_hex, id_hex, sizeof(id_hex));
+                nodes[index].enrolled = true;
+                xSemaphoreGive(nodes_mutex);
+                ESP_LOGI(TAG, "Node %lu is %s", index, id_hex);
             }
+        } else if (msg.type == MESH_WIRE_MSG_CONFIG_SYNC) {
+            push_config_cache();
+        } else if (msg.type == MESH_WIRE_MSG_READING) {
+            frame_ring_push(reading_queue, buffer, len);
+            xTaskNotifyGive(publish_task_handle);
+        }
+    }
+}
 
-            cJSON *root = cJSON_CreateObject();
-            cJSON_AddStringToObject(root, "id", id_hex);
-            cJSON_AddNumberToObject(root, "version", msg->version);
-            cJSON_AddNumberToObject(root, "moisture", msg->moisture);
+static void handle_reading(const uint8_t *frame, size_t len, const mesh_wire_frame_t *msg)
+{
+    if (msg->node_index >= 1 && msg->node_index <= MESH_WIRE_MAX_NODES) {
+        xSemaphoreTake(nodes_mutex, portMAX_DELAY);
+        memcpy(nodes[msg->node_index].last_reading, frame, len);
+        nodes[msg->node_index].last_reading_len = len;
+        nodes[msg->node_index].last_reading_us = esp_timer_get_time();
+        xSemaphoreGive(nodes_mutex);
+    }
 
-            char *json_string = cJSON_PrintUnformatted(root);
-            esp_mqtt_client_publish(mqtt_client, MQTT_TOPIC_PUBLISH, json_string, 0, 1, 1);
+    // Once something is spooled, newer readings queue up behind it to keep them in order.
+    // The spool also takes over while the broker or the socket can't keep up, whatever the QoS.
+    frame_ring_stats_t queue;
+    frame_ring_get_stats(reading_queue, &queue);
+    bool backpressure = !publish_window_open(publish_window, esp_mqtt_client_get_outbox_size(mqtt_client), queue.queued);
+    if (!mqtt_connected || spool_pending() > 0 || backpressure) {
+#if BATCH_MODE != BATCH_MODE_OFF
+        // Older readings first, into the spool as well if MQTT is down
+        batch_flush();
+#endif
+        if (spool_append(frame, len) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to spool reading");
+        }
+        return;
+    }
 
-            free(json_string);
-            cJSON_Delete(root);
+    char id_hex[33];
+    if (!reading_id(msg, id_hex)) {
+        ESP_LOGW(TAG, "Reading from unknown node %d", msg->node_index);
+        request_enroll_sync();
+        return;
+    }
+#if BATCH_MODE == BATCH_MODE_OFF
+    // Numbered first, so a reading that ends up in the spool keeps its seq
+    mesh_wire_frame_t numbered = *msg;
+    mesh_wire_set(&numbered, MESH_WIRE_FIELD_SEQUENCE, next_publish_seq(msg));
+    if (publish_reading(id_hex, &numbered, gateway_config.reading) < 0) {
+        // Outbox full or the connection just dropped, the drain task retries it
+        uint8_t numbered_frame[MESH_WIRE_MAX_FRAME_SIZE];
+        size_t numbered_len = mesh_wire_encode(&numbered, numbered_frame, sizeof(numbered_frame));
+        esp_err_t err = numbered_len ? spool_append(numbered_frame, numbered_len) : spool_append(frame, len);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to spool reading");
         }
-        vTaskDelay(10 / portTICK_PERIOD_MS);
+    }
+#else
+    batch_add(frame, len, id_hex, msg);
+    if (mesh_wire_has(msg, MESH_WIRE_FIELD_WAKE_MS)) {
+        publish_telemetry(id_hex, msg);
+    }
+#endif
+}
+
+static void publish_task(void *arg)
+{
+    uint8_t buffer[MESH_WIRE_MAX_FRAME_SIZE];
+    size_t len;
+    uint32_t reported_drops = 0;
+    while (1) {
+        // Woken by the UART task for every reading, the timeout drives batch flushes and snapshot requests
+        ulTaskNotifyTake(pdTRUE, 50 / portTICK_PERIOD_MS);
+
+        while (frame_ring_pop(reading_queue, buffer, &len)) {
+            mesh_wire_frame_t msg;
+            if (mesh_wire_decode(&msg, buffer, len)) {
+                handle_reading(buffer, len, &msg);
+            }
+        }
+
+#if BATCH_MODE != BATCH_MODE_OFF
+        if (batch_count > 0 && xTaskGetTickCount() - batch_started >= pdMS_TO_TICKS(BATCH_MAX_DELAY_MS)) {
+            batch_flush();
+        }
+#endif
+
+        if (snapshot_requested) {
+            snapshot_requested = false;
+            publish_snapshot();
+        }
+
+        frame_ring_stats_t stats;
+        frame_ring_get_stats(reading_queue, &stats);
+        uint32_t drops = stats.dropped_newest + stats.dropped_oldest;
+        if (drops != reported_drops) {
+            ESP_LOGW(TAG, "Reading queue full, %lu readings dropped so far (high water %lu)", drops, stats.high_water);
+            reported_drops = drops;
+        }
+    }
+}
+
+static bool spool_was_acked(int msg_id)
+{
+    bool acked = false;
+    xSemaphoreTake(spool_acked_mutex, portMAX_DELAY);
+    uint32_t count = spool_acked_count < SPOOL_ACKED_IDS ? spool_acked_count : SPOOL_ACKED_IDS;
+    for (uint32_t i = 0; i < count && !acked; i++) {
+        acked = spool_acked_ids[i] == msg_id;
+    }
+    xSemaphoreGive(spool_acked_mutex);
+    return acked;
+}
+
+// Publishes spooled readings oldest first, a record is only acked after the broker confirmed it
+static void spool_drain_task(void *arg)
+{
+    uint8_t frame[SPOOL_MAX_PAYLOAD];
+    size_t len;
+    while (1) {
+        if (!mqtt_connected || !spool_peek(frame, &len)) {
+            vTaskDelay(500 / portTICK_PERIOD_MS);
+            continue;
+        }
+
+        mesh_wire_frame_t msg;
+        char id_hex[33];
+        if (!mesh_wire_decode(&msg, frame, len) || !reading_id(&msg, id_hex)) {
+            ESP_LOGW(TAG, "Dropping spooled reading from unknown node");
+            request_enroll_sync();
+            spool_ack();
+            continue;
+        }
+
+        // PUBACKs from before the publish can't be ours, ids are reused once they wrap around
+        xSemaphoreTake(spool_acked_mutex, portMAX_DELAY);
+        spool_acked_count = 0;
+        xSemaphoreGive(spool_acked_mutex);
+        xEventGroupClearBits(spool_events, SPOOL_PUBLISHED_BIT);
+
+        int msg_id = publish_reading(id_hex, &msg, gateway_config.reading_spooled);
+        // QoS 0 has no PUBACK, the reading is as delivered as it gets once the client took it
+        bool acked = msg_id == 0 && gateway_config.reading_spooled.qos == 0;
+        TickType_t started = xTaskGetTickCount();
+        TickType_t timeout = pdMS_TO_TICKS(SPOOL_ACK_TIMEOUT_MS);
+        while (msg_id > 0 && !(acked = spool_was_acked(msg_id))) {
+            TickType_t waited = xTaskGetTickCount() - started;
+            if (waited >= timeout) {
+                break;
+            }
+            // Woken by every PUBACK, not only ours
+            xEventGroupWaitBits(spool_events, SPOOL_PUBLISHED_BIT, pdTRUE, pdTRUE, timeout - waited);
+        }
+        if (acked) {
+            spool_ack();
+        }
+
+        vTaskDelay(SPOOL_DRAIN_INTERVAL_MS / portTICK_PERIOD_MS);
     }
 }
 
@@ -182,16 +1056,36 @@ extern "C" void app_main(void)
     }
     ESP_ERROR_CHECK(ret);
 
+    // Without the spool readings received during an outage are lost, the gateway still runs
+    spool_init();
+    spool_events = xEventGroupCreate();
+    spool_acked_mutex = xSemaphoreCreateMutex();
+    configs_mutex = xSemaphoreCreateMutex();
+    nodes_mutex = xSemaphoreCreateMutex();
+    reading_queue = frame_ring_create(READING_QUEUE_DROP_POLICY);
+    publish_window_config_t window = {
+        .inflight_limit = gateway_config.inflight_limit,
+        .outbox_limit = gateway_config.outbox_high_water,
+        .backlog_limit = gateway_config.backlog_limit,
+    };
+    publish_window = publish_window_create(&window);
+
     init_wifi();
     init_uart();
 
     esp_mqtt_client_config_t mqtt_cfg = {};
     mqtt_cfg.broker.address.uri = MQTT_BROKER_URL;
     mqtt_cfg.broker.address.port = MQTT_PORT;
+    mqtt_cfg.session.keepalive = gateway_config.keepalive_s;
+    mqtt_cfg.buffer.size = gateway_config.buffer_size;
+    mqtt_cfg.outbox.limit = gateway_config.outbox_limit;
 
     mqtt_client = esp_mqtt_client_init(&mqtt_cfg);
     ESP_ERROR_CHECK(esp_mqtt_client_register_event(mqtt_client, MQTT_EVENT_ANY, mqtt_event_handler, NULL));
     ESP_ERROR_CHECK(esp_mqtt_client_start(mqtt_client));
 
+    request_enroll_sync();
+    xTaskCreate(publish_task, "publish_task", 4096, NULL, 8, &publish_task_handle);
     xTaskCreate(uart_rx_task, "uart_rx_task", 4096, NULL, 10, NULL);
+    xTaskCreate(spool_drain_task, "spool_drain_task", 4096, NULL, 5, NULL);
 }
@@ -0,0 +1,52 @@
+#include "publish_window.h"
+#include <stdlib.h>
+#include <stdatomic.h>
+
+struct publish_window
+{
+    publish_window_config_t config;
+    atomic_uint inflight; // Incremented by the publishing tasks, decremented by the MQTT event handler
+};
+
+publish_window_t *publish_window_create(const publish_window_config_t *config)
+{
+    publish_window_t *window = calloc(1, sizeof(publish_window_t));
+    if (window == NULL) return NULL;
+    window->config = *config;
+    atomic_init(&window->inflight, 0);
+    return window;
+}
+
+bool publish_window_open(publish_window_t *window, size_t outbox_bytes, uint32_t backlog)
+{
+    const publish_window_config_t *config = &window->config;
+    if (config->inflight_limit && publish_window_inflight(window) >= config->inflight_limit) return false;
+    if (config->outbox_limit && outbox_bytes >= config->outbox_limit) return false;
+    if (config->backlog_limit && backlog >= config->backlog_limit) return false;
+    return true;
+}
+
+void publish_window_sent(publish_window_t *window, int qos)
+{
+    if (qos > 0) {
+        atomic_fetch_add_explicit(&window->inflight, 1, memory_order_relaxed);
+    }
+}
+
+void publish_window_acked(publish_window_t *window)
+{
+    unsigned inflight = atomic_load_explicit(&window->inflight, memory_order_relaxed);
+    while (inflight > 0 && !atomic_compare_exchange_weak_explicit(&window->inflight, &inflight, inflight - 1,
+                                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+void publish_window_reset(publish_window_t *window)
+{
+    atomic_store_explicit(&window->inflight, 0, memory_order_relaxed);
+}
+
+uint32_t publish_window_inflight(publish_window_t *window)
+{
+    return atomic_load_explicit(&window->inflight, memory_order_relaxed);
+}
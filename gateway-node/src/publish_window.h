@@ -0,0 +1,75 @@
+/**
+ * @file
+ * Decides whether a live reading may be published right away or has to wait in the spool.
+ *
+ * Three signals close the window, each with its own limit, 0 disables a limit:
+ *   - QoS > 0 publishes waiting for their PUBACK, counted here.
+ *   - Bytes in the MQTT client outbox.
+ *   - Readings queued behind the one being handled. QoS 0 publishes get no PUBACK and skip the outbox while
+ *     connected, but they block the publish task while the socket is slow, so the queue grows behind them.
+ */
+
+#pragma once
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "stddef.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief Limits of the window.
+     */
+    typedef struct
+    {
+        uint32_t inflight_limit; ///< QoS > 0 publishes waiting for their PUBACK.
+        uint32_t outbox_limit;   ///< Bytes in the MQTT client outbox.
+        uint32_t backlog_limit;  ///< Readings waiting in the reading queue.
+    } publish_window_config_t;
+
+    typedef struct publish_window publish_window_t;
+
+    /**
+     * @brief Allocate a window with nothing in flight.
+     *
+     * @return The window, NULL if there is not enough memory.
+     */
+    publish_window_t *publish_window_create(const publish_window_config_t *config);
+
+    /**
+     * @brief Check all three limits.
+     *
+     * @param outbox_bytes Size of the MQTT client outbox.
+     * @param backlog Readings still queued for the publish task.
+     *
+     * @return True if a reading may be published now.
+     */
+    bool publish_window_open(publish_window_t *window, size_t outbox_bytes, uint32_t backlog);
+
+    /**
+     * @brief Count a publish that the client accepted, QoS 0 publishes are ignored.
+     */
+    void publish_window_sent(publish_window_t *window, int qos);
+
+    /**
+     * @brief Count a PUBACK, from any task. Never goes below 0, the client also resends messages from its outbox
+     * after a reconnect and those were not counted.
+     */
+    void publish_window_acked(publish_window_t *window);
+
+    /**
+     * @brief Forget everything in flight, on a disconnect.
+     */
+    void publish_window_reset(publish_window_t *window);
+
+    /**
+     * @brief QoS > 0 publishes waiting for their PUBACK.
+     */
+    uint32_t publish_window_inflight(publish_window_t *window);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,254 @@
+#include "spool.h"
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_partition.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+
+#define SPOOL_PARTITION_SUBTYPE 0x40
+#define SPOOL_SECTOR_SIZE 4096
+#define SPOOL_SLOT_SIZE 80
+
+#define SPOOL_STATE_ERASED 0xFF
+#define SPOOL_STATE_PENDING 0xFE
+#define SPOOL_STATE_ACKED 0xFC
+
+typedef struct __attribute__((packed))
+{
+    uint8_t state;
+    uint8_t len;
+    uint16_t reserved;
+    uint32_t seq;
+    uint32_t crc; // Over seq, len and payload
+    uint8_t payload[SPOOL_MAX_PAYLOAD];
+} spool_record_t;
+
+_Static_assert(sizeof(spool_record_t) <= SPOOL_SLOT_SIZE, "spool record does not fit in a slot");
+
+#ifndef SPOOL_HOST
+static const char *TAG = "spool";
+#endif
+
+static const esp_partition_t *_partition = NULL;
+static SemaphoreHandle_t _mutex = NULL;
+static uint32_t _slots_per_sector = 0;
+static uint32_t _slot_count = 0;
+static uint32_t _write_slot = 0;
+static uint32_t _read_slot = 0;
+static uint32_t _next_seq = 1;
+static spool_stats_t _stats = {0};
+
+static uint32_t _next_slot(uint32_t slot)
+{
+    return (slot + 1) % _slot_count;
+}
+
+static size_t _slot_offset(uint32_t slot)
+{
+    return (slot / _slots_per_sector) * SPOOL_SECTOR_SIZE + (slot % _slots_per_sector) * SPOOL_SLOT_SIZE;
+}
+
+static uint32_t _record_crc(const spool_record_t *record)
+{
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)&record->seq, sizeof(record->seq));
+    crc = esp_rom_crc32_le(crc, &record->len, sizeof(record->len));
+    return esp_rom_crc32_le(crc, record->payload, record->len);
+}
+
+// A record counts only if it was completely written, a torn write fails the CRC
+static bool _read_record(uint32_t slot, spool_record_t *record)
+{
+    if (esp_partition_read(_partition, _slot_offset(slot), record, sizeof(spool_record_t)) != ESP_OK) {
+        return false;
+    }
+    if (record->state != SPOOL_STATE_PENDING && record->state != SPOOL_STATE_ACKED) {
+        return false;
+    }
+    return record->len <= SPOOL_MAX_PAYLOAD && record->crc == _record_crc(record);
+}
+
+static bool _slot_is_erased(uint32_t slot)
+{
+    uint8_t buffer[SPOOL_SLOT_SIZE];
+    if (esp_partition_read(_partition, _slot_offset(slot), buffer, sizeof(buffer)) != ESP_OK) {
+        return false;
+    }
+    for (size_t i = 0; i < sizeof(buffer); i++) {
+        if (buffer[i] != SPOOL_STATE_ERASED) return false;
+    }
+    return true;
+}
+
+esp_err_t spool_init(void)
+{
+    _partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, SPOOL_PARTITION_SUBTYPE, "spool");
+    if (_partition == NULL) {
+        ESP_LOGE(TAG, "No spool partition");
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (_mutex == NULL) {
+        _mutex = xSemaphoreCreateMutex();
+    }
+    memset(&_stats, 0, sizeof(_stats));
+    _slots_per_sector = SPOOL_SECTOR_SIZE / SPOOL_SLOT_SIZE;
+    _slot_count = (_partition->size / SPOOL_SECTOR_SIZE) * _slots_per_sector;
+
+    // The newest record is the one with the highest sequence number, writing resumes right after it
+    spool_record_t record;
+    bool found = false;
+    uint32_t newest_slot = 0;
+    uint32_t newest_seq = 0;
+    for (uint32_t slot = 0; slot < _slot_count; slot++) {
+        if (_read_record(slot, &record) && (!found || record.seq > newest_seq)) {
+            found = true;
+            newest_slot = slot;
+            newest_seq = record.seq;
+        }
+    }
+
+    if (!found) {
+        _write_slot = 0;
+        _read_slot = 0;
+        _next_seq = 1;
+        ESP_LOGI(TAG, "Empty, %lu slots", _slot_count);
+        return ESP_OK;
+    }
+
+    _next_seq = newest_seq + 1;
+    _write_slot = _next_slot(newest_slot);
+
+    // Records are acked in order, so everything newer than the newest acked record is pending.
+    // Unreadable slots are walked past, a power loss can leave a torn one between two runs of pending records.
+    // A whole sector of them is not part of the log, it was never written since the partition was created.
+    uint32_t slot = newest_slot;
+    uint32_t newer_seq = newest_seq + 1;
+    uint32_t unreadable = 0;
+    for (uint32_t walked = 1; walked <= _slot_count && unreadable < _slots_per_sector; walked++) {
+        if (!_read_record(slot, &record)) {
+            // Counted only if an older pending record follows
+            unreadable++;
+        } else if (record.state != SPOOL_STATE_PENDING || record.seq >= newer_seq) {
+            break;
+        } else {
+            newer_seq = record.seq;
+            unreadable = 0;
+            _stats.pending = walked;
+            _read_slot = slot;
+        }
+        slot = (slot + _slot_count - 1) % _slot_count;
+    }
+
+    // Skip a slot that was torn by a power loss, it can't be programmed again until its sector is erased.
+    // Slots between the cursors are counted as pending either way, peeking drops the ones that don't hold a record.
+    while (_write_slot % _slots_per_sector != 0 && !_slot_is_erased(_write_slot)) {
+        _write_slot = _next_slot(_write_slot);
+        if (_stats.pending > 0) _stats.pending++;
+    }
+    if (_stats.pending == 0) {
+        _read_slot = _write_slot;
+    }
+
+    ESP_LOGI(TAG, "Recovered %lu pending records, next seq %lu", _stats.pending, _next_seq);
+    return ESP_OK;
+}
+
+esp_err_t spool_append(const uint8_t *data, size_t len)
+{
+    if (_partition == NULL) return ESP_ERR_INVALID_STATE;
+    if (len > SPOOL_MAX_PAYLOAD) return ESP_ERR_INVALID_SIZE;
+
+    spool_record_t record;
+    memset(&record, 0xFF, sizeof(record));
+    record.state = SPOOL_STATE_PENDING;
+    record.len = len;
+    record.seq = _next_seq;
+    memcpy(record.payload, data, len);
+    record.crc = _record_crc(&record);
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+
+    if (_write_slot % _slots_per_sector == 0) {
+        uint32_t sector = _write_slot / _slots_per_sector;
+        // Log is full, the sector ahead still holds the oldest pending records
+        while (_stats.pending > 0 && _read_slot / _slots_per_sector == sector) {
+            _read_slot = _next_slot(_read_slot);
+            _stats.pending--;
+            _stats.dropped++;
+        }
+        if (esp_partition_erase_range(_partition, sector * SPOOL_SECTOR_SIZE, SPOOL_SECTOR_SIZE) != ESP_OK) {
+            xSemaphoreGive(_mutex);
+            return ESP_FAIL;
+        }
+        _stats.erases++;
+    }
+
+    esp_err_t err = esp_partition_write(_partition, _slot_offset(_write_slot), &record, sizeof(record));
+    if (_stats.pending == 0) {
+        _read_slot = _write_slot;
+    }
+    // The slot and the sequence number are used up even if the write failed, it may still have left a valid
+    // record. Peeking skips the slot if it didn't.
+    _write_slot = _next_slot(_write_slot);
+    _stats.pending++;
+    _next_seq++;
+
+    xSemaphoreGive(_mutex);
+    return err == ESP_OK ? ESP_OK : ESP_FAIL;
+}
+
+bool spool_peek(uint8_t *data, size_t *len)
+{
+    if (_partition == NULL) return false;
+
+    spool_record_t record;
+    bool found = false;
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    while (_stats.pending > 0) {
+        if (_read_record(_read_slot, &record) && record.state == SPOOL_STATE_PENDING) {
+            memcpy(data, record.payload, record.len);
+            *len = record.len;
+            found = true;
+            break;
+        }
+        // Unreadable record, nothing to deliver
+        _read_slot = _next_slot(_read_slot);
+        _stats.pending--;
+    }
+    xSemaphoreGive(_mutex);
+
+    return found;
+}
+
+void spool_ack(void)
+{
+    if (_partition == NULL) return;
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    if (_stats.pending > 0) {
+        // Clearing one more bit of the state byte, no erase needed
+        uint8_t state = SPOOL_STATE_ACKED;
+        esp_partition_write(_partition, _slot_offset(_read_slot), &state, 1);
+        _read_slot = _next_slot(_read_slot);
+        _stats.pending--;
+    }
+    xSemaphoreGive(_mutex);
+}
+
+uint32_t spool_pending(void)
+{
+    return _stats.pending;
+}
+
+void spool_get_stats(spool_stats_t *stats)
+{
+    if (_partition == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    *stats = _stats;
+    stats->capacity = _slot_count;
+    xSemaphoreGive(_mutex);
+}
@@ -0,0 +1,96 @@
+/**
+ * @file
+ * Store-and-forward log for readings that arrive while the MQTT link is down.
+ *
+ * Records are kept in a circular append-only log on the "spool" data partition.
+ * Each record holds one mesh_wire frame, so a drained reading is published exactly as if it had just arrived.
+ *
+ * Record states are only ever cleared bit by bit, so they are updated in place without an erase:
+ *
+ *   0xFF erased -> 0xFE pending -> 0xFC acked
+ *
+ * The write cursor points at the next free slot and the ack cursor at the oldest pending record.
+ * Both are rebuilt from the partition on init, a record that was half written when power was lost
+ * fails its CRC and is skipped. A record whose ack did not reach flash is published again.
+ * Sectors are erased one by one just ahead of the write cursor, so every sector of the partition sees the same
+ * number of erases. When the log is full the oldest sector is erased and its pending records are dropped.
+ */
+
+#pragma once
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "stddef.h"
+#include "esp_err.h"
+
+/**
+ * @brief Largest payload a record can hold.
+ */
+#define SPOOL_MAX_PAYLOAD 64
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief Counters for the log.
+     */
+    typedef struct
+    {
+        uint32_t pending; ///< Slots between the ack cursor and the write cursor.
+        uint32_t capacity; ///< Total number of record slots in the partition.
+        uint32_t dropped; ///< Pending records lost because the log wrapped around since boot.
+        uint32_t erases; ///< Sector erases since boot.
+    } spool_stats_t;
+
+    /**
+     * @brief Find the spool partition and recover both cursors from it.
+     *
+     * @return
+     *              - ESP_OK if success
+     *              - ESP_ERR_NOT_FOUND if there is no spool partition
+     */
+    esp_err_t spool_init(void);
+
+    /**
+     * @brief Append a record at the write cursor.
+     *
+     * @param[in] data Pointer to the payload.
+     * @param[in] len Payload length, at most SPOOL_MAX_PAYLOAD.
+     *
+     * @return
+     *              - ESP_OK if success
+     *              - ESP_ERR_INVALID_SIZE if the payload is too long
+     *              - ESP_FAIL if the flash write failed
+     */
+    esp_err_t spool_append(const uint8_t *data, size_t len);
+
+    /**
+     * @brief Read the record at the ack cursor without removing it.
+     *
+     * @param[out] data Buffer of at least SPOOL_MAX_PAYLOAD bytes.
+     * @param[out] len Payload length.
+     *
+     * @return True if a pending record was read, false if the log is empty.
+     */
+    bool spool_peek(uint8_t *data, size_t *len);
+
+    /**
+     * @brief Mark the record at the ack cursor as delivered and move to the next one.
+     */
+    void spool_ack(void);
+
+    /**
+     * @brief Number of records that are waiting to be drained.
+     */
+    uint32_t spool_pending(void);
+
+    /**
+     * @brief Copy the log counters.
+     */
+    void spool_get_stats(spool_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,11 @@
+#pragma once
+
+// Host stand-ins for the ESP-IDF headers spool.c includes, see test/test_spool
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_INVALID_SIZE 0x104
+#define ESP_ERR_NOT_FOUND 0x105
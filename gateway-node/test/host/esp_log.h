@@ -0,0 +1,5 @@
+#pragma once
+
+#define ESP_LOGE(tag, format, ...) do { } while (0)
+#define ESP_LOGW(tag, format, ...) do { } while (0)
+#define ESP_LOGI(tag, format, ...) do { } while (0)
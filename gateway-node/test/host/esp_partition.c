@@ -0,0 +1,44 @@
+#include "esp_partition.h"
+#include <string.h>
+
+// Simulated NOR flash: programming only clears bits, an erase sets a whole sector back to 0xFF.
+// Built into every native test since spool.c is, test_spool is the only one that uses it.
+
+uint8_t host_flash[HOST_FLASH_SECTORS * HOST_FLASH_SECTOR_SIZE];
+long host_flash_power_budget = -1;
+int host_flash_erases[HOST_FLASH_SECTORS];
+
+static const esp_partition_t partition = { .size = sizeof(host_flash) };
+
+const esp_partition_t *esp_partition_find_first(int type, int subtype, const char *label)
+{
+    return &partition;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *p, size_t offset, void *dst, size_t size)
+{
+    if (offset + size > p->size) return ESP_FAIL;
+    memcpy(dst, &host_flash[offset], size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *p, size_t offset, const void *src, size_t size)
+{
+    if (offset + size > p->size) return ESP_FAIL;
+    const uint8_t *bytes = src;
+    for (size_t i = 0; i < size; i++) {
+        if (host_flash_power_budget == 0) return ESP_FAIL;
+        if (host_flash_power_budget > 0) host_flash_power_budget--;
+        host_flash[offset + i] &= bytes[i];
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *p, size_t offset, size_t size)
+{
+    if (offset % HOST_FLASH_SECTOR_SIZE || size % HOST_FLASH_SECTOR_SIZE || offset + size > p->size) return ESP_FAIL;
+    if (host_flash_power_budget == 0) return ESP_FAIL;
+    memset(&host_flash[offset], 0xFF, size);
+    host_flash_erases[offset / HOST_FLASH_SECTOR_SIZE]++;
+    return ESP_OK;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Only what the spool uses, the flash behind it is simulated in esp_partition.c
+
+typedef struct {
+    size_t size;
+} esp_partition_t;
+
+#define ESP_PARTITION_TYPE_DATA 0x01
+
+const esp_partition_t *esp_partition_find_first(int type, int subtype, const char *label);
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t offset, void *dst, size_t size);
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t offset, const void *src, size_t size);
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size);
+
+// Host only, for tests to inspect the simulated flash and cut its power
+#define HOST_FLASH_SECTOR_SIZE 4096
+#define HOST_FLASH_SECTORS 4
+
+extern uint8_t host_flash[HOST_FLASH_SECTORS * HOST_FLASH_SECTOR_SIZE];
+extern long host_flash_power_budget; // Bytes left to program before the power cut, -1 for no cut
+extern int host_flash_erases[HOST_FLASH_SECTORS];
@@ -0,0 +1,3 @@
+#pragma once
+
+#define portMAX_DELAY 0xFFFFFFFF
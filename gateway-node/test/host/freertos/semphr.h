@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stdint.h>
+
+// Host tests are single threaded, the spool's mutex does nothing
+
+typedef void *SemaphoreHandle_t;
+
+static inline SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return (SemaphoreHandle_t)1;
+}
+
+static inline int xSemaphoreTake(SemaphoreHandle_t mutex, uint32_t ticks)
+{
+    return 1;
+}
+
+static inline int xSemaphoreGive(SemaphoreHandle_t mutex)
+{
+    return 1;
+}
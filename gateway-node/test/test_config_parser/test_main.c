@@ -0,0 +1,253 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "config_parser.h"
+
+#define MAX_CONFIGS 8
+
+static mesh_wire_frame_t configs[MAX_CONFIGS];
+static bool has_ids[MAX_CONFIGS];
+static int config_count;
+
+static void on_config(const mesh_wire_frame_t *config, bool has_id, void *ctx)
+{
+    if (config_count < MAX_CONFIGS) {
+        configs[config_count] = *config;
+        has_ids[config_count] = has_id;
+    }
+    config_count++;
+}
+
+// Parses a document fed in chunks of the given size
+static bool parse(const char *json, size_t chunk)
+{
+    config_parser_t parser;
+    config_count = 0;
+    memset(configs, 0, sizeof(configs));
+    config_parser_init(&parser, on_config, NULL);
+    size_t len = strlen(json);
+    for (size_t i = 0; i < len; i += chunk) {
+        config_parser_feed(&parser, json + i, len - i < chunk ? len - i : chunk);
+    }
+    return config_parser_finish(&parser);
+}
+
+static const char *samples[] = {
+    "{\"id\":\"0123456789abcdef0123456789ABCDEF\",\"version\":3,\"interval\":600,\"led_state\":1}",
+    " [ {\"id\":\"ff23456789abcdef0123456789abcdef\",\"version\":3.7,\"extra\":{\"id\":\"x\",\"version\":9},"
+    "\"led_state\":true} , {\"version\":5, \"interval\": -1, \"arr\":[1,[2,3],{}] } ] ",
+    "{\"id\":\"short\"}",
+    "[]",
+    "{}",
+    "{\"a\":\"q\\\"\\\\\"}",
+    "{\"version\":1,}",
+    "{\"version\" 1}",
+    "[{\"version\":1}",
+    "{\"version\":1} x",
+    "5",
+};
+
+#define SAMPLE_COUNT (sizeof(samples) / sizeof(samples[0]))
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static void test_single_config(void)
+{
+    TEST_ASSERT_TRUE(parse(samples[0], 64));
+    TEST_ASSERT_EQUAL_INT(1, config_count);
+    TEST_ASSERT_TRUE(has_ids[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, configs[0].uuid[0]);
+    TEST_ASSERT_EQUAL_HEX8(0xEF, configs[0].uuid[15]);
+    TEST_ASSERT_EQUAL_UINT8(MESH_WIRE_MSG_CONFIG, configs[0].type);
+    TEST_ASSERT_EQUAL_UINT32(3, mesh_wire_get(&configs[0], MESH_WIRE_FIELD_VERSION, 0));
+    TEST_ASSERT_EQUAL_UINT32(600, mesh_wire_get(&configs[0], MESH_WIRE_FIELD_INTERVAL, 0));
+    TEST_ASSERT_EQUAL_UINT32(1, mesh_wire_get(&configs[0], MESH_WIRE_FIELD_LED_STATE, 0));
+}
+
+static void test_batch_skips_nested_and_invalid_values(void)
+{
+    TEST_ASSERT_TRUE(parse(samples[1], 64));
+    TEST_ASSERT_EQUAL_INT(2, config_count);
+    TEST_ASSERT_TRUE(has_ids[0]);
+    // The version of the nested object is not the config's
+    TEST_ASSERT_EQUAL_UINT32(3, mesh_wire_get(&configs[0], MESH_WIRE_FIELD_VERSION, 0));
+    TEST_ASSERT_EQUAL_UINT32(1, mesh_wire_get(&configs[0], MESH_WIRE_FIELD_LED_STATE, 0));
+    TEST_ASSERT_FALSE(has_ids[1]);
+    TEST_ASSERT_EQUAL_UINT32(5, mesh_wire_get(&configs[1], MESH_WIRE_FIELD_VERSION, 0));
+    TEST_ASSERT_FALSE(mesh_wire_has(&configs[1], MESH_WIRE_FIELD_INTERVAL));
+}
+
+static void test_invalid_id(void)
+{
+    TEST_ASSERT_TRUE(parse(samples[2], 64));
+    TEST_ASSERT_EQUAL_INT(1, config_count);
+    TEST_ASSERT_FALSE(has_ids[0]);
+}
+
+static void test_syntax(void)
+{
+    TEST_ASSERT_TRUE(parse("[]", 64));
+    TEST_ASSERT_EQUAL_INT(0, config_count);
+    TEST_ASSERT_TRUE(parse("{}", 64));
+    TEST_ASSERT_TRUE(parse(samples[5], 64));
+    TEST_ASSERT_TRUE(parse("5", 64));
+    TEST_ASSERT_FALSE(parse("{\"version\":1,}", 64));
+    TEST_ASSERT_FALSE(parse("{\"version\" 1}", 64));
+    TEST_ASSERT_FALSE(parse("{\"version\":1} x", 64));
+    TEST_ASSERT_FALSE(parse("{\"version\":3}}", 64));
+    TEST_ASSERT_FALSE(parse("[1,]", 64));
+}
+
+static void test_configs_before_an_error_are_delivered(void)
+{
+    TEST_ASSERT_FALSE(parse("[{\"version\":1},{\"version\":2},{\"version\" 3}]", 64));
+    TEST_ASSERT_EQUAL_INT(2, config_count);
+    TEST_ASSERT_FALSE(parse(samples[8], 64));
+    TEST_ASSERT_EQUAL_INT(1, config_count);
+}
+
+static void test_too_deep(void)
+{
+    char deep[CONFIG_PARSER_MAX_DEPTH + 2];
+    memset(deep, '[', sizeof(deep) - 1);
+    deep[sizeof(deep) - 1] = '\0';
+    config_parser_t parser;
+    config_parser_init(&parser, on_config, NULL);
+    TEST_ASSERT_FALSE(config_parser_feed(&parser, deep, strlen(deep)));
+}
+
+// The parsed value of "interval", or -1 if the field was left out
+static long interval_of(const char *number)
+{
+    char json[64];
+    snprintf(json, sizeof(json), "{\"interval\":%s}", number);
+    parse(json, 64);
+    return config_count == 1 && mesh_wire_has(&configs[0], MESH_WIRE_FIELD_INTERVAL)
+               ? (long)mesh_wire_get(&configs[0], MESH_WIRE_FIELD_INTERVAL, 0)
+               : -1;
+}
+
+static void test_numbers(void)
+{
+    TEST_ASSERT_EQUAL_INT(600, interval_of("600"));
+    TEST_ASSERT_EQUAL_INT(0, interval_of("0"));
+    TEST_ASSERT_EQUAL_INT(3, interval_of("3.7"));
+    TEST_ASSERT_EQUAL_INT(37000, interval_of("3.7e4"));
+    TEST_ASSERT_EQUAL_INT(37000, interval_of("3.7E+4"));
+    TEST_ASSERT_EQUAL_INT(600, interval_of("6e2"));
+    TEST_ASSERT_EQUAL_INT(12, interval_of("1234e-2"));
+    TEST_ASSERT_EQUAL_INT(0, interval_of("5e-1"));
+    TEST_ASSERT_EQUAL_INT(0, interval_of("5e-9999"));
+    TEST_ASSERT_EQUAL_INT(65535, interval_of("65535"));
+    TEST_ASSERT_EQUAL_INT(65535, interval_of("6.5535e4"));
+}
+
+static void test_numbers_out_of_range_are_dropped(void)
+{
+    TEST_ASSERT_EQUAL_INT(-1, interval_of("65536"));
+    TEST_ASSERT_EQUAL_INT(-1, interval_of("3.7e5"));
+    TEST_ASSERT_EQUAL_INT(-1, interval_of("1e9999"));
+    TEST_ASSERT_EQUAL_INT(-1, interval_of("99999999999999999999"));
+    TEST_ASSERT_EQUAL_INT(-1, interval_of("-1"));
+    TEST_ASSERT_EQUAL_INT(-1, interval_of("-0"));
+
+    parse("{\"version\":70000,\"led_state\":70000}", 64);
+    TEST_ASSERT_FALSE(mesh_wire_has(&configs[0], MESH_WIRE_FIELD_VERSION));
+    TEST_ASSERT_EQUAL_UINT32(70000, mesh_wire_get(&configs[0], MESH_WIRE_FIELD_LED_STATE, 0));
+}
+
+static void test_malformed_numbers_are_dropped(void)
+{
+    TEST_ASSERT_EQUAL_INT(-1, interval_of("1."));
+    TEST_ASSERT_EQUAL_INT(-1, interval_of("1e"));
+    TEST_ASSERT_EQUAL_INT(-1, interval_of("1e+"));
+    TEST_ASSERT_EQUAL_INT(-1, interval_of("1.2.3"));
+    TEST_ASSERT_EQUAL_INT(-1, interval_of("1-2"));
+    TEST_ASSERT_EQUAL_INT(-1, interval_of("1e2e3"));
+}
+
+// Callbacks and the result don't depend on how the document was split
+static void expect_chunk_invariant(const char *json)
+{
+    bool whole = parse(json, 1024);
+    int whole_count = config_count;
+    mesh_wire_frame_t whole_configs[MAX_CONFIGS];
+    memcpy(whole_configs, configs, sizeof(configs));
+    for (size_t chunk = 1; chunk < 40; chunk++) {
+        TEST_ASSERT_EQUAL(whole, parse(json, chunk));
+        TEST_ASSERT_EQUAL_INT(whole_count, config_count);
+        TEST_ASSERT_EQUAL_MEMORY(whole_configs, configs, sizeof(configs));
+    }
+}
+
+static void test_chunk_invariance(void)
+{
+    for (size_t i = 0; i < SAMPLE_COUNT; i++) {
+        expect_chunk_invariant(samples[i]);
+    }
+}
+
+// Mutated and random documents, run under a sanitizer to catch overruns
+static void test_fuzz(void)
+{
+    char buf[512];
+    srand(1);
+    for (int round = 0; round < 20000; round++) {
+        const char *sample = samples[rand() % SAMPLE_COUNT];
+        size_t len = strlen(sample);
+        memcpy(buf, sample, len + 1);
+        int mutations = rand() % 6;
+        for (int i = 0; i < mutations; i++) {
+            buf[rand() % len] = "{}[]\",:\\ 0a-e."[rand() % 15];
+        }
+        if (rand() % 4 == 0) {
+            for (size_t i = 0; i < len; i++) buf[i] = (char)(1 + rand() % 255);
+        }
+        expect_chunk_invariant(buf);
+    }
+}
+
+static void test_benchmark(void)
+{
+    const char *json = samples[1];
+    size_t len = strlen(json);
+    const int rounds = 200000;
+    config_parser_t parser;
+    clock_t start = clock();
+    for (int i = 0; i < rounds; i++) {
+        config_count = 0;
+        config_parser_init(&parser, on_config, NULL);
+        config_parser_feed(&parser, json, len);
+        config_parser_finish(&parser);
+    }
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    TEST_ASSERT_EQUAL_INT(2, config_count);
+    printf("config_parser: %.1f MB/s, %.2f us per %zu byte document\n", rounds * len / seconds / 1e6,
+           seconds * 1e6 / rounds, len);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_single_config);
+    RUN_TEST(test_batch_skips_nested_and_invalid_values);
+    RUN_TEST(test_invalid_id);
+    RUN_TEST(test_syntax);
+    RUN_TEST(test_configs_before_an_error_are_delivered);
+    RUN_TEST(test_too_deep);
+    RUN_TEST(test_numbers);
+    RUN_TEST(test_numbers_out_of_range_are_dropped);
+    RUN_TEST(test_malformed_numbers_are_dropped);
+    RUN_TEST(test_chunk_invariance);
+    RUN_TEST(test_fuzz);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,162 @@
+#include <unity.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "frame_ring.h"
+
+static frame_ring_t *ring;
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+    free(ring);
+    ring = NULL;
+}
+
+// Frame i is i repeated, with a length that depends on i, so torn and reordered frames can be told apart
+static size_t make_frame(uint8_t *frame, uint32_t i)
+{
+    size_t len = 20 + i % (MESH_WIRE_MAX_FRAME_SIZE - 20);
+    for (size_t k = 0; k < len; k++) frame[k] = i >> (8 * (k % 4));
+    return len;
+}
+
+static void push(uint32_t i)
+{
+    uint8_t frame[MESH_WIRE_MAX_FRAME_SIZE];
+    frame_ring_push(ring, frame, make_frame(frame, i));
+}
+
+static void expect_pop(uint32_t i)
+{
+    uint8_t expected[MESH_WIRE_MAX_FRAME_SIZE];
+    uint8_t frame[MESH_WIRE_MAX_FRAME_SIZE];
+    size_t len;
+    size_t expected_len = make_frame(expected, i);
+    TEST_ASSERT_TRUE(frame_ring_pop(ring, frame, &len));
+    TEST_ASSERT_EQUAL_size_t(expected_len, len);
+    TEST_ASSERT_EQUAL_MEMORY(expected, frame, len);
+}
+
+static void test_fifo(void)
+{
+    ring = frame_ring_create(FRAME_RING_DROP_NEWEST);
+    uint8_t frame[MESH_WIRE_MAX_FRAME_SIZE];
+    size_t len;
+    TEST_ASSERT_FALSE(frame_ring_pop(ring, frame, &len));
+    for (uint32_t i = 0; i < 10; i++) push(i);
+    for (uint32_t i = 0; i < 4; i++) expect_pop(i);
+    frame_ring_stats_t stats;
+    frame_ring_get_stats(ring, &stats);
+    TEST_ASSERT_EQUAL_UINT32(6, stats.queued);
+    for (uint32_t i = 4; i < 10; i++) expect_pop(i);
+    TEST_ASSERT_FALSE(frame_ring_pop(ring, frame, &len));
+}
+
+static void test_rejects_oversized_frames(void)
+{
+    ring = frame_ring_create(FRAME_RING_DROP_NEWEST);
+    uint8_t frame[MESH_WIRE_MAX_FRAME_SIZE + 1] = { 0 };
+    TEST_ASSERT_FALSE(frame_ring_push(ring, frame, sizeof(frame)));
+}
+
+static void test_drop_newest(void)
+{
+    ring = frame_ring_create(FRAME_RING_DROP_NEWEST);
+    for (uint32_t i = 0; i < FRAME_RING_CAPACITY + 5; i++) push(i);
+    for (uint32_t i = 0; i < FRAME_RING_CAPACITY; i++) expect_pop(i);
+
+    frame_ring_stats_t stats;
+    frame_ring_get_stats(ring, &stats);
+    TEST_ASSERT_EQUAL_UINT32(FRAME_RING_CAPACITY, stats.pushed);
+    TEST_ASSERT_EQUAL_UINT32(5, stats.dropped_newest);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.dropped_oldest);
+    TEST_ASSERT_EQUAL_UINT32(FRAME_RING_CAPACITY, stats.high_water);
+}
+
+static void test_drop_oldest(void)
+{
+    ring = frame_ring_create(FRAME_RING_DROP_OLDEST);
+    for (uint32_t i = 0; i < FRAME_RING_CAPACITY + 5; i++) push(i);
+    for (uint32_t i = 5; i < FRAME_RING_CAPACITY + 5; i++) expect_pop(i);
+
+    frame_ring_stats_t stats;
+    frame_ring_get_stats(ring, &stats);
+    TEST_ASSERT_EQUAL_UINT32(FRAME_RING_CAPACITY + 5, stats.pushed);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.dropped_newest);
+    TEST_ASSERT_EQUAL_UINT32(5, stats.dropped_oldest);
+}
+
+#define STRESS_FRAMES 1000000
+
+static atomic_int producer_done;
+
+static void *producer(void *arg)
+{
+    for (uint32_t i = 1; i <= STRESS_FRAMES; i++) push(i);
+    atomic_store(&producer_done, 1);
+    return NULL;
+}
+
+// A publish task that stalls now and then, frames must come out whole and in order
+static void stress(frame_ring_policy_t policy)
+{
+    ring = frame_ring_create(policy);
+    atomic_store(&producer_done, 0);
+    pthread_t thread;
+    pthread_create(&thread, NULL, producer, NULL);
+
+    uint32_t popped = 0, torn = 0, reordered = 0, last = 0;
+    while (1) {
+        bool done = atomic_load(&producer_done);
+        uint8_t frame[MESH_WIRE_MAX_FRAME_SIZE];
+        uint8_t expected[MESH_WIRE_MAX_FRAME_SIZE];
+        size_t len;
+        if (frame_ring_pop(ring, frame, &len)) {
+            if (++popped % 1000 == 0) usleep(100);
+            uint32_t i = frame[0] | frame[1] << 8 | frame[2] << 16 | (uint32_t)frame[3] << 24;
+            if (len != make_frame(expected, i) || memcmp(expected, frame, len) != 0) torn++;
+            if (i <= last) reordered++;
+            last = i;
+        } else if (done) {
+            break;
+        }
+    }
+    pthread_join(thread, NULL);
+
+    frame_ring_stats_t stats;
+    frame_ring_get_stats(ring, &stats);
+    TEST_ASSERT_EQUAL_UINT32(0, torn);
+    TEST_ASSERT_EQUAL_UINT32(0, reordered);
+    TEST_ASSERT_EQUAL_UINT32(STRESS_FRAMES, stats.pushed + stats.dropped_newest);
+    TEST_ASSERT_EQUAL_UINT32(stats.pushed, popped + stats.dropped_oldest);
+    // Dropping the oldest never loses the last frame
+    if (policy == FRAME_RING_DROP_OLDEST) TEST_ASSERT_EQUAL_UINT32(STRESS_FRAMES, last);
+}
+
+static void test_stress_drop_newest(void)
+{
+    stress(FRAME_RING_DROP_NEWEST);
+}
+
+static void test_stress_drop_oldest(void)
+{
+    stress(FRAME_RING_DROP_OLDEST);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fifo);
+    RUN_TEST(test_rejects_oversized_frames);
+    RUN_TEST(test_drop_newest);
+    RUN_TEST(test_drop_oldest);
+    RUN_TEST(test_stress_drop_newest);
+    RUN_TEST(test_stress_drop_oldest);
+    return UNITY_END();
+}
@@ -0,0 +1,221 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "frame_ring.h"
+#include "publish_window.h"
+
+// The publish task of main.cpp against a simulated MQTT connection, in steps of STEP_US.
+// A publish blocks until the socket has room, the link sends one message every send_us and a PUBACK comes back
+// rtt_us after a QoS 1 message left. QoS 1 messages stay in the outbox until their PUBACK. Once a reading went to
+// the spool every later one follows it, like handle_reading does while spool_pending() > 0.
+
+#define STEP_US 100
+#define PUBLISH_US 200 // Formatting and handing a reading to the client
+#define SPOOL_US 300   // Appending a reading to the flash spool
+#define MESSAGE_BYTES 120
+#define MAX_ACKS 4096
+
+typedef struct {
+    uint32_t send_us;
+    uint32_t rtt_us;
+    uint32_t socket_messages; // Messages the socket buffers before a publish blocks
+} link_t;
+
+typedef struct {
+    uint32_t published;
+    uint32_t spooled;
+    uint32_t dropped;
+    uint32_t max_inflight;
+    uint32_t max_outbox;
+    uint32_t max_queued;
+} burst_result_t;
+
+static const link_t slow_link = { .send_us = 5000, .rtt_us = 20000, .socket_messages = 4 };
+static const link_t fast_link = { .send_us = 200, .rtt_us = 100000, .socket_messages = 16 };
+
+static void burst(const link_t *link, int qos, const publish_window_config_t *limits, uint32_t readings,
+                  uint32_t per_second, burst_result_t *result)
+{
+    frame_ring_t *ring = frame_ring_create(FRAME_RING_DROP_OLDEST);
+    publish_window_t *window = publish_window_create(limits);
+    static uint64_t acks[MAX_ACKS]; // PUBACK times, in order since the link and the round trip are fixed
+    uint32_t ack_head = 0, ack_tail = 0;
+    uint64_t interval = 1000000 / per_second;
+    uint64_t link_free = 0, busy_until = 0;
+    uint32_t pushed = 0;
+    memset(result, 0, sizeof(*result));
+
+    for (uint64_t now = 0; result->published + result->spooled + result->dropped < readings || ack_tail != ack_head;
+         now += STEP_US) {
+        while (ack_tail != ack_head && acks[ack_tail % MAX_ACKS] <= now) {
+            publish_window_acked(window);
+            ack_tail++;
+        }
+        uint8_t frame[MESH_WIRE_MAX_FRAME_SIZE] = { 0 };
+        while (pushed < readings && pushed * interval <= now) {
+            frame_ring_push(ring, frame, 20);
+            pushed++;
+        }
+
+        frame_ring_stats_t queue;
+        frame_ring_get_stats(ring, &queue);
+        result->dropped = queue.dropped_oldest;
+        size_t len;
+        if (now < busy_until || !frame_ring_pop(ring, frame, &len)) continue;
+
+        frame_ring_get_stats(ring, &queue);
+        uint32_t outbox = (ack_head - ack_tail) * MESSAGE_BYTES;
+        if (result->spooled || !publish_window_open(window, outbox, queue.queued)) {
+            result->spooled++;
+            busy_until = now + SPOOL_US;
+            continue;
+        }
+        uint64_t queued_us = (uint64_t)link->socket_messages * link->send_us;
+        uint64_t accepted = link_free > now + queued_us ? link_free - queued_us : now;
+        link_free = (link_free > accepted ? link_free : accepted) + link->send_us;
+        busy_until = accepted + PUBLISH_US;
+        if (qos > 0) {
+            TEST_ASSERT_LESS_THAN(MAX_ACKS, ack_head - ack_tail);
+            acks[ack_head++ % MAX_ACKS] = link_free + link->rtt_us;
+        }
+        publish_window_sent(window, qos);
+        result->published++;
+
+        if (publish_window_inflight(window) > result->max_inflight) result->max_inflight = publish_window_inflight(window);
+        outbox = (ack_head - ack_tail) * MESSAGE_BYTES;
+        if (outbox > result->max_outbox) result->max_outbox = outbox;
+    }
+
+    frame_ring_stats_t queue;
+    frame_ring_get_stats(ring, &queue);
+    result->max_queued = queue.high_water;
+    TEST_ASSERT_EQUAL_UINT32(0, publish_window_inflight(window));
+    free(window);
+    free(ring);
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static void test_acks_never_go_below_zero(void)
+{
+    publish_window_config_t limits = { .inflight_limit = 2 };
+    publish_window_t *window = publish_window_create(&limits);
+    publish_window_acked(window);
+    TEST_ASSERT_EQUAL_UINT32(0, publish_window_inflight(window));
+    publish_window_sent(window, 0);
+    TEST_ASSERT_EQUAL_UINT32(0, publish_window_inflight(window));
+    publish_window_sent(window, 1);
+    publish_window_sent(window, 1);
+    TEST_ASSERT_FALSE(publish_window_open(window, 0, 0));
+    publish_window_acked(window);
+    TEST_ASSERT_TRUE(publish_window_open(window, 0, 0));
+    publish_window_sent(window, 1);
+    publish_window_reset(window);
+    TEST_ASSERT_EQUAL_UINT32(0, publish_window_inflight(window));
+    free(window);
+}
+
+static void test_each_limit_closes_the_window(void)
+{
+    publish_window_config_t limits = { .inflight_limit = 1, .outbox_limit = 1000, .backlog_limit = 8 };
+    publish_window_t *window = publish_window_create(&limits);
+    TEST_ASSERT_TRUE(publish_window_open(window, 999, 7));
+    TEST_ASSERT_FALSE(publish_window_open(window, 1000, 0));
+    TEST_ASSERT_FALSE(publish_window_open(window, 0, 8));
+    publish_window_sent(window, 2);
+    TEST_ASSERT_FALSE(publish_window_open(window, 0, 0));
+    free(window);
+
+    // 0 disables a limit
+    publish_window_config_t none = { 0 };
+    window = publish_window_create(&none);
+    for (int i = 0; i < 100; i++) publish_window_sent(window, 1);
+    TEST_ASSERT_TRUE(publish_window_open(window, 1 << 20, 1000));
+    free(window);
+}
+
+static void test_qos0_burst_is_spooled_instead_of_dropped(void)
+{
+    burst_result_t result;
+    // Without a window the queue overflows while QoS 0 publishes wait for the socket
+    publish_window_config_t none = { 0 };
+    burst(&slow_link, 0, &none, 2000, 1000, &result);
+    TEST_ASSERT_GREATER_THAN(0, result.dropped);
+
+    publish_window_config_t limits = { .inflight_limit = 16, .outbox_limit = 12 * 1024, .backlog_limit = 16 };
+    burst(&slow_link, 0, &limits, 2000, 1000, &result);
+    TEST_ASSERT_EQUAL_UINT32(0, result.dropped);
+    TEST_ASSERT_GREATER_THAN(0, result.spooled);
+    TEST_ASSERT_EQUAL_UINT32(2000, result.published + result.spooled);
+    TEST_ASSERT_LESS_THAN(FRAME_RING_CAPACITY, result.max_queued);
+}
+
+static void test_qos1_burst_stays_within_the_inflight_limit(void)
+{
+    burst_result_t result;
+    publish_window_config_t limits = { .inflight_limit = 16, .backlog_limit = 16 };
+    burst(&fast_link, 1, &limits, 2000, 1000, &result);
+    TEST_ASSERT_EQUAL_UINT32(16, result.max_inflight);
+    TEST_ASSERT_EQUAL_UINT32(0, result.dropped);
+    TEST_ASSERT_EQUAL_UINT32(2000, result.published + result.spooled);
+}
+
+static void test_qos1_burst_stays_within_the_outbox_limit(void)
+{
+    burst_result_t result;
+    publish_window_config_t limits = { .outbox_limit = 10 * MESSAGE_BYTES, .backlog_limit = 16 };
+    burst(&fast_link, 1, &limits, 2000, 1000, &result);
+    TEST_ASSERT_LESS_OR_EQUAL(10 * MESSAGE_BYTES, result.max_outbox);
+    TEST_ASSERT_EQUAL_UINT32(0, result.dropped);
+    TEST_ASSERT_EQUAL_UINT32(2000, result.published + result.spooled);
+}
+
+// Highest rate, in steps of 10 readings per second, at which nothing goes to the spool
+static uint32_t sustainable_rate(const link_t *link, int qos, const publish_window_config_t *limits)
+{
+    uint32_t low = 10, high = 5000;
+    while (high - low > 10) {
+        uint32_t rate = (low + high) / 2;
+        burst_result_t result;
+        burst(link, qos, limits, 2000, rate, &result);
+        if (result.spooled == 0 && result.dropped == 0) {
+            low = rate;
+        } else {
+            high = rate;
+        }
+    }
+    return low;
+}
+
+static void test_sustainable_rate(void)
+{
+    // 1 ms per message and a 50 ms round trip to the broker
+    const link_t link = { .send_us = 1000, .rtt_us = 50000, .socket_messages = 8 };
+    publish_window_config_t limits = { .inflight_limit = 16, .outbox_limit = 12 * 1024, .backlog_limit = 16 };
+    uint32_t qos0 = sustainable_rate(&link, 0, &limits);
+    uint32_t qos1 = sustainable_rate(&link, 1, &limits);
+    printf("Sustainable readings per second without spooling: QoS 0 %lu, QoS 1 %lu\n", (unsigned long)qos0,
+           (unsigned long)qos1);
+    // QoS 1 is bound by inflight_limit per round trip, QoS 0 by the link
+    TEST_ASSERT_UINT_WITHIN(40, 16 * 1000000 / (50000 + 1000), qos1);
+    TEST_ASSERT_GREATER_THAN(qos1, qos0);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_acks_never_go_below_zero);
+    RUN_TEST(test_each_limit_closes_the_window);
+    RUN_TEST(test_qos0_burst_is_spooled_instead_of_dropped);
+    RUN_TEST(test_qos1_burst_stays_within_the_inflight_limit);
+    RUN_TEST(test_qos1_burst_stays_within_the_outbox_limit);
+    RUN_TEST(test_sustainable_rate);
+    return UNITY_END();
+}
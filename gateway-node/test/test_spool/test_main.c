@@ -0,0 +1,248 @@
+#include <unity.h>
+#include <string.h>
+#include "esp_partition.h"
+#include "spool.h"
+
+// spool.c on the simulated NOR flash of test/host/esp_partition.c. A power cut stops programming after a number
+// of bytes, which tears the record being written.
+
+#define SECTOR_SIZE HOST_FLASH_SECTOR_SIZE
+#define SECTORS HOST_FLASH_SECTORS
+#define SLOTS_PER_SECTOR (SECTOR_SIZE / 80)
+#define SLOTS (SECTORS * SLOTS_PER_SECTOR)
+
+static void power_cut_after(long bytes)
+{
+    host_flash_power_budget = bytes;
+}
+
+static void reboot(void)
+{
+    host_flash_power_budget = -1;
+    TEST_ASSERT_EQUAL(ESP_OK, spool_init());
+}
+
+static void append(uint32_t value)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, spool_append((const uint8_t *)&value, sizeof(value)));
+}
+
+// Drains the log and checks that it held first, first + 1, ... up to last
+static void expect_drain(uint32_t first, uint32_t last)
+{
+    uint8_t data[SPOOL_MAX_PAYLOAD];
+    size_t len;
+    for (uint32_t expected = first; expected <= last; expected++) {
+        TEST_ASSERT_TRUE(spool_peek(data, &len));
+        TEST_ASSERT_EQUAL_size_t(sizeof(uint32_t), len);
+        uint32_t value;
+        memcpy(&value, data, sizeof(value));
+        TEST_ASSERT_EQUAL_UINT32(expected, value);
+        spool_ack();
+    }
+    TEST_ASSERT_FALSE(spool_peek(data, &len));
+    TEST_ASSERT_EQUAL_UINT32(0, spool_pending());
+}
+
+void setUp(void)
+{
+    // Never written since the partition was created
+    memset(host_flash, 0x5A, sizeof(host_flash));
+    memset(host_flash_erases, 0, sizeof(host_flash_erases));
+    reboot();
+}
+
+void tearDown(void)
+{
+}
+
+static void test_starts_empty_on_unwritten_flash(void)
+{
+    spool_stats_t stats;
+    spool_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.pending);
+    TEST_ASSERT_EQUAL_UINT32(SLOTS, stats.capacity);
+    expect_drain(1, 0);
+}
+
+static void test_drains_in_order(void)
+{
+    for (uint32_t i = 0; i < 10; i++) append(i);
+    TEST_ASSERT_EQUAL_UINT32(10, spool_pending());
+    expect_drain(0, 9);
+}
+
+static void test_peek_does_not_remove(void)
+{
+    append(7);
+    uint8_t data[SPOOL_MAX_PAYLOAD];
+    size_t len;
+    TEST_ASSERT_TRUE(spool_peek(data, &len));
+    TEST_ASSERT_TRUE(spool_peek(data, &len));
+    TEST_ASSERT_EQUAL_UINT32(1, spool_pending());
+}
+
+static void test_rejects_oversized_payloads(void)
+{
+    uint8_t data[SPOOL_MAX_PAYLOAD + 1] = { 0 };
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, spool_append(data, sizeof(data)));
+    TEST_ASSERT_EQUAL_UINT32(0, spool_pending());
+}
+
+static void test_reboot_keeps_pending_records(void)
+{
+    for (uint32_t i = 0; i < 100; i++) append(i);
+    uint8_t data[SPOOL_MAX_PAYLOAD];
+    size_t len;
+    for (int i = 0; i < 40; i++) {
+        spool_peek(data, &len);
+        spool_ack();
+    }
+
+    reboot();
+    TEST_ASSERT_EQUAL_UINT32(60, spool_pending());
+    expect_drain(40, 99);
+
+    // Nothing pending, writing resumes after the last record
+    reboot();
+    TEST_ASSERT_EQUAL_UINT32(0, spool_pending());
+    append(100);
+    expect_drain(100, 100);
+}
+
+static void test_torn_write_is_skipped(void)
+{
+    for (uint32_t i = 0; i < 5; i++) append(i);
+    // Power fails after the state byte and part of the header of the next record
+    power_cut_after(6);
+    uint32_t lost = 5;
+    spool_append((const uint8_t *)&lost, sizeof(lost));
+
+    reboot();
+    append(6);
+    append(7);
+    uint8_t data[SPOOL_MAX_PAYLOAD];
+    size_t len;
+    for (uint32_t expected = 0; expected < 5; expected++) {
+        TEST_ASSERT_TRUE(spool_peek(data, &len));
+        TEST_ASSERT_EQUAL_UINT32(expected, *(uint32_t *)data);
+        spool_ack();
+    }
+    expect_drain(6, 7);
+}
+
+static void test_torn_slot_between_pending_runs(void)
+{
+    for (uint32_t i = 0; i < 5; i++) append(i);
+    // Cut inside the CRC
+    power_cut_after(10);
+    uint32_t lost = 99;
+    spool_append((const uint8_t *)&lost, sizeof(lost));
+
+    // New records go after the torn slot, the pending ones before it must survive another reboot
+    reboot();
+    for (uint32_t i = 5; i < 8; i++) append(i);
+    reboot();
+    TEST_ASSERT_GREATER_OR_EQUAL(8, spool_pending());
+    expect_drain(0, 7);
+}
+
+static void test_torn_slots_after_acked_records(void)
+{
+    for (uint32_t i = 0; i < 3; i++) append(i);
+    expect_drain(0, 2);
+    power_cut_after(10);
+    uint32_t lost = 99;
+    spool_append((const uint8_t *)&lost, sizeof(lost));
+
+    reboot();
+    append(3);
+    reboot();
+    expect_drain(3, 3);
+}
+
+static void test_unacked_record_is_delivered_again(void)
+{
+    for (uint32_t i = 0; i < 3; i++) append(i);
+    uint8_t data[SPOOL_MAX_PAYLOAD];
+    size_t len;
+    spool_peek(data, &len);
+    // Published, but the power fails before the ack reaches flash
+    power_cut_after(0);
+    spool_ack();
+
+    reboot();
+    expect_drain(0, 2);
+}
+
+static void test_power_cut_while_full_log_erases(void)
+{
+    // Fills the log up to the start of the first sector again, the next append has to erase it
+    for (uint32_t i = 0; i < SLOTS; i++) append(i);
+    power_cut_after(0);
+    uint32_t lost = SLOTS;
+    spool_append((const uint8_t *)&lost, sizeof(lost));
+
+    // Nothing was erased, so nothing got lost either
+    reboot();
+    TEST_ASSERT_EQUAL_UINT32(SLOTS, spool_pending());
+    append(SLOTS);
+    expect_drain(SLOTS_PER_SECTOR, SLOTS);
+}
+
+static void test_wraps_around_and_drops_the_oldest(void)
+{
+    uint32_t total = SLOTS * 3 + 17;
+    for (uint32_t i = 0; i < total; i++) append(i);
+
+    spool_stats_t stats;
+    spool_get_stats(&stats);
+    TEST_ASSERT_LESS_OR_EQUAL(SLOTS, stats.pending);
+    TEST_ASSERT_EQUAL_UINT32(total, stats.pending + stats.dropped);
+
+    // Every sector was erased the same number of times, give or take one
+    for (int sector = 0; sector < SECTORS; sector++) {
+        TEST_ASSERT_UINT_WITHIN(1, host_flash_erases[0], host_flash_erases[sector]);
+    }
+
+    reboot();
+    TEST_ASSERT_EQUAL_UINT32(stats.pending, spool_pending());
+    expect_drain(total - stats.pending, total - 1);
+}
+
+static void test_wrapped_log_with_torn_slots(void)
+{
+    uint32_t value = 0;
+    for (int round = 0; round < 7; round++) {
+        for (int i = 0; i < 90; i++) append(value++);
+        power_cut_after(12);
+        uint32_t lost = 0xDEAD;
+        spool_append((const uint8_t *)&lost, sizeof(lost));
+        reboot();
+    }
+
+    uint8_t data[SPOOL_MAX_PAYLOAD];
+    size_t len;
+    TEST_ASSERT_TRUE(spool_peek(data, &len));
+    uint32_t first = *(uint32_t *)data;
+    TEST_ASSERT_GREATER_THAN(0, first);
+    expect_drain(first, value - 1);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_starts_empty_on_unwritten_flash);
+    RUN_TEST(test_drains_in_order);
+    RUN_TEST(test_peek_does_not_remove);
+    RUN_TEST(test_rejects_oversized_payloads);
+    RUN_TEST(test_reboot_keeps_pending_records);
+    RUN_TEST(test_torn_write_is_skipped);
+    RUN_TEST(test_torn_slot_between_pending_runs);
+    RUN_TEST(test_torn_slots_after_acked_records);
+    RUN_TEST(test_unacked_record_is_delivered_again);
+    RUN_TEST(test_power_cut_while_full_log_erases);
+    RUN_TEST(test_wraps_around_and_drops_the_oldest);
+    RUN_TEST(test_wrapped_log_with_torn_slots);
+    return UNITY_END();
+}
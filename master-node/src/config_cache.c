@@ -0,0 +1,46 @@
+#include "config_cache.h"
+#include <string.h>
+
+bool config_cache_store(config_cache_t *cache, const mesh_wire_frame_t *config)
+{
+    config_cache_entry_t *entry = NULL;
+    for (int i = 0; i < MESH_WIRE_MAX_NODES; i++) {
+        if (cache->entries[i].valid && memcmp(cache->entries[i].config.uuid, config->uuid, 16) == 0) {
+            entry = &cache->entries[i];
+            break;
+        }
+        if (!cache->entries[i].valid && entry == NULL) {
+            entry = &cache->entries[i];
+        }
+    }
+    if (config->present == 0) {
+        if (entry) entry->valid = false;
+        return true;
+    }
+    if (entry == NULL) {
+        return false;
+    }
+    entry->config = *config;
+    entry->config.type = MESH_WIRE_MSG_CONFIG;
+    entry->valid = true;
+    return true;
+}
+
+bool config_cache_get(const config_cache_t *cache, const uint8_t uuid[16], mesh_wire_frame_t *config)
+{
+    for (int i = 0; i < MESH_WIRE_MAX_NODES; i++) {
+        if (cache->entries[i].valid && memcmp(cache->entries[i].config.uuid, uuid, 16) == 0) {
+            *config = cache->entries[i].config;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool config_cache_reply(const config_cache_t *cache, const uint8_t uuid[16], const mesh_wire_frame_t *reading,
+                        mesh_wire_frame_t *config)
+{
+    return mesh_wire_has(reading, MESH_WIRE_FIELD_VERSION) && config_cache_get(cache, uuid, config)
+        && mesh_wire_has(config, MESH_WIRE_FIELD_VERSION)
+        && mesh_wire_get(config, MESH_WIRE_FIELD_VERSION, 0) != mesh_wire_get(reading, MESH_WIRE_FIELD_VERSION, 0);
+}
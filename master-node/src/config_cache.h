@@ -0,0 +1,57 @@
+/**
+ * @file
+ * Configs the gateway pushed for nodes that are asleep.
+ *
+ * Entries are keyed by uuid, so a config can arrive before its node enrolls. A node gets its config in reply
+ * to the first reading that carries a different version, while it is still listening.
+ * No locking here, the caller guards the cache.
+ */
+
+#pragma once
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "stddef.h"
+#include "mesh_wire.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef struct
+    {
+        bool valid;
+        mesh_wire_frame_t config;
+    } config_cache_entry_t;
+
+    typedef struct
+    {
+        config_cache_entry_t entries[MESH_WIRE_MAX_NODES];
+    } config_cache_t;
+
+    /**
+     * @brief Add or replace the config of the node with config->uuid. A config without any field removes it.
+     *
+     * @return False if the cache is full.
+     */
+    bool config_cache_store(config_cache_t *cache, const mesh_wire_frame_t *config);
+
+    /**
+     * @brief Look up the config of a node.
+     *
+     * @return False if there is none.
+     */
+    bool config_cache_get(const config_cache_t *cache, const uint8_t uuid[16], mesh_wire_frame_t *config);
+
+    /**
+     * @brief Config to send in reply to a reading of the node, if its version differs from the one in the reading.
+     *
+     * @return False if the node is up to date, or the reading or the cached config has no version.
+     */
+    bool config_cache_reply(const config_cache_t *cache, const uint8_t uuid[16], const mesh_wire_frame_t *reading,
+                            mesh_wire_frame_t *config);
+
+#ifdef __cplusplus
+}
+#endif
@@ -4,32 +4,53 @@
 #include <map>
 #include <string>
 #include "driver/uart.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#include "mesh_wire.h"
+#include "config_cache.h"
 
 #define UART_NUM UART_NUM_1
 #define TX_PIN 17
 #define RX_PIN 16
 #define BUF_SIZE 1024
-
-typedef struct __attribute__((packed)) {
-    uint8_t id[16];
-    uint16_t moisture;
-    uint16_t version;
-} sensor_node_message;
-
-typedef struct __attribute__((packed)) {
-    uint8_t id[16];
-    uint16_t version;
-    uint16_t interval;
-    bool led_state;
-} node_config;
+#define UART_FRAME_SYNC 0xA5
+#define SENSOR_LISTEN_WINDOW_MS 500 // How long a sensor node waits for a config after sending its reading
 
 extern "C" void zh_network_event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data);
 
 void init_uart();
-void send_struct(const sensor_node_message *data);
+void uart_write_frame(const uint8_t *data, uint8_t len);
+int uart_read_frame(uint8_t *buffer, TickType_t ticks_to_wait);
+void load_nodes();
+void save_nodes();
+uint16_t find_node(const uint8_t uuid[16]);
+uint16_t enroll_node(const uint8_t uuid[16], const uint8_t mac[6]);
+bool is_node_address(uint16_t index, const uint8_t mac[6]);
+void send_enroll(const uint8_t *target, uint16_t index);
+void send_enroll_all();
+void send_reenroll(const uint8_t *target, uint16_t index);
+bool resolve_uuid(mesh_wire_frame_t *frame);
+void store_config(const mesh_wire_frame_t *config);
+bool get_config_reply(const uint8_t uuid[16], const mesh_wire_frame_t *reading, mesh_wire_frame_t *config);
+void send_config(const uint8_t *target, uint16_t index, mesh_wire_frame_t *config);
 
 std::map<std::string, int> message_counts;
 
+// Enrolled nodes, the uuid of node index n is stored at n - 1
+uint8_t node_uuids[MESH_WIRE_MAX_NODES][16];
+uint16_t node_count = 0;
+
+// Where and when each enrolled node was last heard from, stored at index - 1 like the uuids.
+// The addresses are saved with the uuids and only set when the node sends its uuid, all zero until then.
+uint8_t node_macs[MESH_WIRE_MAX_NODES][6];
+int64_t node_seen_us[MESH_WIRE_MAX_NODES];
+
+// Configs pushed by the gateway, see config_cache.h
+config_cache_t node_configs;
+
+// Node table and configs are written by the mesh handler and read by the main loop, both go through this lock
+SemaphoreHandle_t tables_mutex;
+
 extern "C" void app_main(void)
 {
     esp_log_level_set("zh_vector", ESP_LOG_NONE);
@@ -44,19 +65,55 @@ extern "C" void app_main(void)
     esp_wifi_set_max_tx_power(8); // Power reduction is for example and testing purposes only. Do not use in your own programs!
     zh_network_init_config_t network_init_config = ZH_NETWORK_INIT_CONFIG_DEFAULT();
     zh_network_init(&network_init_config);
+    tables_mutex = xSemaphoreCreateMutex();
     esp_event_handler_instance_register(ZH_NETWORK, ESP_EVENT_ANY_ID, &zh_network_event_handler, NULL, NULL);
 
     init_uart();
+    load_nodes();
+
+    // Gateway may have booted before us, give it the whole table and get its configs back
+    send_enroll_all();
+    mesh_wire_frame_t config_sync;
+    mesh_wire_init(&config_sync, MESH_WIRE_MSG_CONFIG_SYNC);
+    uint8_t config_sync_frame[MESH_WIRE_MAX_FRAME_SIZE];
+    uart_write_frame(config_sync_frame, mesh_wire_encode(&config_sync, config_sync_frame, sizeof(config_sync_frame)));
 
     while (1) {
-        uint8_t buffer[BUF_SIZE];
-        int len = uart_read_bytes(UART_NUM, buffer, BUF_SIZE - 1, 50 / portTICK_PERIOD_MS);
-
-        if (len && len == sizeof(node_config)) {
-            node_config received;
-            memcpy(&received, buffer, sizeof(node_config));
-            printf("CONFIG RECEIVED - Version: %d, Interval: %d\n", received.version, received.interval);
-            zh_network_send(NULL, (uint8_t *)&received, sizeof(received));
+        uint8_t buffer[MESH_WIRE_MAX_FRAME_SIZE];
+        int len = uart_read_frame(buffer, 50 / portTICK_PERIOD_MS);
+
+        mesh_wire_frame_t received;
+        if (len && mesh_wire_decode(&received, buffer, len)) {
+            if (received.type == MESH_WIRE_MSG_CONFIG) {
+                printf("CONFIG RECEIVED - Version: %lu, Interval: %lu\n",
+                    mesh_wire_get(&received, MESH_WIRE_FIELD_VERSION, 0), mesh_wire_get(&received, MESH_WIRE_FIELD_INTERVAL, 0));
+                if (!resolve_uuid(&received)) {
+                    continue;
+                }
+                store_config(&received);
+
+                // Only a node that is still listening gets it now, the others on their next reading
+                uint16_t index = received.node_index;
+                uint8_t mac[6];
+                bool listening = false;
+                if (index != 0) {
+                    xSemaphoreTake(tables_mutex, portMAX_DELAY);
+                    listening = esp_timer_get_time() - node_seen_us[index - 1] < SENSOR_LISTEN_WINDOW_MS * 1000LL;
+                    memcpy(mac, node_macs[index - 1], 6);
+                    xSemaphoreGive(tables_mutex);
+                }
+                if (listening) {
+                    send_config(mac, index, &received);
+                } else {
+                    printf("CONFIG QUEUED UNTIL NEXT READING\n");
+                }
+            } else if (received.type == MESH_WIRE_MSG_CONFIG_CACHE) {
+                if (resolve_uuid(&received)) {
+                    store_config(&received);
+                }
+            } else if (received.type == MESH_WIRE_MSG_ENROLL_SYNC) {
+                send_enroll_all();
+            }
         }
 
         vTaskDelay(10 / portTICK_PERIOD_MS);
@@ -68,9 +125,53 @@ extern "C" void zh_network_event_handler(void *arg, esp_event_base_t event_base,
     if (event_id == ZH_NETWORK_ON_RECV_EVENT)
     {
         zh_network_event_on_recv_t *recv_data = (zh_network_event_on_recv_t *)event_data;
-        sensor_node_message *recv_message = (sensor_node_message *)recv_data->data;
-        printf("NODE MESSAGE RECEIVED - Version: %d, Moisture: %d\n", recv_message->version, recv_message->moisture);
-        send_struct(recv_message);
+        mesh_wire_frame_t recv_message;
+        if (mesh_wire_decode(&recv_message, recv_data->data, recv_data->data_len) && recv_message.type == MESH_WIRE_MSG_READING) {
+            printf("NODE MESSAGE RECEIVED - Index: %d, Version: %lu, Moisture: %lu\n", recv_message.node_index,
+                mesh_wire_get(&recv_message, MESH_WIRE_FIELD_VERSION, 0), mesh_wire_get(&recv_message, MESH_WIRE_FIELD_MOISTURE, 0));
+
+            uint16_t index = recv_message.node_index;
+            if (recv_message.node_index == 0) {
+                // Node is not enrolled yet, assign it an index and forward the reading in short form
+                index = enroll_node(recv_message.uuid, recv_data->mac_addr);
+                if (index != 0) {
+                    send_enroll(recv_data->mac_addr, index);
+                    recv_message.node_index = index;
+                    uint8_t frame[MESH_WIRE_MAX_FRAME_SIZE];
+                    size_t frame_len = mesh_wire_encode(&recv_message, frame, sizeof(frame));
+                    uart_write_frame(frame, frame_len);
+                } else {
+                    uart_write_frame(recv_data->data, recv_data->data_len);
+                }
+            } else if (!is_node_address(index, recv_data->mac_addr)) {
+                // Index from before the node table was lost, one that was handed out again since, or a node whose
+                // address isn't known yet. Not forwarded, the gateway would publish it under another node's uuid.
+                printf("UNKNOWN NODE INDEX %d, ASKING NODE TO ENROLL AGAIN\n", index);
+                send_reenroll(recv_data->mac_addr, index);
+                index = 0;
+            } else {
+                // Forwarded as is, the gateway decodes the frame
+                uart_write_frame(recv_data->data, recv_data->data_len);
+            }
+
+            uint8_t uuid[16];
+            bool enrolled = false;
+            xSemaphoreTake(tables_mutex, portMAX_DELAY);
+            if (index >= 1 && index <= node_count) {
+                node_seen_us[index - 1] = esp_timer_get_time();
+                memcpy(uuid, node_uuids[index - 1], 16);
+                enrolled = true;
+            }
+            xSemaphoreGive(tables_mutex);
+
+            if (enrolled) {
+                // Node is listening for 500 ms now, answer a stale version right away
+                mesh_wire_frame_t config;
+                if (get_config_reply(uuid, &recv_message, &config)) {
+                    send_config(recv_data->mac_addr, index, &config);
+                }
+            }
+        }
         heap_caps_free(recv_data->data); // Do not delete to avoid memory leaks!
     }
 }
@@ -89,9 +190,191 @@ void init_uart() {
     uart_driver_install(UART_NUM, BUF_SIZE, BUF_SIZE, 0, NULL, 0);
 }
 
-void send_struct(const sensor_node_message *data) {
-    uint8_t buffer[sizeof(sensor_node_message)];
-    memcpy(buffer, data, sizeof(sensor_node_message));
-    printf("SENDING %d BYTES VIA UART\n", sizeof(buffer));
-    uart_write_bytes(UART_NUM, (const char *)buffer, sizeof(buffer));
+// Frames are variable length, each one goes over UART as sync byte, length byte and payload
+void uart_write_frame(const uint8_t *data, uint8_t len) {
+    // One write per frame, frames are sent from both the mesh handler and the main loop
+    uint8_t buffer[2 + MESH_WIRE_MAX_FRAME_SIZE];
+    if (len > MESH_WIRE_MAX_FRAME_SIZE) return;
+    buffer[0] = UART_FRAME_SYNC;
+    buffer[1] = len;
+    memcpy(&buffer[2], data, len);
+    printf("SENDING %d BYTES VIA UART\n", len);
+    uart_write_bytes(UART_NUM, (const char *)buffer, len + 2);
+}
+
+int uart_read_frame(uint8_t *buffer, TickType_t ticks_to_wait) {
+    uint8_t header = 0;
+    if (uart_read_bytes(UART_NUM, &header, 1, ticks_to_wait) != 1 || header != UART_FRAME_SYNC) {
+        return 0;
+    }
+    uint8_t len = 0;
+    if (uart_read_bytes(UART_NUM, &len, 1, 10 / portTICK_PERIOD_MS) != 1 || len == 0 || len > MESH_WIRE_MAX_FRAME_SIZE) {
+        return 0;
+    }
+    if (uart_read_bytes(UART_NUM, buffer, len, 20 / portTICK_PERIOD_MS) != len) {
+        return 0;
+    }
+    return len;
+}
+
+void load_nodes() {
+    nvs_handle_t nvs_handle;
+    if (nvs_open("nodes", NVS_READONLY, &nvs_handle) != ESP_OK) {
+        return;
+    }
+    size_t size = sizeof(node_uuids);
+    xSemaphoreTake(tables_mutex, portMAX_DELAY);
+    if (nvs_get_blob(nvs_handle, "uuids", node_uuids, &size) == ESP_OK) {
+        node_count = size / sizeof(node_uuids[0]);
+        // Missing on tables saved before the addresses were, those nodes are asked to enroll again
+        size = node_count * sizeof(node_macs[0]);
+        if (nvs_get_blob(nvs_handle, "macs", node_macs, &size) != ESP_OK) {
+            memset(node_macs, 0, sizeof(node_macs));
+        }
+    }
+    xSemaphoreGive(tables_mutex);
+    nvs_close(nvs_handle);
+    printf("ENROLLED NODES: %d\n", node_count);
+}
+
+// Callers hold tables_mutex
+void save_nodes() {
+    nvs_handle_t nvs_handle;
+    if (nvs_open("nodes", NVS_READWRITE, &nvs_handle) != ESP_OK) {
+        printf("Failed to open NVS in write mode\n");
+        return;
+    }
+    if (nvs_set_blob(nvs_handle, "uuids", node_uuids, node_count * sizeof(node_uuids[0])) != ESP_OK ||
+        nvs_set_blob(nvs_handle, "macs", node_macs, node_count * sizeof(node_macs[0])) != ESP_OK ||
+        nvs_commit(nvs_handle) != ESP_OK) {
+        printf("Failed to write node table\n");
+    }
+    nvs_close(nvs_handle);
+}
+
+// Callers hold tables_mutex
+uint16_t find_node(const uint8_t uuid[16]) {
+    for (uint16_t i = 0; i < node_count; i++) {
+        if (memcmp(node_uuids[i], uuid, 16) == 0) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+// Binds the index to the address the uuid came from, readings under the index are only taken from there
+uint16_t enroll_node(const uint8_t uuid[16], const uint8_t mac[6]) {
+    xSemaphoreTake(tables_mutex, portMAX_DELAY);
+    uint16_t index = find_node(uuid);
+    if (index != 0) {
+        // Node lost its index (e.g. flash erased) or its address isn't saved yet, hand out the same one again
+        if (memcmp(node_macs[index - 1], mac, 6) != 0) {
+            memcpy(node_macs[index - 1], mac, 6);
+            save_nodes();
+        }
+        xSemaphoreGive(tables_mutex);
+        return index;
+    }
+    if (node_count == MESH_WIRE_MAX_NODES) {
+        xSemaphoreGive(tables_mutex);
+        printf("Node table full\n");
+        return 0;
+    }
+    memcpy(node_uuids[node_count], uuid, 16);
+    memcpy(node_macs[node_count], mac, 6);
+    node_count++;
+    index = node_count;
+    save_nodes();
+    xSemaphoreGive(tables_mutex);
+    printf("NODE ENROLLED - Index: %d\n", index);
+    return index;
+}
+
+// Only the address saved when the node enrolled may use the index, also right after a reboot
+bool is_node_address(uint16_t index, const uint8_t mac[6]) {
+    xSemaphoreTake(tables_mutex, portMAX_DELAY);
+    bool known = index <= node_count && memcmp(node_macs[index - 1], mac, 6) == 0;
+    xSemaphoreGive(tables_mutex);
+    return known;
+}
+
+// Tells the gateway, and the node at target if given, which index belongs to which uuid
+void send_enroll(const uint8_t *target, uint16_t index) {
+    mesh_wire_frame_t enroll;
+    mesh_wire_init(&enroll, MESH_WIRE_MSG_ENROLL);
+    xSemaphoreTake(tables_mutex, portMAX_DELAY);
+    memcpy(enroll.uuid, node_uuids[index - 1], 16);
+    xSemaphoreGive(tables_mutex);
+    mesh_wire_set(&enroll, MESH_WIRE_FIELD_NODE_INDEX, index);
+
+    uint8_t frame[MESH_WIRE_MAX_FRAME_SIZE];
+    size_t frame_len = mesh_wire_encode(&enroll, frame, sizeof(frame));
+    if (target != NULL) {
+        zh_network_send(target, frame, frame_len);
+    }
+    uart_write_frame(frame, frame_len);
+}
+
+void send_enroll_all() {
+    xSemaphoreTake(tables_mutex, portMAX_DELAY);
+    uint16_t count = node_count;
+    xSemaphoreGive(tables_mutex);
+    for (uint16_t index = 1; index <= count; index++) {
+        send_enroll(NULL, index);
+    }
+}
+
+// Addressed by the index alone, the master doesn't know which uuid the node has
+void send_reenroll(const uint8_t *target, uint16_t index) {
+    mesh_wire_frame_t reenroll;
+    mesh_wire_init(&reenroll, MESH_WIRE_MSG_REENROLL);
+    reenroll.node_index = index;
+
+    uint8_t frame[MESH_WIRE_MAX_FRAME_SIZE];
+    size_t frame_len = mesh_wire_encode(&reenroll, frame, sizeof(frame));
+    if (frame_len) {
+        zh_network_send(target, frame, frame_len);
+    }
+}
+
+// Config frames from the gateway carry either the node index or the uuid, the cache needs both
+bool resolve_uuid(mesh_wire_frame_t *frame) {
+    bool resolved = true;
+    xSemaphoreTake(tables_mutex, portMAX_DELAY);
+    if (frame->node_index == 0) {
+        frame->node_index = find_node(frame->uuid);
+    } else if (frame->node_index > node_count) {
+        resolved = false;
+    } else {
+        memcpy(frame->uuid, node_uuids[frame->node_index - 1], 16);
+    }
+    xSemaphoreGive(tables_mutex);
+    return resolved;
+}
+
+// A config without any field removes the node's entry
+void store_config(const mesh_wire_frame_t *config) {
+    xSemaphoreTake(tables_mutex, portMAX_DELAY);
+    bool stored = config_cache_store(&node_configs, config);
+    xSemaphoreGive(tables_mutex);
+    if (!stored) {
+        printf("Config cache full\n");
+    }
+}
+
+bool get_config_reply(const uint8_t uuid[16], const mesh_wire_frame_t *reading, mesh_wire_frame_t *config) {
+    xSemaphoreTake(tables_mutex, portMAX_DELAY);
+    bool found = config_cache_reply(&node_configs, uuid, reading, config);
+    xSemaphoreGive(tables_mutex);
+    return found;
+}
+
+void send_config(const uint8_t *target, uint16_t index, mesh_wire_frame_t *config) {
+    config->node_index = index;
+    uint8_t frame[MESH_WIRE_MAX_FRAME_SIZE];
+    size_t frame_len = mesh_wire_encode(config, frame, sizeof(frame));
+    if (frame_len) {
+        printf("SENDING CONFIG TO NODE %d\n", index);
+        zh_network_send(target, frame, frame_len);
+    }
 }
@@ -0,0 +1,184 @@
+#include <unity.h>
+#include <string.h>
+#include "config_cache.h"
+
+static config_cache_t cache;
+
+void setUp(void)
+{
+    memset(&cache, 0, sizeof(cache));
+}
+
+void tearDown(void)
+{
+}
+
+static void make_uuid(uint8_t uuid[16], uint8_t n)
+{
+    memset(uuid, 0xA0, 16);
+    uuid[15] = n;
+}
+
+// What the gateway sends as MESH_WIRE_MSG_CONFIG_CACHE
+static mesh_wire_frame_t make_config(uint8_t n, uint32_t version, uint32_t interval)
+{
+    mesh_wire_frame_t config;
+    mesh_wire_init(&config, MESH_WIRE_MSG_CONFIG_CACHE);
+    make_uuid(config.uuid, n);
+    mesh_wire_set(&config, MESH_WIRE_FIELD_VERSION, version);
+    mesh_wire_set(&config, MESH_WIRE_FIELD_INTERVAL, interval);
+    return config;
+}
+
+static mesh_wire_frame_t make_reading(uint32_t version)
+{
+    mesh_wire_frame_t reading;
+    mesh_wire_init(&reading, MESH_WIRE_MSG_READING);
+    reading.node_index = 3;
+    mesh_wire_set(&reading, MESH_WIRE_FIELD_MOISTURE, 1800);
+    mesh_wire_set(&reading, MESH_WIRE_FIELD_VERSION, version);
+    return reading;
+}
+
+static void test_stored_as_plain_config(void)
+{
+    mesh_wire_frame_t config = make_config(1, 4, 600);
+    TEST_ASSERT_TRUE(config_cache_store(&cache, &config));
+
+    mesh_wire_frame_t found;
+    TEST_ASSERT_TRUE(config_cache_get(&cache, config.uuid, &found));
+    TEST_ASSERT_EQUAL_UINT8(MESH_WIRE_MSG_CONFIG, found.type);
+    TEST_ASSERT_EQUAL_UINT32(4, mesh_wire_get(&found, MESH_WIRE_FIELD_VERSION, 0));
+    TEST_ASSERT_EQUAL_UINT32(600, mesh_wire_get(&found, MESH_WIRE_FIELD_INTERVAL, 0));
+}
+
+static void test_unknown_node(void)
+{
+    uint8_t uuid[16];
+    make_uuid(uuid, 9);
+    mesh_wire_frame_t found;
+    TEST_ASSERT_FALSE(config_cache_get(&cache, uuid, &found));
+}
+
+static void test_newer_config_replaces(void)
+{
+    mesh_wire_frame_t config = make_config(1, 4, 600);
+    config_cache_store(&cache, &config);
+    config = make_config(1, 5, 900);
+    config_cache_store(&cache, &config);
+
+    mesh_wire_frame_t found;
+    TEST_ASSERT_TRUE(config_cache_get(&cache, config.uuid, &found));
+    TEST_ASSERT_EQUAL_UINT32(5, mesh_wire_get(&found, MESH_WIRE_FIELD_VERSION, 0));
+
+    // Still one entry, the others are free
+    int valid = 0;
+    for (int i = 0; i < MESH_WIRE_MAX_NODES; i++) valid += cache.entries[i].valid;
+    TEST_ASSERT_EQUAL_INT(1, valid);
+}
+
+static void test_config_without_fields_removes(void)
+{
+    mesh_wire_frame_t first = make_config(1, 4, 600);
+    mesh_wire_frame_t second = make_config(2, 7, 60);
+    config_cache_store(&cache, &first);
+    config_cache_store(&cache, &second);
+
+    mesh_wire_frame_t removal;
+    mesh_wire_init(&removal, MESH_WIRE_MSG_CONFIG_CACHE);
+    memcpy(removal.uuid, first.uuid, 16);
+    TEST_ASSERT_TRUE(config_cache_store(&cache, &removal));
+
+    mesh_wire_frame_t found;
+    TEST_ASSERT_FALSE(config_cache_get(&cache, first.uuid, &found));
+    TEST_ASSERT_TRUE(config_cache_get(&cache, second.uuid, &found));
+}
+
+static void test_removed_entry_is_reused(void)
+{
+    mesh_wire_frame_t config = make_config(1, 4, 600);
+    config_cache_store(&cache, &config);
+    // A removal ahead of an entry must not shadow it on the next store
+    mesh_wire_frame_t other = make_config(2, 1, 60);
+    config_cache_store(&cache, &other);
+    mesh_wire_frame_t removal;
+    mesh_wire_init(&removal, MESH_WIRE_MSG_CONFIG_CACHE);
+    memcpy(removal.uuid, config.uuid, 16);
+    config_cache_store(&cache, &removal);
+
+    other = make_config(2, 2, 60);
+    config_cache_store(&cache, &other);
+    int valid = 0;
+    for (int i = 0; i < MESH_WIRE_MAX_NODES; i++) valid += cache.entries[i].valid;
+    TEST_ASSERT_EQUAL_INT(1, valid);
+
+    mesh_wire_frame_t found;
+    TEST_ASSERT_TRUE(config_cache_get(&cache, other.uuid, &found));
+    TEST_ASSERT_EQUAL_UINT32(2, mesh_wire_get(&found, MESH_WIRE_FIELD_VERSION, 0));
+}
+
+static void test_full_cache(void)
+{
+    for (int n = 0; n < MESH_WIRE_MAX_NODES; n++) {
+        mesh_wire_frame_t config = make_config(n, 1, 60);
+        TEST_ASSERT_TRUE(config_cache_store(&cache, &config));
+    }
+    mesh_wire_frame_t config = make_config(MESH_WIRE_MAX_NODES, 1, 60);
+    TEST_ASSERT_FALSE(config_cache_store(&cache, &config));
+
+    // Known nodes can still be updated
+    config = make_config(0, 2, 60);
+    TEST_ASSERT_TRUE(config_cache_store(&cache, &config));
+}
+
+static void test_reply_only_to_other_versions(void)
+{
+    mesh_wire_frame_t config = make_config(1, 4, 600);
+    config_cache_store(&cache, &config);
+
+    mesh_wire_frame_t reply;
+    mesh_wire_frame_t reading = make_reading(4);
+    TEST_ASSERT_FALSE(config_cache_reply(&cache, config.uuid, &reading, &reply));
+
+    reading = make_reading(3);
+    TEST_ASSERT_TRUE(config_cache_reply(&cache, config.uuid, &reading, &reply));
+    TEST_ASSERT_EQUAL_UINT32(4, mesh_wire_get(&reply, MESH_WIRE_FIELD_VERSION, 0));
+    TEST_ASSERT_EQUAL_UINT32(600, mesh_wire_get(&reply, MESH_WIRE_FIELD_INTERVAL, 0));
+
+    // A node ahead of the cache gets the cached config too, the backend may have rolled back
+    reading = make_reading(5);
+    TEST_ASSERT_TRUE(config_cache_reply(&cache, config.uuid, &reading, &reply));
+}
+
+static void test_no_reply_without_versions(void)
+{
+    mesh_wire_frame_t config;
+    mesh_wire_init(&config, MESH_WIRE_MSG_CONFIG_CACHE);
+    make_uuid(config.uuid, 1);
+    mesh_wire_set(&config, MESH_WIRE_FIELD_LED_STATE, 1);
+    config_cache_store(&cache, &config);
+
+    mesh_wire_frame_t reply;
+    mesh_wire_frame_t reading = make_reading(3);
+    TEST_ASSERT_FALSE(config_cache_reply(&cache, config.uuid, &reading, &reply));
+
+    config = make_config(2, 4, 600);
+    config_cache_store(&cache, &config);
+    mesh_wire_init(&reading, MESH_WIRE_MSG_READING);
+    mesh_wire_set(&reading, MESH_WIRE_FIELD_MOISTURE, 1800);
+    TEST_ASSERT_FALSE(config_cache_reply(&cache, config.uuid, &reading, &reply));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_stored_as_plain_config);
+    RUN_TEST(test_unknown_node);
+    RUN_TEST(test_newer_config_replaces);
+    RUN_TEST(test_config_without_fields_removes);
+    RUN_TEST(test_removed_entry_is_reused);
+    RUN_TEST(test_full_cache);
+    RUN_TEST(test_reply_only_to_other_versions);
+    RUN_TEST(test_no_reply_without_versions);
+    return UNITY_END();
+}
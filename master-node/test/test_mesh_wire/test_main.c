@@ -0,0 +1,163 @@
+#include <unity.h>
+#include <string.h>
+#include "mesh_wire.h"
+
+static const uint8_t uuid[16] = {
+    0x6b, 0x1f, 0x02, 0x9c, 0x44, 0xd7, 0x4e, 0x10, 0x8a, 0x55, 0x13, 0xee, 0x70, 0x21, 0xc4, 0x99
+};
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static void round_trip(const mesh_wire_frame_t *frame, size_t expected_len, mesh_wire_frame_t *decoded)
+{
+    uint8_t buf[MESH_WIRE_MAX_FRAME_SIZE];
+    size_t len = mesh_wire_encode(frame, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_size_t(expected_len, len);
+    TEST_ASSERT_TRUE(mesh_wire_decode(decoded, buf, len));
+}
+
+static void test_enrolled_reading(void)
+{
+    mesh_wire_frame_t frame;
+    mesh_wire_init(&frame, MESH_WIRE_MSG_READING);
+    frame.node_index = 5;
+    mesh_wire_set(&frame, MESH_WIRE_FIELD_MOISTURE, 2345);
+    mesh_wire_set(&frame, MESH_WIRE_FIELD_VERSION, 7);
+
+    // Header 3 bytes, moisture 1 + 2, version 1 + 1
+    mesh_wire_frame_t decoded;
+    round_trip(&frame, 8, &decoded);
+    TEST_ASSERT_EQUAL_UINT8(MESH_WIRE_SCHEMA_VERSION, decoded.schema);
+    TEST_ASSERT_EQUAL_UINT8(MESH_WIRE_MSG_READING, decoded.type);
+    TEST_ASSERT_EQUAL_UINT16(5, decoded.node_index);
+    TEST_ASSERT_EQUAL_UINT32(2345, mesh_wire_get(&decoded, MESH_WIRE_FIELD_MOISTURE, 0));
+    TEST_ASSERT_EQUAL_UINT32(7, mesh_wire_get(&decoded, MESH_WIRE_FIELD_VERSION, 0));
+    TEST_ASSERT_EQUAL_HEX32(frame.present, decoded.present);
+}
+
+static void test_unenrolled_reading_carries_the_uuid(void)
+{
+    mesh_wire_frame_t frame;
+    mesh_wire_init(&frame, MESH_WIRE_MSG_READING);
+    memcpy(frame.uuid, uuid, sizeof(uuid));
+    mesh_wire_set(&frame, MESH_WIRE_FIELD_MOISTURE, 2345);
+    mesh_wire_set(&frame, MESH_WIRE_FIELD_VERSION, 7);
+
+    mesh_wire_frame_t decoded;
+    round_trip(&frame, 24, &decoded);
+    TEST_ASSERT_EQUAL_UINT16(0, decoded.node_index);
+    TEST_ASSERT_EQUAL_MEMORY(uuid, decoded.uuid, sizeof(uuid));
+}
+
+static void test_signed_and_large_values(void)
+{
+    mesh_wire_frame_t frame;
+    mesh_wire_init(&frame, MESH_WIRE_MSG_READING);
+    frame.node_index = 300;
+    mesh_wire_set_signed(&frame, MESH_WIRE_FIELD_TEMPERATURE, -215);
+    mesh_wire_set(&frame, MESH_WIRE_FIELD_SEQUENCE, UINT32_MAX);
+
+    // Index 300 takes 2 bytes, -215 zigzags to 429 in 2 bytes, UINT32_MAX takes 5
+    mesh_wire_frame_t decoded;
+    round_trip(&frame, 2 + 2 + 1 + 2 + 1 + 5, &decoded);
+    TEST_ASSERT_EQUAL_UINT16(300, decoded.node_index);
+    TEST_ASSERT_EQUAL_INT32(-215, mesh_wire_get_signed(&decoded, MESH_WIRE_FIELD_TEMPERATURE, 0));
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, mesh_wire_get(&decoded, MESH_WIRE_FIELD_SEQUENCE, 0));
+}
+
+static void test_missing_fields_fall_back(void)
+{
+    mesh_wire_frame_t frame;
+    mesh_wire_init(&frame, MESH_WIRE_MSG_CONFIG);
+    frame.node_index = 1;
+
+    mesh_wire_frame_t decoded;
+    round_trip(&frame, 3, &decoded);
+    TEST_ASSERT_FALSE(mesh_wire_has(&decoded, MESH_WIRE_FIELD_INTERVAL));
+    TEST_ASSERT_EQUAL_UINT32(60, mesh_wire_get(&decoded, MESH_WIRE_FIELD_INTERVAL, 60));
+    TEST_ASSERT_EQUAL_INT32(-1, mesh_wire_get_signed(&decoded, MESH_WIRE_FIELD_TEMPERATURE, -1));
+}
+
+static void test_unknown_tags_are_skipped(void)
+{
+    // Reading of node 2 with moisture 100 and tag 40, which this decoder does not keep
+    const uint8_t buf[] = { MESH_WIRE_SCHEMA_VERSION, MESH_WIRE_MSG_READING, 2, 40, 0x81, 0x01, 1, 100 };
+    mesh_wire_frame_t decoded;
+    TEST_ASSERT_TRUE(mesh_wire_decode(&decoded, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_UINT32(100, mesh_wire_get(&decoded, MESH_WIRE_FIELD_MOISTURE, 0));
+    TEST_ASSERT_EQUAL_HEX32((uint32_t)1 << MESH_WIRE_FIELD_MOISTURE, decoded.present);
+}
+
+static void test_rejects_other_schema_versions(void)
+{
+    uint8_t buf[] = { MESH_WIRE_SCHEMA_VERSION, MESH_WIRE_MSG_READING, 2, 1, 100 };
+    mesh_wire_frame_t decoded;
+    TEST_ASSERT_TRUE(mesh_wire_decode(&decoded, buf, sizeof(buf)));
+
+    buf[0] = 0;
+    TEST_ASSERT_FALSE(mesh_wire_decode(&decoded, buf, sizeof(buf)));
+    buf[0] = MESH_WIRE_SCHEMA_VERSION + 1;
+    TEST_ASSERT_FALSE(mesh_wire_decode(&decoded, buf, sizeof(buf)));
+}
+
+static void test_rejects_truncated_frames(void)
+{
+    mesh_wire_frame_t frame;
+    mesh_wire_init(&frame, MESH_WIRE_MSG_READING);
+    memcpy(frame.uuid, uuid, sizeof(uuid));
+    mesh_wire_set(&frame, MESH_WIRE_FIELD_MOISTURE, 2345);
+
+    uint8_t buf[MESH_WIRE_MAX_FRAME_SIZE];
+    size_t len = mesh_wire_encode(&frame, buf, sizeof(buf));
+    mesh_wire_frame_t decoded;
+    // Header, uuid and one tag/value pair of 3 bytes, a cut right after the uuid leaves a valid frame without fields
+    TEST_ASSERT_EQUAL_size_t(3 + 16 + 3, len);
+    for (size_t cut = 0; cut < len; cut++) {
+        if (cut == 3 + 16) continue;
+        TEST_ASSERT_FALSE(mesh_wire_decode(&decoded, buf, cut));
+    }
+}
+
+static void test_rejects_overlong_varints(void)
+{
+    const uint8_t index[] = { MESH_WIRE_SCHEMA_VERSION, MESH_WIRE_MSG_READING, 0x80, 0x80, 0x04 };
+    const uint8_t value[] = { MESH_WIRE_SCHEMA_VERSION, MESH_WIRE_MSG_READING, 2, 1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01 };
+    mesh_wire_frame_t decoded;
+    TEST_ASSERT_FALSE(mesh_wire_decode(&decoded, index, sizeof(index)));
+    TEST_ASSERT_FALSE(mesh_wire_decode(&decoded, value, sizeof(value)));
+}
+
+static void test_encode_fails_on_small_buffers(void)
+{
+    mesh_wire_frame_t frame;
+    mesh_wire_init(&frame, MESH_WIRE_MSG_READING);
+    frame.node_index = 5;
+    mesh_wire_set(&frame, MESH_WIRE_FIELD_MOISTURE, 2345);
+
+    uint8_t buf[MESH_WIRE_MAX_FRAME_SIZE];
+    size_t len = mesh_wire_encode(&frame, buf, sizeof(buf));
+    for (size_t size = 0; size < len; size++) {
+        TEST_ASSERT_EQUAL_size_t(0, mesh_wire_encode(&frame, buf, size));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_enrolled_reading);
+    RUN_TEST(test_unenrolled_reading_carries_the_uuid);
+    RUN_TEST(test_signed_and_large_values);
+    RUN_TEST(test_missing_fields_fall_back);
+    RUN_TEST(test_unknown_tags_are_skipped);
+    RUN_TEST(test_rejects_other_schema_versions);
+    RUN_TEST(test_rejects_truncated_frames);
+    RUN_TEST(test_rejects_overlong_varints);
+    RUN_TEST(test_encode_fails_on_small_buffers);
+    return UNITY_END();
+}
@@ -0,0 +1,173 @@
+/**
+ * @file
+ * The main code of the mesh_wire component.
+ */
+
+#include "mesh_wire.h"
+#include "string.h"
+
+static size_t _put_varint(uint8_t *buf, size_t pos, size_t buf_len, uint32_t value);
+static bool _get_varint(const uint8_t *buf, size_t *pos, size_t len, uint32_t *value);
+
+void mesh_wire_init(mesh_wire_frame_t *frame, uint8_t type)
+{
+    memset(frame, 0, sizeof(mesh_wire_frame_t));
+    frame->schema = MESH_WIRE_SCHEMA_VERSION;
+    frame->type = type;
+}
+
+void mesh_wire_set(mesh_wire_frame_t *frame, uint8_t tag, uint32_t value)
+{
+    if (tag >= MESH_WIRE_MAX_FIELDS)
+    {
+        return;
+    }
+    frame->present |= (uint32_t)1 << tag;
+    frame->values[tag] = value;
+}
+
+void mesh_wire_set_signed(mesh_wire_frame_t *frame, uint8_t tag, int32_t value)
+{
+    mesh_wire_set(frame, tag, ((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+}
+
+bool mesh_wire_has(const mesh_wire_frame_t *frame, uint8_t tag)
+{
+    return tag < MESH_WIRE_MAX_FIELDS && (frame->present & ((uint32_t)1 << tag)) != 0;
+}
+
+uint32_t mesh_wire_get(const mesh_wire_frame_t *frame, uint8_t tag, uint32_t fallback)
+{
+    return mesh_wire_has(frame, tag) ? frame->values[tag] : fallback;
+}
+
+int32_t mesh_wire_get_signed(const mesh_wire_frame_t *frame, uint8_t tag, int32_t fallback)
+{
+    if (!mesh_wire_has(frame, tag))
+    {
+        return fallback;
+    }
+    uint32_t value = frame->values[tag];
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+size_t mesh_wire_encode(const mesh_wire_frame_t *frame, uint8_t *buf, size_t buf_len)
+{
+    if (buf_len < 2)
+    {
+        return 0;
+    }
+    size_t pos = 0;
+    buf[pos++] = frame->schema;
+    buf[pos++] = frame->type;
+    pos = _put_varint(buf, pos, buf_len, frame->node_index);
+    if (pos == 0)
+    {
+        return 0;
+    }
+    if (frame->node_index == 0)
+    {
+        if (pos + sizeof(frame->uuid) > buf_len)
+        {
+            return 0;
+        }
+        memcpy(&buf[pos], frame->uuid, sizeof(frame->uuid));
+        pos += sizeof(frame->uuid);
+    }
+    for (uint8_t tag = 0; tag < MESH_WIRE_MAX_FIELDS; ++tag)
+    {
+        if (!mesh_wire_has(frame, tag))
+        {
+            continue;
+        }
+        pos = _put_varint(buf, pos, buf_len, tag);
+        if (pos == 0)
+        {
+            return 0;
+        }
+        pos = _put_varint(buf, pos, buf_len, frame->values[tag]);
+        if (pos == 0)
+        {
+            return 0;
+        }
+    }
+    return pos;
+}
+
+bool mesh_wire_decode(mesh_wire_frame_t *frame, const uint8_t *buf, size_t len)
+{
+    memset(frame, 0, sizeof(mesh_wire_frame_t));
+    // New fields don't change the version, a newer one means a header this decoder can't read
+    if (len < 3 || buf[0] == 0 || buf[0] > MESH_WIRE_SCHEMA_VERSION)
+    {
+        return false;
+    }
+    frame->schema = buf[0];
+    frame->type = buf[1];
+    size_t pos = 2;
+    uint32_t value = 0;
+    if (!_get_varint(buf, &pos, len, &value) || value > UINT16_MAX)
+    {
+        return false;
+    }
+    frame->node_index = value;
+    if (frame->node_index == 0)
+    {
+        if (pos + sizeof(frame->uuid) > len)
+        {
+            return false;
+        }
+        memcpy(frame->uuid, &buf[pos], sizeof(frame->uuid));
+        pos += sizeof(frame->uuid);
+    }
+    while (pos < len)
+    {
+        uint32_t tag = 0;
+        if (!_get_varint(buf, &pos, len, &tag) || !_get_varint(buf, &pos, len, &value))
+        {
+            return false;
+        }
+        if (tag < MESH_WIRE_MAX_FIELDS)
+        {
+            mesh_wire_set(frame, tag, value);
+        }
+    }
+    return true;
+}
+
+/// \cond
+static size_t _put_varint(uint8_t *buf, size_t pos, size_t buf_len, uint32_t value)
+{
+    do
+    {
+        if (pos >= buf_len)
+        {
+            return 0;
+        }
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        buf[pos++] = value != 0 ? (byte | 0x80) : byte;
+    } while (value != 0);
+    return pos;
+}
+
+static bool _get_varint(const uint8_t *buf, size_t *pos, size_t len, uint32_t *value)
+{
+    uint32_t result = 0;
+    for (uint8_t shift = 0; shift < 35; shift += 7)
+    {
+        if (*pos >= len)
+        {
+            return false;
+        }
+        uint8_t byte = buf[(*pos)++];
+        result |= (uint32_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+/// \endcond
@@ -0,0 +1,154 @@
+/**
+ * @file
+ * Header file for the mesh_wire component.
+ *
+ * Compact binary encoding of the messages exchanged between sensor, master and gateway nodes.
+ *
+ * Frame layout:
+ *
+ *   schema version (1 byte) | message type (1 byte) | node index (varint) | [uuid (16 bytes)] | fields
+ *
+ * The uuid is only present while the node index is 0, i.e. before the node is enrolled.
+ * Enrollment: a node sends its readings with index 0 and its uuid, the master assigns it an index
+ * and answers with an enroll frame. From then on the node only sends the index.
+ * A master that lost its node table answers an index it doesn't know with a reenroll frame.
+ * Every field is a varint tag followed by a varint value, so a parser skips tags it does not know.
+ * New sensor types are added as new tags without changing the schema version.
+ *
+ * Size of a reading (moisture < 16384, version < 128):
+ *   - legacy sensor_node_message: 20 bytes
+ *   - enrolled node (index < 128): 8 bytes
+ *   - not enrolled node: 24 bytes
+ */
+
+#pragma once
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "stddef.h"
+
+/**
+ * @brief Current schema version, written as the first byte of every frame.
+ *
+ * @note Only bumped when the frame header changes. Adding fields does not need a new version.
+ */
+#define MESH_WIRE_SCHEMA_VERSION 1
+
+/**
+ * @brief Maximum size of an encoded frame.
+ */
+#define MESH_WIRE_MAX_FRAME_SIZE 64
+
+/**
+ * @brief Number of field tags that are kept when decoding. Higher tags are skipped.
+ */
+#define MESH_WIRE_MAX_FIELDS 32
+
+/**
+ * @brief Maximum number of enrolled nodes. Node indexes go from 1 to MESH_WIRE_MAX_NODES.
+ */
+#define MESH_WIRE_MAX_NODES 64
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief Message types.
+     */
+    typedef enum
+    {
+        MESH_WIRE_MSG_READING = 1,    ///< Sensor reading, uplink.
+        MESH_WIRE_MSG_CONFIG = 2,     ///< Node configuration, downlink.
+        MESH_WIRE_MSG_ENROLL = 3,     ///< Node index assigned to a uuid, sent by the master to the node and the gateway.
+        MESH_WIRE_MSG_ENROLL_SYNC = 4, ///< Request to the master to resend all enroll frames, sent by the gateway.
+        MESH_WIRE_MSG_CONFIG_CACHE = 5, ///< Node configuration the master keeps until the node is awake, sent by the gateway. No fields removes it.
+        MESH_WIRE_MSG_CONFIG_SYNC = 6,  ///< Request to the gateway to resend all cached configurations, sent by the master.
+        MESH_WIRE_MSG_REENROLL = 7      ///< Node index the master doesn't know, sent to the node, which drops it and enrolls again.
+    } mesh_wire_msg_type_t;
+
+    /**
+     * @brief Field tags.
+     *
+     * @attention Tags are part of the wire format. Never reuse or renumber an existing tag.
+     */
+    typedef enum
+    {
+        MESH_WIRE_FIELD_MOISTURE = 1,    ///< Raw ADC reading of the moisture sensor.
+        MESH_WIRE_FIELD_VERSION = 2,     ///< Configuration version.
+        MESH_WIRE_FIELD_INTERVAL = 3,    ///< Measurement interval in seconds.
+        MESH_WIRE_FIELD_LED_STATE = 4,   ///< Debug LED state.
+        MESH_WIRE_FIELD_TEMPERATURE = 5, ///< Temperature in 0.1 degrees Celsius, signed.
+        MESH_WIRE_FIELD_BATTERY_MV = 6,  ///< Supply voltage in millivolts.
+        MESH_WIRE_FIELD_NODE_INDEX = 7,  ///< Assigned node index, enroll frames only.
+        MESH_WIRE_FIELD_WAKE_MS = 8,     ///< Telemetry: duration of the previous wake in milliseconds.
+        MESH_WIRE_FIELD_SEND_ATTEMPTS = 9, ///< Telemetry: uplink send attempts during the previous wake.
+        MESH_WIRE_FIELD_CONFIG_RTT_MS = 10, ///< Telemetry: time from uplink to config response in the previous wake, 0 if none.
+        MESH_WIRE_FIELD_SEQUENCE = 11      ///< Per node publish counter added by the gateway to binary MQTT payloads and spooled readings.
+    } mesh_wire_field_t;
+
+    /**
+     * @brief Decoded frame.
+     */
+    typedef struct
+    {
+        uint8_t schema;                       ///< Schema version of the frame. @note
+        uint8_t type;                         ///< Message type, see mesh_wire_msg_type_t. @note
+        uint16_t node_index;                  ///< Network-assigned node index, 0 if the node is not enrolled. @note
+        uint8_t uuid[16];                     ///< Node UUID. @note Only valid when node_index is 0.
+        uint32_t present;                     ///< Bit mask of present fields, bit n is set when tag n is present. @note
+        uint32_t values[MESH_WIRE_MAX_FIELDS]; ///< Field values indexed by tag. @note
+    } mesh_wire_frame_t;
+
+    /**
+     * @brief Initialize an empty frame of the given type.
+     */
+    void mesh_wire_init(mesh_wire_frame_t *frame, uint8_t type);
+
+    /**
+     * @brief Set an unsigned field.
+     */
+    void mesh_wire_set(mesh_wire_frame_t *frame, uint8_t tag, uint32_t value);
+
+    /**
+     * @brief Set a signed field, stored zigzag encoded.
+     */
+    void mesh_wire_set_signed(mesh_wire_frame_t *frame, uint8_t tag, int32_t value);
+
+    /**
+     * @brief Check if a field is present.
+     */
+    bool mesh_wire_has(const mesh_wire_frame_t *frame, uint8_t tag);
+
+    /**
+     * @brief Get an unsigned field or the fallback if it is not present.
+     */
+    uint32_t mesh_wire_get(const mesh_wire_frame_t *frame, uint8_t tag, uint32_t fallback);
+
+    /**
+     * @brief Get a signed field or the fallback if it is not present.
+     */
+    int32_t mesh_wire_get_signed(const mesh_wire_frame_t *frame, uint8_t tag, int32_t fallback);
+
+    /**
+     * @brief Encode a frame.
+     *
+     * @return
+     *              - Number of bytes written to buf
+     *              - 0 if buf is too small
+     */
+    size_t mesh_wire_encode(const mesh_wire_frame_t *frame, uint8_t *buf, size_t buf_len);
+
+    /**
+     * @brief Decode a frame. Unknown tags are skipped.
+     *
+     * @return
+     *              - true if the frame was decoded
+     *              - false if the frame is truncated, malformed or has a newer schema version
+     */
+    bool mesh_wire_decode(mesh_wire_frame_t *frame, const uint8_t *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
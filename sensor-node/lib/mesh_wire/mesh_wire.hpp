@@ -0,0 +1,155 @@
+/**
+ * @file
+ * C++ interface of the mesh_wire component.
+ *
+ * Thin wrapper around the C functions in mesh_wire.c, so firmware, backend tooling and host tests decode frames
+ * with the same code. Needs C++17 and mesh_wire.c in the build.
+ *
+ * Decoding a binary payload from mesh/out:
+ *
+ *   auto frame = mesh_wire::Frame::decode(payload.data(), payload.size());
+ *   if (frame && frame->type() == mesh_wire::MessageType::Reading) {
+ *       std::string id = frame->id();
+ *       uint32_t moisture = frame->get(mesh_wire::Field::Moisture).value_or(0);
+ *   }
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <string>
+#include <vector>
+#include "mesh_wire.h"
+
+namespace mesh_wire
+{
+    /**
+     * @brief Message types, see mesh_wire_msg_type_t.
+     */
+    enum class MessageType : uint8_t
+    {
+        Reading = MESH_WIRE_MSG_READING,
+        Config = MESH_WIRE_MSG_CONFIG,
+        Enroll = MESH_WIRE_MSG_ENROLL,
+        EnrollSync = MESH_WIRE_MSG_ENROLL_SYNC,
+        ConfigCache = MESH_WIRE_MSG_CONFIG_CACHE,
+        ConfigSync = MESH_WIRE_MSG_CONFIG_SYNC,
+        Reenroll = MESH_WIRE_MSG_REENROLL
+    };
+
+    /**
+     * @brief Field tags, see mesh_wire_field_t.
+     */
+    enum class Field : uint8_t
+    {
+        Moisture = MESH_WIRE_FIELD_MOISTURE,
+        Version = MESH_WIRE_FIELD_VERSION,
+        Interval = MESH_WIRE_FIELD_INTERVAL,
+        LedState = MESH_WIRE_FIELD_LED_STATE,
+        Temperature = MESH_WIRE_FIELD_TEMPERATURE,
+        BatteryMv = MESH_WIRE_FIELD_BATTERY_MV,
+        NodeIndex = MESH_WIRE_FIELD_NODE_INDEX,
+        WakeMs = MESH_WIRE_FIELD_WAKE_MS,
+        SendAttempts = MESH_WIRE_FIELD_SEND_ATTEMPTS,
+        ConfigRttMs = MESH_WIRE_FIELD_CONFIG_RTT_MS,
+        Sequence = MESH_WIRE_FIELD_SEQUENCE
+    };
+
+    /**
+     * @brief A decoded frame.
+     */
+    class Frame
+    {
+    public:
+        /**
+         * @brief Empty frame of the given type.
+         */
+        explicit Frame(MessageType type)
+        {
+            mesh_wire_init(&frame_, static_cast<uint8_t>(type));
+        }
+
+        /**
+         * @brief Decode a frame, nothing if it is truncated or malformed.
+         */
+        static std::optional<Frame> decode(const uint8_t *data, size_t len)
+        {
+            Frame frame(MessageType::Reading);
+            if (!mesh_wire_decode(&frame.frame_, data, len)) {
+                return std::nullopt;
+            }
+            return frame;
+        }
+
+        /**
+         * @brief Encode the frame, empty if it does not fit in MESH_WIRE_MAX_FRAME_SIZE.
+         */
+        std::vector<uint8_t> encode() const
+        {
+            std::vector<uint8_t> buffer(MESH_WIRE_MAX_FRAME_SIZE);
+            buffer.resize(mesh_wire_encode(&frame_, buffer.data(), buffer.size()));
+            return buffer;
+        }
+
+        uint8_t schema() const { return frame_.schema; }
+        MessageType type() const { return static_cast<MessageType>(frame_.type); }
+        uint16_t node_index() const { return frame_.node_index; }
+        void set_node_index(uint16_t index) { frame_.node_index = index; }
+
+        /**
+         * @brief Node uuid. @note Only valid when node_index is 0, which is always the case for MQTT payloads.
+         */
+        std::array<uint8_t, 16> uuid() const
+        {
+            std::array<uint8_t, 16> uuid;
+            std::copy(std::begin(frame_.uuid), std::end(frame_.uuid), uuid.begin());
+            return uuid;
+        }
+
+        void set_uuid(const std::array<uint8_t, 16> &uuid)
+        {
+            std::copy(uuid.begin(), uuid.end(), frame_.uuid);
+        }
+
+        /**
+         * @brief Node uuid as the 32 hex digits used for the "id" in JSON payloads and topics.
+         */
+        std::string id() const
+        {
+            static const char digits[] = "0123456789abcdef";
+            std::string hex;
+            for (uint8_t byte : frame_.uuid) {
+                hex += digits[byte >> 4];
+                hex += digits[byte & 0x0F];
+            }
+            return hex;
+        }
+
+        bool has(Field tag) const { return mesh_wire_has(&frame_, static_cast<uint8_t>(tag)); }
+
+        std::optional<uint32_t> get(Field tag) const
+        {
+            if (!has(tag)) return std::nullopt;
+            return mesh_wire_get(&frame_, static_cast<uint8_t>(tag), 0);
+        }
+
+        std::optional<int32_t> get_signed(Field tag) const
+        {
+            if (!has(tag)) return std::nullopt;
+            return mesh_wire_get_signed(&frame_, static_cast<uint8_t>(tag), 0);
+        }
+
+        void set(Field tag, uint32_t value) { mesh_wire_set(&frame_, static_cast<uint8_t>(tag), value); }
+        void set_signed(Field tag, int32_t value) { mesh_wire_set_signed(&frame_, static_cast<uint8_t>(tag), value); }
+
+        /**
+         * @brief The underlying C frame.
+         */
+        const mesh_wire_frame_t &raw() const { return frame_; }
+
+    private:
+        mesh_wire_frame_t frame_;
+    };
+}
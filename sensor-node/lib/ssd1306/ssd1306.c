@@ -1,66 +1,493 @@
 #include <string.h>
 
+#include "ssd1306.h"
+#ifndef SSD1306_HOST
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#endif
 
-#include "ssd1306.h"
 #include "font8x8_basic.h"
+#include "ssd1306_tables.h"
 
 #define PACK8 __attribute__((aligned( __alignof__( uint8_t ) ), packed ))
 
+// Bytes a transfer costs on top of its data: addressing commands with their
+// control bytes and the I2C address. Used to choose between sending dirty
+// spans one by one or their bounding rectangle.
+#define TRANSFER_OVERHEAD 14
+
+#define ASYNC_TASK_STACK_SIZE 3072
+
+// Notification bits of the display task
+#define ASYNC_FRAME 0x01 // ssd1306_flush_async queued changes in _back
+#define ASYNC_TICK 0x02 // The animation timer asks for the next frame
+
 typedef union out_column_t {
 	uint32_t u32;
 	uint8_t  u8[4];
 } PACK8 out_column_t;
 
+// While a display task runs, writes to the panel wait until it is idle, so
+// they neither interleave with its transfers nor overtake a queued frame
+static void _ssd1306_panel_take(SSD1306_t * dev)
+{
+#ifndef SSD1306_HOST
+	if (dev->_back != NULL) xSemaphoreTake(dev->_idle, portMAX_DELAY);
+#endif
+}
+
+static void _ssd1306_panel_give(SSD1306_t * dev)
+{
+#ifndef SSD1306_HOST
+	if (dev->_back != NULL) xSemaphoreGive(dev->_idle);
+#endif
+}
+
+// Copy what was just sent from the drawing buffer into _back. The display
+// task may send clean segments of _back as part of a rectangle, so they have
+// to match the panel.
+static void _ssd1306_mirror(SSD1306_t * dev, int page_start, int page_end, int seg, int width)
+{
+	if (dev->_back == NULL) return;
+	for (int page=page_start; page<=page_end; page++) {
+		memcpy(&dev->_back->_page[page]._segs[seg], &dev->_page[page]._segs[seg], width);
+	}
+}
+
+// Send a span of one page to the panel without touching the internal buffer
+static void _ssd1306_send(SSD1306_t * dev, int page, int seg, uint8_t * images, int width)
+{
+	_ssd1306_panel_take(dev);
+	dev->_transport->display_image(dev, page, seg, images, width);
+	if (dev->_back != NULL) memcpy(&dev->_back->_page[page]._segs[seg], images, width);
+	_ssd1306_panel_give(dev);
+}
+
+// Extend the dirty span of a page by the segments seg to seg+width-1
+static void _ssd1306_set_dirty(SSD1306_t * dev, int page, int seg, int width)
+{
+	if (page < 0 || page >= SSD1306_DEV_PAGES(dev)) return;
+	int _start = seg < 0 ? 0 : seg;
+	int _end = seg + width - 1;
+	if (_end >= SSD1306_DEV_WIDTH(dev)) _end = SSD1306_DEV_WIDTH(dev) - 1;
+	if (_start > _end) return;
+	PAGE_t * _page = &dev->_page[page];
+	if (_page->_dirtyStart < 0 || _start < _page->_dirtyStart) _page->_dirtyStart = _start;
+	if (_end > _page->_dirtyEnd) _page->_dirtyEnd = _end;
+}
+
+static void _ssd1306_clear_dirty(SSD1306_t * dev, int page)
+{
+	dev->_page[page]._dirtyStart = -1;
+	dev->_page[page]._dirtyEnd = -1;
+}
+
+// Shrink the dirty span of a page after segments seg to seg+width-1 were sent.
+// The span is a single range, so a send inside it leaves it as it is.
+static void _ssd1306_sent(SSD1306_t * dev, int page, int seg, int width)
+{
+	PAGE_t * _page = &dev->_page[page];
+	int _end = seg + width - 1;
+	if (_page->_dirtyStart < 0 || width <= 0) return;
+	if (seg <= _page->_dirtyStart && _end >= _page->_dirtyEnd) {
+		_ssd1306_clear_dirty(dev, page);
+	} else if (seg <= _page->_dirtyStart && _end >= _page->_dirtyStart) {
+		_page->_dirtyStart = _end + 1;
+	} else if (seg <= _page->_dirtyEnd && _end >= _page->_dirtyEnd) {
+		_page->_dirtyEnd = seg - 1;
+	}
+}
+
+// Send pages page_start to page_end, segments seg to seg+width-1, in one transfer
+static void _ssd1306_send_rect(SSD1306_t * dev, int page_start, int page_end, int seg, int width)
+{
+	_ssd1306_panel_take(dev);
+	dev->_transport->display_rect(dev, page_start, page_end, seg, width);
+	_ssd1306_mirror(dev, page_start, page_end, seg, width);
+	_ssd1306_panel_give(dev);
+}
+
+// Transpose an 8x8 bit block given as 8 rows with the leftmost pixel in bit 7.
+// Byte n of the result is column 7-n with the first row in bit 0, which is
+// how the panel stores a segment of a page.
+static uint64_t _ssd1306_transpose8(const uint8_t * rows)
+{
+	uint64_t x = 0;
+	for (int i=0;i<8;i++) {
+		x |= (uint64_t)rows[i] << (i*8);
+	}
+	uint64_t t;
+	t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+	x = x ^ t ^ (t << 7);
+	t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+	x = x ^ t ^ (t << 14);
+	t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+	x = x ^ t ^ (t << 28);
+	return x;
+}
+
+// Copy the glyph of a character, flipped and inverted as needed
+static void _ssd1306_glyph(SSD1306_t * dev, char ch, bool invert, uint8_t * image)
+{
+	uint8_t code = (uint8_t)ch & 0x7F;
+	memcpy(image, dev->_flip ? font8x8_basic_flip[code] : font8x8_basic_tr[code], 8);
+	if (invert) ssd1306_invert(image, 8);
+}
+
+// The transfer buffer is kept across ssd1306_init and ssd1306_resume calls,
+// the master init functions start a device without one
+static bool _ssd1306_alloc_out_buf(SSD1306_t * dev)
+{
+	if (dev->_out_buf != NULL) return true;
+	dev->_out_buf = heap_caps_malloc(SSD1306_TRANSFER_SIZE, MALLOC_CAP_DMA);
+	if (dev->_out_buf == NULL) {
+		ESP_LOGE(__FUNCTION__, "transfer buffer allocation failed");
+		return false;
+	}
+	return true;
+}
+
+// Call after i2c_master_init, spi_master_init or memory_init
 void ssd1306_init(SSD1306_t * dev, int width, int height)
 {
-	if (dev->_address == SPI_ADDRESS) {
-		spi_init(dev, width, height);
-	} else {
-		i2c_init(dev, width, height);
+	dev->_task = NULL;
+	dev->_timer = NULL;
+	dev->_idle = NULL;
+	dev->_back = NULL;
+	memset(dev->_anim, 0, sizeof(dev->_anim));
+	dev->_scOffset = 0;
+#ifdef SSD1306_FIXED_HEIGHT
+	if (width != 128 || height != SSD1306_FIXED_HEIGHT) {
+		ESP_LOGE(__FUNCTION__, "built for 128x%d panels only", SSD1306_FIXED_HEIGHT);
+		return;
 	}
+#endif
+	if (!_ssd1306_alloc_out_buf(dev)) return;
+	dev->_transport->init(dev, width, height);
 	// Initialize internal buffer
-	for (int i=0;i<dev->_pages;i++) {
+	for (int i=0;i<SSD1306_DEV_PAGES(dev);i++) {
+		memset(dev->_page[i]._segs, 0, 128);
+		_ssd1306_clear_dirty(dev, i);
+	}
+}
+
+// Take over a panel that ssd1306_init configured before, e.g. ahead of a
+// deep sleep. Only the display start line is sent, so a scroll offset left
+// from before is undone. The panel keeps showing its RAM while the internal
+// buffer starts out cleared, so callers redraw what they change over the
+// full width of a page.
+void ssd1306_resume(SSD1306_t * dev, int width, int height)
+{
+	dev->_task = NULL;
+	dev->_timer = NULL;
+	dev->_idle = NULL;
+	dev->_back = NULL;
+	memset(dev->_anim, 0, sizeof(dev->_anim));
+	dev->_scOffset = 0;
+#ifdef SSD1306_FIXED_HEIGHT
+	if (width != 128 || height != SSD1306_FIXED_HEIGHT) {
+		ESP_LOGE(__FUNCTION__, "built for 128x%d panels only", SSD1306_FIXED_HEIGHT);
+		return;
+	}
+#endif
+	if (!_ssd1306_alloc_out_buf(dev)) return;
+	dev->_width = width;
+	dev->_height = height;
+	dev->_pages = 8;
+	if (dev->_height == 32) dev->_pages = 4;
+	dev->_transport->start_line(dev, 0);
+	for (int i=0;i<SSD1306_DEV_PAGES(dev);i++) {
 		memset(dev->_page[i]._segs, 0, 128);
+		_ssd1306_clear_dirty(dev, i);
 	}
 }
 
 int ssd1306_get_width(SSD1306_t * dev)
 {
-	return dev->_width;
+	return SSD1306_DEV_WIDTH(dev);
 }
 
 int ssd1306_get_height(SSD1306_t * dev)
 {
-	return dev->_height;
+	return SSD1306_DEV_HEIGHT(dev);
 }
 
 int ssd1306_get_pages(SSD1306_t * dev)
 {
-	return dev->_pages;
+	return SSD1306_DEV_PAGES(dev);
 }
 
+// Send the whole frame in one transfer
 void ssd1306_show_buffer(SSD1306_t * dev)
 {
-	if (dev->_address == SPI_ADDRESS) {
-		for (int page=0; page<dev->_pages;page++) {
-			spi_display_image(dev, page, 0, dev->_page[page]._segs, dev->_width);
+	_ssd1306_send_rect(dev, 0, SSD1306_DEV_PAGES(dev)-1, 0, SSD1306_DEV_WIDTH(dev));
+	for (int page=0; page<SSD1306_DEV_PAGES(dev);page++) {
+		_ssd1306_clear_dirty(dev, page);
+	}
+}
+
+// Send only the segments changed since the last flush: either one transfer
+// per dirty page or a single transfer of the rectangle around all of them,
+// whichever moves fewer bytes.
+void ssd1306_flush(SSD1306_t * dev)
+{
+	int spans = 0;
+	int span_bytes = 0;
+	int page_start = -1;
+	int page_end = -1;
+	int seg_start = SSD1306_DEV_WIDTH(dev);
+	int seg_end = -1;
+	for (int page=0; page<SSD1306_DEV_PAGES(dev);page++) {
+		PAGE_t * _page = &dev->_page[page];
+		if (_page->_dirtyStart < 0) continue;
+		spans++;
+		span_bytes = span_bytes + TRANSFER_OVERHEAD + _page->_dirtyEnd - _page->_dirtyStart + 1;
+		if (page_start < 0) page_start = page;
+		page_end = page;
+		if (_page->_dirtyStart < seg_start) seg_start = _page->_dirtyStart;
+		if (_page->_dirtyEnd > seg_end) seg_end = _page->_dirtyEnd;
+	}
+	if (spans == 0) return;
+
+	int seg_width = seg_end - seg_start + 1;
+	int rect_bytes = TRANSFER_OVERHEAD + seg_width * (page_end - page_start + 1);
+	if (spans > 1 && rect_bytes <= span_bytes) {
+		_ssd1306_send_rect(dev, page_start, page_end, seg_start, seg_width);
+		for (int page=page_start; page<=page_end;page++) {
+			_ssd1306_clear_dirty(dev, page);
 		}
-	} else {
-		for (int page=0; page<dev->_pages;page++) {
-			i2c_display_image(dev, page, 0, dev->_page[page]._segs, dev->_width);
+		return;
+	}
+	for (int page=page_start; page<=page_end;page++) {
+		int _start = dev->_page[page]._dirtyStart;
+		if (_start < 0) continue;
+		int _width = dev->_page[page]._dirtyEnd - _start + 1;
+		_ssd1306_send_rect(dev, page, page, _start, _width);
+		_ssd1306_clear_dirty(dev, page);
+	}
+}
+
+static bool _ssd1306_animation_frame(SSD1306_t * dev, SSD1306_t * target);
+
+#ifndef SSD1306_HOST
+static void _ssd1306_async_task(void * arg)
+{
+	SSD1306_t * dev = arg;
+	for (;;) {
+		uint32_t bits;
+		xTaskNotifyWait(0, UINT32_MAX, &bits, portMAX_DELAY);
+		if (bits & ASYNC_FRAME) {
+			ssd1306_flush(dev->_back);
+			xSemaphoreGive(dev->_idle);
+		}
+		// _idle is only taken here if a frame is being queued, whose
+		// notification follows. Skip this tick rather than wait for it.
+		if ((bits & ASYNC_TICK) && xSemaphoreTake(dev->_idle, 0) == pdTRUE) {
+			if (!_ssd1306_animation_frame(dev, dev->_back)) {
+				esp_timer_stop(dev->_timer);
+			}
+			xSemaphoreGive(dev->_idle);
+		}
+	}
+}
+
+static void _ssd1306_animation_timer(void * arg)
+{
+	SSD1306_t * dev = arg;
+	xTaskNotify(dev->_task, ASYNC_TICK, eSetBits);
+}
+
+// Undo a failed ssd1306_async_init, flushes stay synchronous
+static void _ssd1306_async_free(SSD1306_t * dev, SSD1306_t * back)
+{
+	if (dev->_timer != NULL) esp_timer_delete(dev->_timer);
+	if (dev->_idle != NULL) vSemaphoreDelete(dev->_idle);
+	heap_caps_free(back->_out_buf);
+	heap_caps_free(back);
+	dev->_task = NULL;
+	dev->_timer = NULL;
+	dev->_idle = NULL;
+	dev->_back = NULL;
+}
+
+// Start a display task that sends the frames queued by ssd1306_flush_async.
+// The task sends from a copy of the buffer with its own transfer buffer, so
+// the caller can keep drawing while a frame is on the bus. The functions that
+// write to the panel directly wait for the task and copy what they sent into
+// its frame.
+bool ssd1306_async_init(SSD1306_t * dev, UBaseType_t priority)
+{
+	if (dev->_task != NULL) return true;
+	SSD1306_t * back = heap_caps_malloc(sizeof(SSD1306_t), MALLOC_CAP_8BIT);
+	if (back == NULL) {
+		ESP_LOGE(__FUNCTION__, "back buffer allocation failed");
+		return false;
+	}
+	memcpy(back, dev, sizeof(SSD1306_t));
+	back->_out_buf = heap_caps_malloc(SSD1306_TRANSFER_SIZE, MALLOC_CAP_DMA);
+	dev->_idle = xSemaphoreCreateBinary();
+	if (back->_out_buf == NULL || dev->_idle == NULL) {
+		ESP_LOGE(__FUNCTION__, "async state allocation failed");
+		_ssd1306_async_free(dev, back);
+		return false;
+	}
+	xSemaphoreGive(dev->_idle);
+	dev->_back = back;
+	esp_timer_create_args_t timer_args = {
+		.callback = _ssd1306_animation_timer,
+		.arg = dev,
+		.name = "ssd1306",
+	};
+	if (esp_timer_create(&timer_args, &dev->_timer) != ESP_OK) {
+		ESP_LOGE(__FUNCTION__, "animation timer creation failed");
+		dev->_timer = NULL;
+		_ssd1306_async_free(dev, back);
+		return false;
+	}
+	if (xTaskCreate(_ssd1306_async_task, "ssd1306", ASYNC_TASK_STACK_SIZE, dev, priority, &dev->_task) != pdPASS) {
+		ESP_LOGE(__FUNCTION__, "display task creation failed");
+		_ssd1306_async_free(dev, back);
+		return false;
+	}
+	return true;
+}
+#else
+// There is no display task on the host. The back buffer is still set up and
+// ssd1306_flush_async sends it right away, so tests go through the same copies.
+bool ssd1306_async_init(SSD1306_t * dev, UBaseType_t priority)
+{
+	if (dev->_back != NULL) return true;
+	SSD1306_t * back = heap_caps_malloc(sizeof(SSD1306_t), MALLOC_CAP_8BIT);
+	if (back == NULL) return false;
+	memcpy(back, dev, sizeof(SSD1306_t));
+	back->_out_buf = heap_caps_malloc(SSD1306_TRANSFER_SIZE, MALLOC_CAP_DMA);
+	if (back->_out_buf == NULL) {
+		heap_caps_free(back);
+		return false;
+	}
+	dev->_back = back;
+	return true;
+}
+#endif
+
+// Queue the changes since the last flush for the display task and return.
+// Only waits if the previous frame is still being sent. Without a display
+// task this is the same as ssd1306_flush.
+void ssd1306_flush_async(SSD1306_t * dev)
+{
+	if (dev->_back == NULL) {
+		ssd1306_flush(dev);
+		return;
+	}
+
+	bool dirty = false;
+	for (int page=0; page<SSD1306_DEV_PAGES(dev);page++) {
+		if (dev->_page[page]._dirtyStart >= 0) dirty = true;
+	}
+	if (!dirty) return;
+
+	_ssd1306_panel_take(dev);
+	// Only the changes are copied, _back may hold animation frames the
+	// drawing buffer does not. Its clean segments match the panel, direct
+	// writes are mirrored into it, so the bounding rectangle flush can still
+	// send them.
+	for (int page=0; page<SSD1306_DEV_PAGES(dev);page++) {
+		int _start = dev->_page[page]._dirtyStart;
+		if (_start < 0) continue;
+		int _width = dev->_page[page]._dirtyEnd - _start + 1;
+		memcpy(&dev->_back->_page[page]._segs[_start], &dev->_page[page]._segs[_start], _width);
+		_ssd1306_set_dirty(dev->_back, page, _start, _width);
+		_ssd1306_clear_dirty(dev, page);
+	}
+	dev->_back->_scOffset = dev->_scOffset;
+#ifndef SSD1306_HOST
+	// The display task gives _idle back once the frame is sent
+	xTaskNotify(dev->_task, ASYNC_FRAME, eSetBits);
+#else
+	ssd1306_flush(dev->_back);
+#endif
+}
+
+#ifndef SSD1306_HOST
+// Wait until the display task has sent every queued frame
+bool ssd1306_flush_wait(SSD1306_t * dev, TickType_t ticks_to_wait)
+{
+	if (dev->_task == NULL) return true;
+	if (xSemaphoreTake(dev->_idle, ticks_to_wait) != pdTRUE) return false;
+	xSemaphoreGive(dev->_idle);
+	return true;
+}
+
+// Hand an effect to the display task and make sure its frame timer runs
+static bool _ssd1306_animation_queue(SSD1306_t * dev, ANIMATION_t * anim)
+{
+	xSemaphoreTake(dev->_idle, portMAX_DELAY);
+	ANIMATION_t * slot = NULL;
+	for (int i=0;i<SSD1306_ANIMATIONS;i++) {
+		if (dev->_anim[i]._type == ANIMATION_NONE) {
+			slot = &dev->_anim[i];
+			break;
+		}
+	}
+	if (slot != NULL) {
+		*slot = *anim;
+		if (!esp_timer_is_active(dev->_timer)) {
+			esp_timer_start_periodic(dev->_timer, SSD1306_ANIMATION_PERIOD_MS * 1000);
+		}
+	}
+	xSemaphoreGive(dev->_idle);
+	if (slot == NULL) {
+		ESP_LOGW(__FUNCTION__, "all %d animation slots are in use", SSD1306_ANIMATIONS);
+		return false;
+	}
+	return true;
+}
+
+// Wait until every effect has shown its last frame
+bool ssd1306_animation_wait(SSD1306_t * dev, TickType_t ticks_to_wait)
+{
+	if (dev->_task == NULL) return true;
+	TickType_t start = xTaskGetTickCount();
+	for (;;) {
+		bool running = false;
+		xSemaphoreTake(dev->_idle, portMAX_DELAY);
+		for (int i=0;i<SSD1306_ANIMATIONS;i++) {
+			if (dev->_anim[i]._type != ANIMATION_NONE) running = true;
 		}
+		xSemaphoreGive(dev->_idle);
+		if (!running) return true;
+		if (xTaskGetTickCount() - start >= ticks_to_wait) return false;
+		vTaskDelay(1);
 	}
 }
+#else
+bool ssd1306_flush_wait(SSD1306_t * dev, TickType_t ticks_to_wait)
+{
+	return true;
+}
+
+static bool _ssd1306_animation_queue(SSD1306_t * dev, ANIMATION_t * anim)
+{
+	return false;
+}
+
+bool ssd1306_animation_wait(SSD1306_t * dev, TickType_t ticks_to_wait)
+{
+	return true;
+}
+#endif
 
 void ssd1306_set_buffer(SSD1306_t * dev, uint8_t * buffer)
 {
 	int index = 0;
-	for (int page=0; page<dev->_pages;page++) {
+	for (int page=0; page<SSD1306_DEV_PAGES(dev);page++) {
 		memcpy(&dev->_page[page]._segs, &buffer[index], 128);
+		_ssd1306_set_dirty(dev, page, 0, SSD1306_DEV_WIDTH(dev));
 		index = index + 128;
 	}
 }
@@ -68,7 +495,7 @@ void ssd1306_set_buffer(SSD1306_t * dev, uint8_t * buffer)
 void ssd1306_get_buffer(SSD1306_t * dev, uint8_t * buffer)
 {
 	int index = 0;
-	for (int page=0; page<dev->_pages;page++) {
+	for (int page=0; page<SSD1306_DEV_PAGES(dev);page++) {
 		memcpy(&buffer[index], &dev->_page[page]._segs, 128);
 		index = index + 128;
 	}
@@ -77,6 +504,7 @@ void ssd1306_get_buffer(SSD1306_t * dev, uint8_t * buffer)
 void ssd1306_set_page(SSD1306_t * dev, int page, uint8_t * buffer)
 {
 	memcpy(&dev->_page[page]._segs, buffer, 128);
+	_ssd1306_set_dirty(dev, page, 0, SSD1306_DEV_WIDTH(dev));
 }
 
 void ssd1306_get_page(SSD1306_t * dev, int page, uint8_t * buffer)
@@ -86,44 +514,48 @@ void ssd1306_get_page(SSD1306_t * dev, int page, uint8_t * buffer)
 
 void ssd1306_display_image(SSD1306_t * dev, int page, int seg, uint8_t * images, int width)
 {
-	if (dev->_address == SPI_ADDRESS) {
-		spi_display_image(dev, page, seg, images, width);
-	} else {
-		i2c_display_image(dev, page, seg, images, width);
-	}
+	_ssd1306_send(dev, page, seg, images, width);
 	// Set to internal buffer
 	memcpy(&dev->_page[page]._segs[seg], images, width);
 }
 
-void ssd1306_display_text(SSD1306_t * dev, int page, char * text, int text_len, bool invert)
+// Set text to internal buffer. Not show it.
+void _ssd1306_display_text(SSD1306_t * dev, int page, const char * text, int text_len, bool invert)
 {
-	if (page >= dev->_pages) return;
+	if (page >= SSD1306_DEV_PAGES(dev)) return;
 	int _text_len = text_len;
 	if (_text_len > 16) _text_len = 16;
 
-	int seg = 0;
-	uint8_t image[8];
+	uint8_t * image = dev->_page[page]._segs;
 	for (int i = 0; i < _text_len; i++) {
-		memcpy(image, font8x8_basic_tr[(uint8_t)text[i]], 8);
-		if (invert) ssd1306_invert(image, 8);
-		if (dev->_flip) ssd1306_flip(image, 8);
-		ssd1306_display_image(dev, page, seg, image, 8);
-		seg = seg + 8;
+		_ssd1306_glyph(dev, text[i], invert, image);
+		image = image + 8;
 	}
+	_ssd1306_set_dirty(dev, page, 0, _text_len * 8);
+}
+
+// Render the whole line first and send it in one transfer instead of one per character
+void ssd1306_display_text(SSD1306_t * dev, int page, const char * text, int text_len, bool invert)
+{
+	if (page >= SSD1306_DEV_PAGES(dev)) return;
+	int _text_len = text_len;
+	if (_text_len > 16) _text_len = 16;
+
+	_ssd1306_display_text(dev, page, text, _text_len, invert);
+	_ssd1306_send(dev, page, 0, dev->_page[page]._segs, _text_len * 8);
+	_ssd1306_sent(dev, page, 0, _text_len * 8);
 }
 
-void ssd1306_display_text_box1(SSD1306_t * dev, int page, int seg, char * text, int box_width, int text_len, bool invert, int delay)
+void ssd1306_display_text_box1(SSD1306_t * dev, int page, int seg, const char * text, int box_width, int text_len, bool invert, int delay)
 {
-	if (page >= dev->_pages) return;
+	if (page >= SSD1306_DEV_PAGES(dev)) return;
 	int text_box_pixel = box_width * 8;
-	if (seg + text_box_pixel > dev->_width) return;
+	if (seg + text_box_pixel > SSD1306_DEV_WIDTH(dev)) return;
 
 	int _seg = seg;
 	uint8_t image[8];
 	for (int i = 0; i < box_width; i++) {
-		memcpy(image, font8x8_basic_tr[(uint8_t)text[i]], 8);
-		if (invert) ssd1306_invert(image, 8);
-		if (dev->_flip) ssd1306_flip(image, 8);
+		_ssd1306_glyph(dev, text[i], invert, image);
 		ssd1306_display_image(dev, page, _seg, image, 8);
 		_seg = _seg + 8;
 	}
@@ -131,9 +563,7 @@ void ssd1306_display_text_box1(SSD1306_t * dev, int page, int seg, char * text,
 
 	// Horizontally scroll inside the box
 	for (int _text=box_width;_text<text_len;_text++) {
-		memcpy(image, font8x8_basic_tr[(uint8_t)text[_text]], 8);
-		if (invert) ssd1306_invert(image, 8);
-		if (dev->_flip) ssd1306_flip(image, 8);
+		_ssd1306_glyph(dev, text[_text], invert, image);
 		for (int _bit=0;_bit<8;_bit++) {
 			for (int _pixel=0;_pixel<text_box_pixel;_pixel++) {
 				//ESP_LOGI(__FUNCTION__, "_text=%d _bit=%d _pixel=%d", _text, _bit, _pixel);
@@ -146,21 +576,18 @@ void ssd1306_display_text_box1(SSD1306_t * dev, int page, int seg, char * text,
 	}
 }
 
-void ssd1306_display_text_box2(SSD1306_t * dev, int page, int seg, char * text, int box_width, int text_len, bool invert, int delay)
+void ssd1306_display_text_box2(SSD1306_t * dev, int page, int seg, const char * text, int box_width, int text_len, bool invert, int delay)
 {
-	if (page >= dev->_pages) return;
+	if (page >= SSD1306_DEV_PAGES(dev)) return;
 	int text_box_pixel = box_width * 8;
-	if (seg + text_box_pixel > dev->_width) return;
+	if (seg + text_box_pixel > SSD1306_DEV_WIDTH(dev)) return;
 
 	int _seg = seg;
 	uint8_t image[8];
 
 	// Fill the text box with blanks
 	for (int i = 0; i < box_width; i++) {
-		//memcpy(image, font8x8_basic_tr[(uint8_t)text[i]], 8);
-		memcpy(image, font8x8_basic_tr[0x20], 8);
-		if (invert) ssd1306_invert(image, 8);
-		if (dev->_flip) ssd1306_flip(image, 8);
+		_ssd1306_glyph(dev, ' ', invert, image);
 		ssd1306_display_image(dev, page, _seg, image, 8);
 		_seg = _seg + 8;
 	}
@@ -168,9 +595,7 @@ void ssd1306_display_text_box2(SSD1306_t * dev, int page, int seg, char * text,
 
 	// Horizontally scroll inside the box
 	for (int _text=0;_text<text_len;_text++) {
-		memcpy(image, font8x8_basic_tr[(uint8_t)text[_text]], 8);
-		if (invert) ssd1306_invert(image, 8);
-		if (dev->_flip) ssd1306_flip(image, 8);
+		_ssd1306_glyph(dev, text[_text], invert, image);
 		for (int _bit=0;_bit<8;_bit++) {
 			for (int _pixel=0;_pixel<text_box_pixel;_pixel++) {
 				//ESP_LOGI(__FUNCTION__, "_text=%d _bit=%d _pixel=%d", _text, _bit, _pixel);
@@ -184,9 +609,7 @@ void ssd1306_display_text_box2(SSD1306_t * dev, int page, int seg, char * text,
 
 	// Horizontally scroll inside the box
 	for (int _text=0;_text<box_width;_text++) {
-		memcpy(image, font8x8_basic_tr[0x20], 8);
-		if (invert) ssd1306_invert(image, 8);
-		if (dev->_flip) ssd1306_flip(image, 8);
+		_ssd1306_glyph(dev, ' ', invert, image);
 		for (int _bit=0;_bit<8;_bit++) {
 			for (int _pixel=0;_pixel<text_box_pixel;_pixel++) {
 				//ESP_LOGI(__FUNCTION__, "_text=%d _bit=%d _pixel=%d", _text, _bit, _pixel);
@@ -200,64 +623,44 @@ void ssd1306_display_text_box2(SSD1306_t * dev, int page, int seg, char * text,
 }
 
 // by Coert Vonk
+// Glyph columns are scaled through ssd1306_x3_table, the line goes out in one transfer
 void 
-ssd1306_display_text_x3(SSD1306_t * dev, int page, char * text, int text_len, bool invert)
+ssd1306_display_text_x3(SSD1306_t * dev, int page, const char * text, int text_len, bool invert)
 {
-	if (page >= dev->_pages) return;
+	if (page >= SSD1306_DEV_PAGES(dev)) return;
 	int _text_len = text_len;
 	if (_text_len > 5) _text_len = 5;
+	int _pages = SSD1306_DEV_PAGES(dev) - page;
+	if (_pages > 3) _pages = 3;
 
 	int seg = 0;
 
 	for (int nn = 0; nn < _text_len; nn++) {
 
-		uint8_t const * const in_columns = font8x8_basic_tr[(uint8_t)text[nn]];
-
-		// make the character 3x as high
-		out_column_t out_columns[8];
-		memset(out_columns, 0, sizeof(out_columns));
-
-		for (int xx = 0; xx < 8; xx++) { // for each column (x-direction)
-
-			uint32_t in_bitmask = 0b1;
-			uint32_t out_bitmask = 0b111;
-
-			for (int yy = 0; yy < 8; yy++) { // for pixel (y-direction)
-				if (in_columns[xx] & in_bitmask) {
-					out_columns[xx].u32 |= out_bitmask;
-				}
-				in_bitmask <<= 1;
-				out_bitmask <<= 3;
-			}
-		}
+		uint8_t const * const in_columns = font8x8_basic_tr[(uint8_t)text[nn] & 0x7F];
 
-		// render character in 8 column high pieces, making them 3x as wide
-		for (int yy = 0; yy < 3; yy++)	{ // for each group of 8 pixels high (y-direction)
+		// render character in 8 column high pieces, making them 3x as high and 3x as wide
+		for (int yy = 0; yy < _pages; yy++)	{ // for each group of 8 pixels high (y-direction)
 
-			uint8_t image[24];
+			uint8_t * image = &dev->_page[page+yy]._segs[seg];
 			for (int xx = 0; xx < 8; xx++) { // for each column (x-direction)
 				image[xx*3+0] = 
 				image[xx*3+1] = 
-				image[xx*3+2] = out_columns[xx].u8[yy];
+				image[xx*3+2] = ssd1306_x3_table[in_columns[xx]][yy];
 			}
 			if (invert) ssd1306_invert(image, 24);
 			if (dev->_flip) ssd1306_flip(image, 24);
-			if (dev->_address == SPI_ADDRESS) {
-				spi_display_image(dev, page+yy, seg, image, 24);
-			} else {
-				i2c_display_image(dev, page+yy, seg, image, 24);
-			}
-			memcpy(&dev->_page[page+yy]._segs[seg], image, 24);
 		}
 		seg = seg + 24;
 	}
+	_ssd1306_send_rect(dev, page, page + _pages - 1, 0, seg);
 }
 
 void ssd1306_clear_screen(SSD1306_t * dev, bool invert)
 {
 	char space[16];
 	memset(space, 0x00, sizeof(space));
-	for (int page = 0; page < dev->_pages; page++) {
+	for (int page = 0; page < SSD1306_DEV_PAGES(dev); page++) {
 		ssd1306_display_text(dev, page, space, sizeof(space), invert);
 	}
 }
@@ -271,19 +674,26 @@ void ssd1306_clear_line(SSD1306_t * dev, int page, bool invert)
 
 void ssd1306_contrast(SSD1306_t * dev, int contrast)
 {
-	if (dev->_address == SPI_ADDRESS) {
-		spi_contrast(dev, contrast);
-	} else {
-		i2c_contrast(dev, contrast);
-	}
+	_ssd1306_panel_take(dev);
+	dev->_transport->contrast(dev, contrast);
+	_ssd1306_panel_give(dev);
+}
+
+// Switch the panel off and on again. It keeps its RAM and configuration
+// while off and draws only a few uA.
+void ssd1306_display_on(SSD1306_t * dev, bool on)
+{
+	_ssd1306_panel_take(dev);
+	dev->_transport->display_on(dev, on);
+	_ssd1306_panel_give(dev);
 }
 
 void ssd1306_software_scroll(SSD1306_t * dev, int start, int end)
 {
-	ESP_LOGD(__FUNCTION__, "software_scroll start=%d end=%d _pages=%d", start, end, dev->_pages);
+	ESP_LOGD(__FUNCTION__, "software_scroll start=%d end=%d _pages=%d", start, end, SSD1306_DEV_PAGES(dev));
 	if (start < 0 || end < 0) {
 		dev->_scEnable = false;
-	} else if (start >= dev->_pages || end >= dev->_pages) {
+	} else if (start >= SSD1306_DEV_PAGES(dev) || end >= SSD1306_DEV_PAGES(dev)) {
 		dev->_scEnable = false;
 	} else {
 		dev->_scEnable = true;
@@ -295,34 +705,53 @@ void ssd1306_software_scroll(SSD1306_t * dev, int start, int end)
 }
 
 
-void ssd1306_scroll_text(SSD1306_t * dev, char * text, int text_len, bool invert)
+// Shift the scroll area by one page and write text into the freed page.
+// When the area is the whole of a 64 line panel, the panel is scrolled by
+// moving its display start line, so a scroll costs one command plus one
+// page. Display RAM then holds the pages rotated by _scOffset, see
+// ssd1306_ram_page. Otherwise the moved pages are sent in one transfer.
+void ssd1306_scroll_text(SSD1306_t * dev, const char * text, int text_len, bool invert)
 {
 	ESP_LOGD(__FUNCTION__, "dev->_scEnable=%d", dev->_scEnable);
 	if (dev->_scEnable == false) return;
 
-	void (*func)(SSD1306_t * dev, int page, int seg, uint8_t * images, int width);
-	if (dev->_address == SPI_ADDRESS) {
-		func = spi_display_image;
-	} else {
-		func = i2c_display_image;
-	}
+	int _first = dev->_scDirection > 0 ? dev->_scStart : dev->_scEnd;
+	int _last = dev->_scDirection > 0 ? dev->_scEnd : dev->_scStart;
+	bool hardware = SSD1306_DEV_HEIGHT(dev) == 64 && _first == 0 && _last == SSD1306_DEV_PAGES(dev) - 1;
+	// Changes not shown yet would move with their page, show them first
+	if (hardware) ssd1306_flush(dev);
 
 	int srcIndex = dev->_scEnd - dev->_scDirection;
 	while(1) {
 		int dstIndex = srcIndex + dev->_scDirection;
 		ESP_LOGD(__FUNCTION__, "srcIndex=%d dstIndex=%d", srcIndex,dstIndex);
-		for(int seg = 0; seg < dev->_width; seg++) {
-			dev->_page[dstIndex]._segs[seg] = dev->_page[srcIndex]._segs[seg];
-		}
-		(*func)(dev, dstIndex, 0, dev->_page[dstIndex]._segs, sizeof(dev->_page[dstIndex]._segs));
+		memcpy(dev->_page[dstIndex]._segs, dev->_page[srcIndex]._segs, SSD1306_DEV_WIDTH(dev));
 		if (srcIndex == dev->_scStart) break;
 		srcIndex = srcIndex - dev->_scDirection;
 	}
-	
+
 	int _text_len = text_len;
 	if (_text_len > 16) _text_len = 16;
-	
-	ssd1306_display_text(dev, srcIndex, text, text_len, invert);
+	_ssd1306_display_text(dev, srcIndex, text, _text_len, invert);
+
+	if (hardware) {
+		// Content moves down the screen when the start line moves up
+		int shift = dev->_flip ? -dev->_scDirection : dev->_scDirection;
+		_ssd1306_panel_take(dev);
+		dev->_scOffset = (dev->_scOffset - shift + SSD1306_DEV_PAGES(dev)) % SSD1306_DEV_PAGES(dev);
+		dev->_transport->start_line(dev, dev->_scOffset * 8);
+		dev->_transport->display_rect(dev, srcIndex, srcIndex, 0, SSD1306_DEV_WIDTH(dev));
+		// Every page moved, and after the flush above the panel shows the drawing buffer
+		_ssd1306_mirror(dev, 0, SSD1306_DEV_PAGES(dev)-1, 0, SSD1306_DEV_WIDTH(dev));
+		if (dev->_back != NULL) dev->_back->_scOffset = dev->_scOffset;
+		_ssd1306_panel_give(dev);
+		_ssd1306_clear_dirty(dev, srcIndex);
+	} else {
+		_ssd1306_send_rect(dev, _first, _last, 0, SSD1306_DEV_WIDTH(dev));
+		for (int page=_first; page<=_last; page++) {
+			_ssd1306_clear_dirty(dev, page);
+		}
+	}
 }
 
 void ssd1306_scroll_clear(SSD1306_t * dev)
@@ -343,11 +772,9 @@ void ssd1306_scroll_clear(SSD1306_t * dev)
 
 void ssd1306_hardware_scroll(SSD1306_t * dev, ssd1306_scroll_type_t scroll)
 {
-	if (dev->_address == SPI_ADDRESS) {
-		spi_hardware_scroll(dev, scroll);
-	} else {
-		i2c_hardware_scroll(dev, scroll);
-	}
+	_ssd1306_panel_take(dev);
+	dev->_transport->hardware_scroll(dev, scroll);
+	_ssd1306_panel_give(dev);
 }
 
 // delay = 0 : display with no wait
@@ -358,9 +785,9 @@ void ssd1306_wrap_arround(SSD1306_t * dev, ssd1306_scroll_type_t scroll, int sta
 	if (scroll == SCROLL_RIGHT) {
 		int _start = start; // 0 to 7
 		int _end = end; // 0 to 7
-		if (_end >= dev->_pages) _end = dev->_pages - 1;
+		if (_end >= SSD1306_DEV_PAGES(dev)) _end = SSD1306_DEV_PAGES(dev) - 1;
 		uint8_t wk;
-		//for (int page=0;page<dev->_pages;page++) {
+		//for (int page=0;page<SSD1306_DEV_PAGES(dev);page++) {
 		for (int page=_start;page<=_end;page++) {
 			wk = dev->_page[page]._segs[127];
 			for (int seg=127;seg>0;seg--) {
@@ -372,9 +799,9 @@ void ssd1306_wrap_arround(SSD1306_t * dev, ssd1306_scroll_type_t scroll, int sta
 	} else if (scroll == SCROLL_LEFT) {
 		int _start = start; // 0 to 7
 		int _end = end; // 0 to 7
-		if (_end >= dev->_pages) _end = dev->_pages - 1;
+		if (_end >= SSD1306_DEV_PAGES(dev)) _end = SSD1306_DEV_PAGES(dev) - 1;
 		uint8_t wk;
-		//for (int page=0;page<dev->_pages;page++) {
+		//for (int page=0;page<SSD1306_DEV_PAGES(dev);page++) {
 		for (int page=_start;page<=_end;page++) {
 			wk = dev->_page[page]._segs[0];
 			for (int seg=0;seg<127;seg++) {
@@ -386,7 +813,7 @@ void ssd1306_wrap_arround(SSD1306_t * dev, ssd1306_scroll_type_t scroll, int sta
 	} else if (scroll == SCROLL_UP) {
 		int _start = start; // 0 to {width-1}
 		int _end = end; // 0 to {width-1}
-		if (_end >= dev->_width) _end = dev->_width - 1;
+		if (_end >= SSD1306_DEV_WIDTH(dev)) _end = SSD1306_DEV_WIDTH(dev) - 1;
 		uint8_t wk0;
 		uint8_t wk1;
 		uint8_t wk2;
@@ -396,7 +823,7 @@ void ssd1306_wrap_arround(SSD1306_t * dev, ssd1306_scroll_type_t scroll, int sta
 			save[seg] = dev->_page[0]._segs[seg];
 		}
 		// Page0 to Page6
-		for (int page=0;page<dev->_pages-1;page++) {
+		for (int page=0;page<SSD1306_DEV_PAGES(dev)-1;page++) {
 			//for (int seg=0;seg<128;seg++) {
 			for (int seg=_start;seg<=_end;seg++) {
 				wk0 = dev->_page[page]._segs[seg];
@@ -418,7 +845,7 @@ void ssd1306_wrap_arround(SSD1306_t * dev, ssd1306_scroll_type_t scroll, int sta
 			}
 		}
 		// Page7
-		int pages = dev->_pages-1;
+		int pages = SSD1306_DEV_PAGES(dev)-1;
 		//for (int seg=0;seg<128;seg++) {
 		for (int seg=_start;seg<=_end;seg++) {
 			wk0 = dev->_page[pages]._segs[seg];
@@ -436,13 +863,13 @@ void ssd1306_wrap_arround(SSD1306_t * dev, ssd1306_scroll_type_t scroll, int sta
 	} else if (scroll == SCROLL_DOWN) {
 		int _start = start; // 0 to {width-1}
 		int _end = end; // 0 to {width-1}
-		if (_end >= dev->_width) _end = dev->_width - 1;
+		if (_end >= SSD1306_DEV_WIDTH(dev)) _end = SSD1306_DEV_WIDTH(dev) - 1;
 		uint8_t wk0;
 		uint8_t wk1;
 		uint8_t wk2;
 		uint8_t save[128];
 		// Save pages 7
-		int pages = dev->_pages-1;
+		int pages = SSD1306_DEV_PAGES(dev)-1;
 		for (int seg=0;seg<128;seg++) {
 			save[seg] = dev->_page[pages]._segs[seg];
 		}
@@ -487,10 +914,10 @@ void ssd1306_wrap_arround(SSD1306_t * dev, ssd1306_scroll_type_t scroll, int sta
 		uint8_t save[128];
 		// Save pages 7
 		for (int seg=0;seg<128;seg++) {
-			save[seg] = dev->_page[dev->_pages-1]._segs[seg];
+			save[seg] = dev->_page[SSD1306_DEV_PAGES(dev)-1]._segs[seg];
 		}
 		// Page7 to Page1
-		for (int page=dev->_pages-1;page>0;page--) {
+		for (int page=SSD1306_DEV_PAGES(dev)-1;page>0;page--) {
 			for (int seg=0;seg<128;seg++) {
 				dev->_page[page]._segs[seg] = dev->_page[page-1]._segs[seg];
 			}
@@ -507,94 +934,93 @@ void ssd1306_wrap_arround(SSD1306_t * dev, ssd1306_scroll_type_t scroll, int sta
 			save[seg] = dev->_page[0]._segs[seg];
 		}
 		// Page0 to Page6
-		for (int page=0;page<dev->_pages-1;page++) {
+		for (int page=0;page<SSD1306_DEV_PAGES(dev)-1;page++) {
 			for (int seg=0;seg<128;seg++) {
 				dev->_page[page]._segs[seg] = dev->_page[page+1]._segs[seg];
 			}
 		}
 		// Store  pages 7
 		for (int seg=0;seg<128;seg++) {
-			dev->_page[dev->_pages-1]._segs[seg] = save[seg];
+			dev->_page[SSD1306_DEV_PAGES(dev)-1]._segs[seg] = save[seg];
 		}
 	}
 
-	if (delay >= 0) {
-		for (int page=0;page<dev->_pages;page++) {
-			if (dev->_address == SPI_ADDRESS) {
-				spi_display_image(dev, page, 0, dev->_page[page]._segs, 128);
-			} else {
-				i2c_display_image(dev, page, 0, dev->_page[page]._segs, 128);
-			}
-			if (delay) vTaskDelay(delay);
+	if (delay == 0) {
+		ssd1306_show_buffer(dev);
+	} else if (delay > 0) {
+		for (int page=0;page<SSD1306_DEV_PAGES(dev);page++) {
+			_ssd1306_send(dev, page, 0, dev->_page[page]._segs, 128);
+			_ssd1306_clear_dirty(dev, page);
+			vTaskDelay(delay);
+		}
+	} else {
+		for (int page=0;page<SSD1306_DEV_PAGES(dev);page++) {
+			_ssd1306_set_dirty(dev, page, 0, 128);
 		}
 	}
 
 }
 
-void _ssd1306_bitmaps(SSD1306_t * dev, int xpos, int ypos, uint8_t * bitmap, int width, int height, bool invert)
+void _ssd1306_bitmaps(SSD1306_t * dev, int xpos, int ypos, const uint8_t * bitmap, int width, int height, bool invert)
 {
 	if ( (width % 8) != 0) {
 		ESP_LOGE(__FUNCTION__, "width must be a multiple of 8");
 		return;
 	}
 	int _width = width / 8;
-	uint8_t wk0;
-	uint8_t wk1;
-	uint8_t wk2;
-	uint8_t page = (ypos / 8);
-	uint8_t _seg = xpos;
-	uint8_t dstBits = (ypos % 8);
+	int page = (ypos / 8);
+	int dstBits = (ypos % 8);
 	ESP_LOGD(__FUNCTION__, "_width=%d ypos=%d page=%d dstBits=%d", _width, ypos, page, dstBits);
-	int offset = 0;
-	for(int _height=0;_height<height;_height++) {
+	if (xpos + width > 128) {
+		ESP_LOGW(__FUNCTION__, "segment is out of range");
+	}
+	if ((ypos + height - 1) / 8 >= SSD1306_DEV_PAGES(dev)) {
+		ESP_LOGW(__FUNCTION__, "page is out of range");
+	}
+	uint8_t rows[8];
+	// Each band of 8 bitmap rows becomes one byte per segment, which lands
+	// in page and, when ypos is not on a page boundary, page+1. u8[0] and
+	// u8[1] of out_column_t are those two pages on the little endian ESP32.
+	for(int _height=0;_height<height;_height+=8) {
+		int _rows = height - _height;
+		if (_rows > 8) _rows = 8;
+		out_column_t mask;
+		mask.u32 = ((1 << _rows) - 1) << dstBits;
 		for (int index=0;index<_width;index++) {
-			for (int srcBits=7; srcBits>=0; srcBits--) {
-				wk0 = dev->_page[page]._segs[_seg];
-				if (dev->_flip) wk0 = ssd1306_rotate_byte(wk0);
-
-				wk1 = bitmap[index+offset];
-				if (invert) wk1 = ~wk1;
-
-				//wk2 = ssd1306_copy_bit(bitmap[index+offset], srcBits, wk0, dstBits);
-				wk2 = ssd1306_copy_bit(wk1, srcBits, wk0, dstBits);
-				if (dev->_flip) wk2 = ssd1306_rotate_byte(wk2);
-
-				ESP_LOGD(__FUNCTION__, "index=%d offset=%d wk1=0x%x page=%d _seg=%d, wk2=%02x", index, offset, wk1, page, _seg, wk2);
-				if (_seg >= 128) {
-					ESP_LOGW(__FUNCTION__, "segment is out of range");
-					break;
-				}
-				if (page >= dev->_pages) {
-					ESP_LOGW(__FUNCTION__, "page is out of range");
-					break;
+			for (int row=0;row<8;row++) {
+				rows[row] = 0;
+				if (row >= _rows) continue;
+				rows[row] = bitmap[(_height+row)*_width+index];
+				if (invert) rows[row] = ~rows[row];
+			}
+			uint64_t columns = _ssd1306_transpose8(rows);
+			for (int bit=0;bit<8;bit++) {
+				int _seg = xpos + index*8 + bit;
+				if (_seg < 0 || _seg >= 128) continue;
+				out_column_t column;
+				column.u32 = ((columns >> ((7-bit)*8)) & 0xFF) << dstBits;
+				for (int i=0;i<2;i++) {
+					int _page = page + i;
+					if (mask.u8[i] == 0 || _page < 0 || _page >= SSD1306_DEV_PAGES(dev)) continue;
+					uint8_t wk0 = column.u8[i];
+					uint8_t wk1 = mask.u8[i];
+					if (dev->_flip) {
+						wk0 = ssd1306_rotate_byte(wk0);
+						wk1 = ssd1306_rotate_byte(wk1);
+					}
+					uint8_t * seg = &dev->_page[_page]._segs[_seg];
+					*seg = (*seg & ~wk1) | wk0;
 				}
-				dev->_page[page]._segs[_seg] = wk2;
-				_seg++;
 			}
 		}
-		vTaskDelay(1);
-		offset = offset + _width;
-		dstBits++;
-		_seg = xpos;
-		if (dstBits == 8) {
-			page++;
-			dstBits=0;
-		}
+		_ssd1306_set_dirty(dev, page, xpos, width);
+		if (dstBits + _rows > 8) _ssd1306_set_dirty(dev, page+1, xpos, width);
+		page++;
 	}
-
-#if 0
-	for (int _seg=ypos;_seg<ypos+width;_seg++) {
-		ssd1306_dump_page(dev, page-1, _seg);
-	}
-	for (int _seg=ypos;_seg<ypos+width;_seg++) {
-		ssd1306_dump_page(dev, page, _seg);
-	}
-#endif
-	//ssd1306_show_buffer(dev);
 }
 
 
-void ssd1306_bitmaps(SSD1306_t * dev, int xpos, int ypos, uint8_t * bitmap, int width, int height, bool invert)
+void ssd1306_bitmaps(SSD1306_t * dev, int xpos, int ypos, const uint8_t * bitmap, int width, int height, bool invert)
 {
 	_ssd1306_bitmaps(dev, xpos, ypos, bitmap, width, height, invert);
 	ssd1306_show_buffer(dev);
@@ -609,15 +1035,17 @@ void _ssd1306_pixel(SSD1306_t * dev, int xpos, int ypos, bool invert)
 	uint8_t _seg = xpos;
 	uint8_t wk0 = dev->_page[_page]._segs[_seg];
 	uint8_t wk1 = 1 << _bits;
+	// Pages of a flipped panel hold their rows in reverse bit order
+	if (dev->_flip) wk1 = 0x80 >> _bits;
 	ESP_LOGD(__FUNCTION__, "ypos=%d _page=%d _bits=%d wk0=0x%02x wk1=0x%02x", ypos, _page, _bits, wk0, wk1);
 	if (invert) {
 		wk0 = wk0 & ~wk1;
 	} else {
 		wk0 = wk0 | wk1;
 	}
-	if (dev->_flip) wk0 = ssd1306_rotate_byte(wk0);
 	ESP_LOGD(__FUNCTION__, "wk0=0x%02x wk1=0x%02x", wk0, wk1);
 	dev->_page[_page]._segs[_seg] = wk0;
+	_ssd1306_set_dirty(dev, _page, _seg, 1);
 }
 
 // Set line to internal buffer. Not show it.
@@ -695,7 +1123,7 @@ void _ssd1306_cursor(SSD1306_t * dev, int x0, int y0, int r, bool invert)
 void ssd1306_invert(uint8_t *buf, size_t blen)
 {
 	uint8_t wk;
-	for(int i=0; i<blen; i++){
+	for(size_t i=0; i<blen; i++){
 		wk = buf[i];
 		buf[i] = ~wk;
 	}
@@ -704,8 +1132,8 @@ void ssd1306_invert(uint8_t *buf, size_t blen)
 // Flip upside down
 void ssd1306_flip(uint8_t *buf, size_t blen)
 {
-	for(int i=0; i<blen; i++){
-		buf[i] = ssd1306_rotate_byte(buf[i]);
+	for(size_t i=0; i<blen; i++){
+		buf[i] = ssd1306_reverse_table[buf[i]];
 	}
 }
 
@@ -733,79 +1161,133 @@ uint8_t ssd1306_copy_bit(uint8_t src, int srcBits, uint8_t dst, int dstBits)
 // Rotate 8-bit data
 // 0x12-->0x48
 uint8_t ssd1306_rotate_byte(uint8_t ch1) {
-	uint8_t ch2 = 0;
-	for (int j=0;j<8;j++) {
-		ch2 = (ch2 << 1) + (ch1 & 0x01);
-		ch1 = ch1 >> 1;
-	}
-	return ch2;
+	return ssd1306_reverse_table[ch1];
 }
 
 
+// Frame of the fade out: page frame/8 is lit except for its first frame%8+1 rows
+static void _ssd1306_fadeout_frame(SSD1306_t * dev, int frame)
+{
+	int page = frame / 8;
+	int line = frame % 8;
+	uint8_t image = 0xFF << (line + 1);
+	if (dev->_flip) image = 0xFF >> (line + 1);
+	memset(dev->_page[page]._segs, image, 128);
+	_ssd1306_set_dirty(dev, page, 0, 128);
+}
+
 void ssd1306_fadeout(SSD1306_t * dev)
 {
-	void (*func)(SSD1306_t * dev, int page, int seg, uint8_t * images, int width);
-	if (dev->_address == SPI_ADDRESS) {
-		func = spi_display_image;
-	} else {
-		func = i2c_display_image;
+	for (int frame=0; frame<SSD1306_DEV_PAGES(dev)*8; frame++) {
+		_ssd1306_fadeout_frame(dev, frame);
+		ssd1306_flush(dev);
 	}
+}
 
-	uint8_t image[1];
-	for(int page=0; page<dev->_pages; page++) {
-		image[0] = 0xFF;
-		for(int line=0; line<8; line++) {
-			if (dev->_flip) {
-				image[0] = image[0] >> 1;
-			} else {
-				image[0] = image[0] << 1;
-			}
-			for(int seg=0; seg<128; seg++) {
-				(*func)(dev, page, seg, image, 1);
-				dev->_page[page]._segs[seg] = image[0];
-			}
+// Advance every effect of dev by one frame, drawing into target, and send
+// the result in one flush. Returns true while effects are left.
+static bool _ssd1306_animation_frame(SSD1306_t * dev, SSD1306_t * target)
+{
+	bool running = false;
+	for (int i=0;i<SSD1306_ANIMATIONS;i++) {
+		ANIMATION_t * anim = &dev->_anim[i];
+		if (anim->_type == ANIMATION_NONE) continue;
+		anim->_frame++;
+		if (anim->_type == ANIMATION_CONTRAST) {
+			int contrast = anim->_from + (anim->_to - anim->_from) * anim->_frame / anim->_frames;
+			target->_transport->contrast(target, contrast);
+		} else if (anim->_type == ANIMATION_FADEOUT) {
+			_ssd1306_fadeout_frame(target, anim->_frame - 1);
+		} else if (anim->_type == ANIMATION_WRAP) {
+			ssd1306_wrap_arround(target, anim->_scroll, anim->_start, anim->_end, -1);
+		}
+		if (anim->_frame < anim->_frames) {
+			running = true;
+		} else {
+			anim->_type = ANIMATION_NONE;
 		}
 	}
+	ssd1306_flush(target);
+	return running;
 }
 
-// Rotate character image
-// Only valid for 8 dots x 8 dots
-void ssd1306_rotate_image(uint8_t *image, bool flip) {
-	uint8_t _image[8];
-	uint8_t _smask = 0x01;
-	for (int i=0;i<8;i++) {
-		uint8_t _dmask = 0x80;
-		_image[i] = 0;
-		for (int j=0;j<8;j++) {
-			uint8_t _wk = image[j] & _smask;
-			ESP_LOGD(__FUNCTION__, "image[%d]=0x%x _smask=0x%x _wk=0x%x", j, image[j], _smask, _wk);
-			if (_wk != 0) {
-				_image[i] = _image[i] + _dmask;
-			}
-			_dmask = _dmask >> 1;
-		}
-		_smask = _smask << 1;
+// Effects run in the display task, one frame every SSD1306_ANIMATION_PERIOD_MS,
+// and the functions below return at once. They animate the frame on the panel,
+// the drawing buffer is left alone, so draw only outside the animated area until
+// ssd1306_animation_wait returns. Without a display task an effect runs to
+// completion on the drawing buffer before the function returns.
+static bool _ssd1306_animation_start(SSD1306_t * dev, ANIMATION_t * anim)
+{
+	if (dev->_task != NULL) return _ssd1306_animation_queue(dev, anim);
+	dev->_anim[0] = *anim;
+	while (_ssd1306_animation_frame(dev, dev)) {
+		vTaskDelay(pdMS_TO_TICKS(SSD1306_ANIMATION_PERIOD_MS));
 	}
+	return true;
+}
 
-	for (int i=0;i<8;i++) {
-		image[i] = _image[i];
+// Ramp the contrast from from to to in frames steps
+bool ssd1306_animate_contrast(SSD1306_t * dev, int from, int to, int frames)
+{
+	if (frames < 1) {
+		ESP_LOGE(__FUNCTION__, "frames must be at least 1");
+		return false;
 	}
-	if (flip) ssd1306_flip(image, 8);
-#if 0
+	ANIMATION_t anim = {
+		._type = ANIMATION_CONTRAST,
+		._frames = frames,
+		._from = from,
+		._to = to,
+	};
+	return _ssd1306_animation_start(dev, &anim);
+}
+
+// ssd1306_fadeout, one row per frame
+bool ssd1306_animate_fadeout(SSD1306_t * dev)
+{
+	ANIMATION_t anim = {
+		._type = ANIMATION_FADEOUT,
+		._frames = SSD1306_DEV_PAGES(dev) * 8,
+	};
+	return _ssd1306_animation_start(dev, &anim);
+}
+
+// ssd1306_wrap_arround, one step per frame for frames steps
+bool ssd1306_animate_wrap(SSD1306_t * dev, ssd1306_scroll_type_t scroll, int start, int end, int frames)
+{
+	if (frames < 1) {
+		ESP_LOGE(__FUNCTION__, "frames must be at least 1");
+		return false;
+	}
+	ANIMATION_t anim = {
+		._type = ANIMATION_WRAP,
+		._frames = frames,
+		._scroll = scroll,
+		._start = start,
+		._end = end,
+	};
+	return _ssd1306_animation_start(dev, &anim);
+}
+
+// Rotate character image
+// Only valid for 8 dots x 8 dots
+void ssd1306_rotate_image(uint8_t *image, bool flip) {
+	uint64_t columns = _ssd1306_transpose8(image);
 	for (int i=0;i<8;i++) {
-		ESP_LOGI(__FUNCTION__, "image[%d]=0x%x", i, image[i]);
+		image[i] = (columns >> (i*8)) & 0xFF;
+		// Column i has its top row in bit 0, the rotated image wants it in bit 7
+		if (!flip) image[i] = ssd1306_rotate_byte(image[i]);
 	}
-#endif
 }
 
-void ssd1306_display_rotate_text(SSD1306_t * dev, int seg, char * text, int text_len, bool invert) {
+void ssd1306_display_rotate_text(SSD1306_t * dev, int seg, const char * text, int text_len, bool invert) {
 	int _text_len = text_len;
 	if (_text_len > 8) _text_len = 8;
 	uint8_t image[8];
-	int _page = dev->_pages-1;
+	int _page = SSD1306_DEV_PAGES(dev)-1;
 	for (uint8_t i = 0; i < _text_len; i++) {
-		memcpy(image, font8x8_basic_tr[(uint8_t)text[i]], 8);
-		ssd1306_rotate_image(image, dev->_flip);
+		memcpy(image, font8x8_basic_rot[(uint8_t)text[i] & 0x7F], 8);
+		if (dev->_flip) ssd1306_flip(image, 8);
 		ESP_LOGD(__FUNCTION__, "_page=%d seg=%d", _page, seg);
 		if (invert) ssd1306_invert(image, 8);
 		ssd1306_display_image(dev, _page, seg, image, 8);
@@ -814,6 +1296,16 @@ void ssd1306_display_rotate_text(SSD1306_t * dev, int seg, char * text, int text
 	}
 }
 
+// Page of display RAM that holds page of the internal buffer
+int ssd1306_ram_page(SSD1306_t * dev, int page)
+{
+	int _page = page;
+	if (dev->_flip) {
+		_page = (SSD1306_DEV_PAGES(dev) - page) - 1;
+	}
+	return (_page + dev->_scOffset) % SSD1306_DEV_PAGES(dev);
+}
+
 void ssd1306_dump(SSD1306_t dev)
 {
 	printf("_address=%x\n",dev._address);
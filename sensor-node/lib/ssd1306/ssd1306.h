@@ -1,8 +1,16 @@
 #ifndef MAIN_SSD1306_H_
 #define MAIN_SSD1306_H_
 
+#ifdef SSD1306_HOST
+#include "ssd1306_host.h"
+#else
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
 #include "driver/spi_master.h"
 #include "driver/i2c_master.h"
+#endif
 /*#if (ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 2, 0))
 #include "driver/i2c_master.h"
 #else
@@ -77,6 +85,10 @@ Usage:
 #define I2C_ADDRESS 0x3C
 #define SPI_ADDRESS 0xFF
 
+// Persistent transfer buffer: room for the addressing commands plus a full frame
+#define SSD1306_TRANSFER_HEADER 16
+#define SSD1306_TRANSFER_SIZE (SSD1306_TRANSFER_HEADER + 8 * 128)
+
 typedef enum {
 	SCROLL_RIGHT = 1,
 	SCROLL_LEFT = 2,
@@ -87,13 +99,69 @@ typedef enum {
 	SCROLL_STOP = 7
 } ssd1306_scroll_type_t;
 
+// Build with -DSSD1306_FIXED_HEIGHT=64 or =32 to fix the panel geometry at
+// compile time. The internal buffer then holds exactly the pages of that panel,
+// the driver reads width, height and pages as constants so page loops have
+// fixed bounds, and ssd1306_init accepts no other geometry.
+#ifdef SSD1306_FIXED_HEIGHT
+#if (SSD1306_FIXED_HEIGHT != 64) && (SSD1306_FIXED_HEIGHT != 32)
+#error "SSD1306_FIXED_HEIGHT must be 64 or 32"
+#endif
+#define SSD1306_PAGES (SSD1306_FIXED_HEIGHT / 8)
+#define SSD1306_DEV_WIDTH(dev) 128
+#define SSD1306_DEV_HEIGHT(dev) SSD1306_FIXED_HEIGHT
+#define SSD1306_DEV_PAGES(dev) SSD1306_PAGES
+#else
+#define SSD1306_PAGES 8
+#define SSD1306_DEV_WIDTH(dev) ((dev)->_width)
+#define SSD1306_DEV_HEIGHT(dev) ((dev)->_height)
+#define SSD1306_DEV_PAGES(dev) ((dev)->_pages)
+#endif
+
 typedef struct {
-	bool _valid; // Not using it anymore
-	int _segLen; // Not using it anymore
+	int _dirtyStart; // First segment changed since the last flush, -1 if the page is clean
+	int _dirtyEnd; // Last segment changed since the last flush
 	uint8_t _segs[128];
 } PAGE_t;
 
+#define SSD1306_ANIMATIONS 4 // Effects that can run at the same time
+#define SSD1306_ANIMATION_PERIOD_MS 40 // Time between two animation frames
+
+typedef enum {
+	ANIMATION_NONE = 0,
+	ANIMATION_CONTRAST,
+	ANIMATION_FADEOUT,
+	ANIMATION_WRAP,
+} ssd1306_animation_type_t;
+
+// Effect of the animation engine, advanced by one step per animation frame
 typedef struct {
+	ssd1306_animation_type_t _type;
+	int _frame; // Frames shown so far
+	int _frames; // Frames until the effect ends
+	int _from; // Contrast of ANIMATION_CONTRAST before the first frame
+	int _to; // Contrast of ANIMATION_CONTRAST at the last frame
+	ssd1306_scroll_type_t _scroll; // Direction of ANIMATION_WRAP
+	int _start; // Range of ANIMATION_WRAP, as for ssd1306_wrap_arround
+	int _end;
+} ANIMATION_t;
+
+struct SSD1306_s;
+
+// Bus specific part of the driver, selected by i2c_master_init, spi_master_init or memory_init
+typedef struct {
+	void (*init)(struct SSD1306_s * dev, int width, int height);
+	void (*display_image)(struct SSD1306_s * dev, int page, int seg, uint8_t * images, int width);
+	void (*display_rect)(struct SSD1306_s * dev, int page_start, int page_end, int seg, int width);
+	void (*contrast)(struct SSD1306_s * dev, int contrast);
+	void (*display_on)(struct SSD1306_s * dev, bool on);
+	void (*start_line)(struct SSD1306_s * dev, int line);
+	void (*hardware_scroll)(struct SSD1306_s * dev, ssd1306_scroll_type_t scroll);
+} ssd1306_transport_t;
+
+typedef struct SSD1306_s {
+	const ssd1306_transport_t * _transport;
+	void * _transport_data; // Backend state of the memory transport
 	int _address;
 	int _width;
 	int _height;
@@ -103,14 +171,23 @@ typedef struct {
 	int _scStart;
 	int _scEnd;
 	int _scDirection;
-	PAGE_t _page[8];
+	int _scOffset; // Pages the display start line was moved by ssd1306_scroll_text
+	PAGE_t _page[SSD1306_PAGES];
 	bool _flip;
+	uint8_t * _out_buf; // DMA capable, SSD1306_TRANSFER_SIZE bytes, allocated by the first ssd1306_init or ssd1306_resume
+	TaskHandle_t _task; // Display task started by ssd1306_async_init, NULL if flushes are synchronous
+	SemaphoreHandle_t _idle; // Given while the display task is not sending _back
+	struct SSD1306_s * _back; // Frame the display task is sending, kept equal to the panel outside its dirty spans
+	ANIMATION_t _anim[SSD1306_ANIMATIONS]; // Running effects, _type is ANIMATION_NONE for free slots
+	esp_timer_handle_t _timer; // Animation frame timer of the display task
+#ifndef SSD1306_HOST
 	i2c_port_t _i2c_num;
 	spi_device_handle_t _spi_device_handle;
 #if (ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 2, 0))
 	i2c_master_bus_handle_t _i2c_bus_handle;
 	i2c_master_dev_handle_t _i2c_dev_handle;
 #endif
+#endif
 } SSD1306_t;
 
 #ifdef __cplusplus
@@ -119,29 +196,36 @@ extern "C"
 #endif
 
 void ssd1306_init(SSD1306_t * dev, int width, int height);
+void ssd1306_resume(SSD1306_t * dev, int width, int height);
 int ssd1306_get_width(SSD1306_t * dev);
 int ssd1306_get_height(SSD1306_t * dev);
 int ssd1306_get_pages(SSD1306_t * dev);
 void ssd1306_show_buffer(SSD1306_t * dev);
+void ssd1306_flush(SSD1306_t * dev);
+bool ssd1306_async_init(SSD1306_t * dev, UBaseType_t priority);
+void ssd1306_flush_async(SSD1306_t * dev);
+bool ssd1306_flush_wait(SSD1306_t * dev, TickType_t ticks_to_wait);
 void ssd1306_set_buffer(SSD1306_t * dev, uint8_t * buffer);
 void ssd1306_get_buffer(SSD1306_t * dev, uint8_t * buffer);
 void ssd1306_set_page(SSD1306_t * dev, int page, uint8_t * buffer);
 void ssd1306_get_page(SSD1306_t * dev, int page, uint8_t * buffer);
 void ssd1306_display_image(SSD1306_t * dev, int page, int seg, uint8_t * images, int width);
-void ssd1306_display_text(SSD1306_t * dev, int page, char * text, int text_len, bool invert);
-void ssd1306_display_text_box1(SSD1306_t * dev, int page, int seg, char * text, int box_width, int text_len, bool invert, int delay);
-void ssd1306_display_text_box2(SSD1306_t * dev, int page, int seg, char * text, int box_width, int text_len, bool invert, int delay);
-void ssd1306_display_text_x3(SSD1306_t * dev, int page, char * text, int text_len, bool invert);
+void _ssd1306_display_text(SSD1306_t * dev, int page, const char * text, int text_len, bool invert);
+void ssd1306_display_text(SSD1306_t * dev, int page, const char * text, int text_len, bool invert);
+void ssd1306_display_text_box1(SSD1306_t * dev, int page, int seg, const char * text, int box_width, int text_len, bool invert, int delay);
+void ssd1306_display_text_box2(SSD1306_t * dev, int page, int seg, const char * text, int box_width, int text_len, bool invert, int delay);
+void ssd1306_display_text_x3(SSD1306_t * dev, int page, const char * text, int text_len, bool invert);
 void ssd1306_clear_screen(SSD1306_t * dev, bool invert);
 void ssd1306_clear_line(SSD1306_t * dev, int page, bool invert);
 void ssd1306_contrast(SSD1306_t * dev, int contrast);
+void ssd1306_display_on(SSD1306_t * dev, bool on);
 void ssd1306_software_scroll(SSD1306_t * dev, int start, int end);
-void ssd1306_scroll_text(SSD1306_t * dev, char * text, int text_len, bool invert);
+void ssd1306_scroll_text(SSD1306_t * dev, const char * text, int text_len, bool invert);
 void ssd1306_scroll_clear(SSD1306_t * dev);
 void ssd1306_hardware_scroll(SSD1306_t * dev, ssd1306_scroll_type_t scroll);
 void ssd1306_wrap_arround(SSD1306_t * dev, ssd1306_scroll_type_t scroll, int start, int end, int8_t delay);
-void _ssd1306_bitmaps(SSD1306_t * dev, int xpos, int ypos, uint8_t * bitmap, int width, int height, bool invert);
-void ssd1306_bitmaps(SSD1306_t * dev, int xpos, int ypos, uint8_t * bitmap, int width, int height, bool invert);
+void _ssd1306_bitmaps(SSD1306_t * dev, int xpos, int ypos, const uint8_t * bitmap, int width, int height, bool invert);
+void ssd1306_bitmaps(SSD1306_t * dev, int xpos, int ypos, const uint8_t * bitmap, int width, int height, bool invert);
 void _ssd1306_pixel(SSD1306_t * dev, int xpos, int ypos, bool invert);
 void _ssd1306_line(SSD1306_t * dev, int x1, int y1, int x2, int y2,  bool invert);
 void _ssd1306_circle(SSD1306_t * dev, int x0, int y0, int r, bool invert);
@@ -151,16 +235,34 @@ void ssd1306_flip(uint8_t *buf, size_t blen);
 uint8_t ssd1306_copy_bit(uint8_t src, int srcBits, uint8_t dst, int dstBits);
 uint8_t ssd1306_rotate_byte(uint8_t ch1);
 void ssd1306_fadeout(SSD1306_t * dev);
+bool ssd1306_animate_contrast(SSD1306_t * dev, int from, int to, int frames);
+bool ssd1306_animate_fadeout(SSD1306_t * dev);
+bool ssd1306_animate_wrap(SSD1306_t * dev, ssd1306_scroll_type_t scroll, int start, int end, int frames);
+bool ssd1306_animation_wait(SSD1306_t * dev, TickType_t ticks_to_wait);
 void ssd1306_rotate_image(uint8_t *image, bool flip);
-void ssd1306_display_rotate_text(SSD1306_t * dev, int seg, char * text, int text_len, bool invert);
+void ssd1306_display_rotate_text(SSD1306_t * dev, int seg, const char * text, int text_len, bool invert);
+int ssd1306_ram_page(SSD1306_t * dev, int page);
 void ssd1306_dump(SSD1306_t dev);
 void ssd1306_dump_page(SSD1306_t * dev, int page, int seg);
 
+void memory_init(SSD1306_t * dev);
+void memory_reset_stats(SSD1306_t * dev);
+void memory_get_stats(SSD1306_t * dev, uint32_t * transfers, uint32_t * bytes);
+uint8_t memory_get_pixel(SSD1306_t * dev, int xpos, int ypos);
+bool memory_dump_pbm(SSD1306_t * dev, const char * path);
+
+#ifndef SSD1306_HOST
+extern const ssd1306_transport_t ssd1306_i2c_transport;
+extern const ssd1306_transport_t ssd1306_spi_transport;
+
 void i2c_master_init(SSD1306_t * dev, int16_t sda, int16_t scl, int16_t reset);
 void i2c_device_add(SSD1306_t * dev, i2c_port_t i2c_num, int16_t reset, uint16_t i2c_address);
 void i2c_init(SSD1306_t * dev, int width, int height);
 void i2c_display_image(SSD1306_t * dev, int page, int seg, uint8_t * images, int width);
+void i2c_display_rect(SSD1306_t * dev, int page_start, int page_end, int seg, int width);
+void i2c_start_line(SSD1306_t * dev, int line);
 void i2c_contrast(SSD1306_t * dev, int contrast);
+void i2c_display_on(SSD1306_t * dev, bool on);
 void i2c_hardware_scroll(SSD1306_t * dev, ssd1306_scroll_type_t scroll);
 
 void spi_clock_speed(int speed);
@@ -168,11 +270,16 @@ void spi_master_init(SSD1306_t * dev, int16_t mosi, int16_t sclk, int16_t cs, in
 void spi_device_add(SSD1306_t * dev, int16_t cs, int16_t dc, int16_t reset);
 bool spi_master_write_byte(spi_device_handle_t SPIHandle, const uint8_t* Data, size_t DataLength );
 bool spi_master_write_command(SSD1306_t * dev, uint8_t Command );
+bool spi_master_write_commands(SSD1306_t * dev, const uint8_t* Commands, size_t CommandsLength );
 bool spi_master_write_data(SSD1306_t * dev, const uint8_t* Data, size_t DataLength );
 void spi_init(SSD1306_t * dev, int width, int height);
 void spi_display_image(SSD1306_t * dev, int page, int seg, uint8_t * images, int width);
+void spi_display_rect(SSD1306_t * dev, int page_start, int page_end, int seg, int width);
+void spi_start_line(SSD1306_t * dev, int line);
 void spi_contrast(SSD1306_t * dev, int contrast);
+void spi_display_on(SSD1306_t * dev, bool on);
 void spi_hardware_scroll(SSD1306_t * dev, ssd1306_scroll_type_t scroll);
+#endif
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,49 @@
+#ifndef MAIN_SSD1306_HOST_H_
+#define MAIN_SSD1306_HOST_H_
+
+// Stand-ins for the ESP-IDF and FreeRTOS parts the drawing code uses, so
+// ssd1306.c and ssd1306_memory.c can be built on a PC with -DSSD1306_HOST.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef void * TaskHandle_t;
+typedef void * SemaphoreHandle_t;
+typedef uint32_t TickType_t;
+typedef unsigned int UBaseType_t;
+typedef void * esp_timer_handle_t;
+
+typedef enum {
+	ESP_LOG_NONE,
+	ESP_LOG_ERROR,
+	ESP_LOG_WARN,
+	ESP_LOG_INFO,
+	ESP_LOG_DEBUG,
+	ESP_LOG_VERBOSE,
+} esp_log_level_t;
+
+// One level for all tags, defined in ssd1306_memory.c. Tests that draw out of
+// range on purpose lower it so their output stays readable.
+extern esp_log_level_t ssd1306_host_log_level;
+#define esp_log_level_set(tag, level) ((void)(tag), ssd1306_host_log_level = (level))
+
+#define ESP_LOGE(tag, format, ...) do { \
+	if (ssd1306_host_log_level >= ESP_LOG_ERROR) fprintf(stderr, "E %s: " format "\n", tag, ##__VA_ARGS__); \
+} while (0)
+#define ESP_LOGW(tag, format, ...) do { \
+	if (ssd1306_host_log_level >= ESP_LOG_WARN) fprintf(stderr, "W %s: " format "\n", tag, ##__VA_ARGS__); \
+} while (0)
+#define ESP_LOGI(tag, format, ...) do { } while (0)
+#define ESP_LOGD(tag, format, ...) do { } while (0)
+
+#define vTaskDelay(ticks) ((void)(ticks))
+#define pdMS_TO_TICKS(ms) (ms)
+
+#define MALLOC_CAP_DMA 0
+#define MALLOC_CAP_8BIT 0
+#define heap_caps_malloc(size, caps) malloc(size)
+#define heap_caps_free(ptr) free(ptr)
+
+#endif /* MAIN_SSD1306_HOST_H_ */
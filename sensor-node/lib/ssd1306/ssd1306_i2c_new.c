@@ -1,3 +1,5 @@
+// The bus transports need ESP-IDF, host builds only have the memory transport
+#ifndef SSD1306_HOST
 #include <string.h>
 
 #include "freertos/FreeRTOS.h"
@@ -52,8 +54,10 @@ void i2c_master_init(SSD1306_t * dev, int16_t sda, int16_t scl, int16_t reset)
 		gpio_set_level(reset, 1);
 	}
 
+	dev->_transport = &ssd1306_i2c_transport;
 	dev->_address = I2C_ADDRESS;
 	dev->_flip = false;
+	dev->_out_buf = NULL;
 	dev->_i2c_num = I2C_NUM;
 	dev->_i2c_bus_handle = i2c_bus_handle;
 	dev->_i2c_dev_handle = i2c_dev_handle;
@@ -93,8 +97,10 @@ void i2c_device_add(SSD1306_t * dev, i2c_port_t i2c_num, int16_t reset, uint16_t
 		gpio_set_level(reset, 1);
 	}
 
+	dev->_transport = &ssd1306_i2c_transport;
 	dev->_address = i2c_address;
 	dev->_flip = false;
+	dev->_out_buf = NULL;
 	dev->_i2c_num = i2c_num;
 	dev->_i2c_dev_handle = i2c_dev_handle;
 }
@@ -110,8 +116,8 @@ void i2c_init(SSD1306_t * dev, int width, int height) {
 	out_buf[out_index++] = OLED_CONTROL_BYTE_CMD_STREAM;
 	out_buf[out_index++] = OLED_CMD_DISPLAY_OFF;				// AE
 	out_buf[out_index++] = OLED_CMD_SET_MUX_RATIO;			 // A8
-	if (dev->_height == 64) out_buf[out_index++] = 0x3F;
-	if (dev->_height == 32) out_buf[out_index++] = 0x1F;
+	if (SSD1306_DEV_HEIGHT(dev) == 64) out_buf[out_index++] = 0x3F;
+	if (SSD1306_DEV_HEIGHT(dev) == 32) out_buf[out_index++] = 0x1F;
 	out_buf[out_index++] = OLED_CMD_SET_DISPLAY_OFFSET;		 // D3
 	out_buf[out_index++] = 0x00;
 	//out_buf[out_index++] = OLED_CONTROL_BYTE_DATA_STREAM;	// 40
@@ -126,20 +132,15 @@ void i2c_init(SSD1306_t * dev, int width, int height) {
 	out_buf[out_index++] = OLED_CMD_SET_DISPLAY_CLK_DIV;		// D5
 	out_buf[out_index++] = 0x80;
 	out_buf[out_index++] = OLED_CMD_SET_COM_PIN_MAP;			// DA
-	if (dev->_height == 64) out_buf[out_index++] = 0x12;
-	if (dev->_height == 32) out_buf[out_index++] = 0x02;
+	if (SSD1306_DEV_HEIGHT(dev) == 64) out_buf[out_index++] = 0x12;
+	if (SSD1306_DEV_HEIGHT(dev) == 32) out_buf[out_index++] = 0x02;
 	out_buf[out_index++] = OLED_CMD_SET_CONTRAST;			// 81
 	out_buf[out_index++] = 0xFF;
 	out_buf[out_index++] = OLED_CMD_DISPLAY_RAM;				// A4
 	out_buf[out_index++] = OLED_CMD_SET_VCOMH_DESELCT;		// DB
 	out_buf[out_index++] = 0x40;
 	out_buf[out_index++] = OLED_CMD_SET_MEMORY_ADDR_MODE;	// 20
-	//out_buf[out_index++] = OLED_CMD_SET_HORI_ADDR_MODE;	// 00
-	out_buf[out_index++] = OLED_CMD_SET_PAGE_ADDR_MODE;		// 02
-	// Set Lower Column Start Address for Page Addressing Mode
-	out_buf[out_index++] = 0x00;
-	// Set Higher Column Start Address for Page Addressing Mode
-	out_buf[out_index++] = 0x10;
+	out_buf[out_index++] = OLED_CMD_SET_HORI_ADDR_MODE;		// 00
 	out_buf[out_index++] = OLED_CMD_SET_CHARGE_PUMP;			// 8D
 	out_buf[out_index++] = 0x14;
 	out_buf[out_index++] = OLED_CMD_DEACTIVE_SCROLL;			// 2E
@@ -156,46 +157,88 @@ void i2c_init(SSD1306_t * dev, int width, int height) {
 }
 
 
+// Write the column and page range commands, each behind a single command
+// control byte (Co = 1), and the data stream control byte that starts the
+// data of the same transaction. Returns the number of bytes written.
+static int i2c_set_range(uint8_t * out_buf, int page_start, int page_end, int seg, int width)
+{
+	int out_index = 0;
+	out_buf[out_index++] = OLED_CONTROL_BYTE_CMD_SINGLE;
+	out_buf[out_index++] = OLED_CMD_SET_COLUMN_RANGE;		// 21
+	out_buf[out_index++] = OLED_CONTROL_BYTE_CMD_SINGLE;
+	out_buf[out_index++] = seg + CONFIG_OFFSETX;
+	out_buf[out_index++] = OLED_CONTROL_BYTE_CMD_SINGLE;
+	out_buf[out_index++] = seg + CONFIG_OFFSETX + width - 1;
+	out_buf[out_index++] = OLED_CONTROL_BYTE_CMD_SINGLE;
+	out_buf[out_index++] = OLED_CMD_SET_PAGE_RANGE;			// 22
+	out_buf[out_index++] = OLED_CONTROL_BYTE_CMD_SINGLE;
+	out_buf[out_index++] = page_start;
+	out_buf[out_index++] = OLED_CONTROL_BYTE_CMD_SINGLE;
+	out_buf[out_index++] = page_end;
+	out_buf[out_index++] = OLED_CONTROL_BYTE_DATA_STREAM;
+	return out_index;
+}
+
+static void i2c_transmit(SSD1306_t * dev, int length)
+{
+	esp_err_t res = i2c_master_transmit(dev->_i2c_dev_handle, dev->_out_buf, length, I2C_TICKS_TO_WAIT);
+	if (res != ESP_OK)
+		ESP_LOGE(TAG, "Could not write to device [0x%02x at %d]: %d (%s)", dev->_address, dev->_i2c_num, res, esp_err_to_name(res));
+}
+
 void i2c_display_image(SSD1306_t * dev, int page, int seg, uint8_t * images, int width) {
-	if (page >= dev->_pages) return;
-	if (seg >= dev->_width) return;
+	if (page >= SSD1306_DEV_PAGES(dev)) return;
+	if (seg >= SSD1306_DEV_WIDTH(dev)) return;
+	if (seg + width > SSD1306_DEV_WIDTH(dev)) width = SSD1306_DEV_WIDTH(dev) - seg;
 
-	int _seg = seg + CONFIG_OFFSETX;
-	uint8_t columLow = _seg & 0x0F;
-	uint8_t columHigh = (_seg >> 4) & 0x0F;
+	int _page = ssd1306_ram_page(dev, page);
 
-	int _page = page;
-	if (dev->_flip) {
-		_page = (dev->_pages - page) - 1;
-	}
+	int out_index = i2c_set_range(dev->_out_buf, _page, _page, seg, width);
+	memcpy(&dev->_out_buf[out_index], images, width);
+	i2c_transmit(dev, out_index + width);
+}
 
-	uint8_t *out_buf;
-	out_buf = malloc(width < 4 ? 4 : width + 1);
-	if (out_buf == NULL) {
-		ESP_LOGE(TAG, "malloc fail");
-		return;
+// Send segments seg to seg+width-1 of pages page_start to page_end from the
+// internal buffer in one transaction. The controller wraps to the next page
+// at the end of the column range (horizontal addressing mode).
+void i2c_display_rect(SSD1306_t * dev, int page_start, int page_end, int seg, int width) {
+	if (page_start > page_end || page_end >= SSD1306_DEV_PAGES(dev)) return;
+	if (seg >= SSD1306_DEV_WIDTH(dev)) return;
+	if (seg + width > SSD1306_DEV_WIDTH(dev)) width = SSD1306_DEV_WIDTH(dev) - seg;
+
+	// After a hardware scroll the pages may wrap around in display RAM, send each run on its own
+	for (int page = page_start; page < page_end; page++) {
+		int step = ssd1306_ram_page(dev, page + 1) - ssd1306_ram_page(dev, page);
+		if (step != 1 && step != -1) {
+			i2c_display_rect(dev, page_start, page, seg, width);
+			i2c_display_rect(dev, page + 1, page_end, seg, width);
+			return;
+		}
 	}
-	int out_index = 0;
-	out_buf[out_index++] = OLED_CONTROL_BYTE_CMD_STREAM;
-	// Set Lower Column Start Address for Page Addressing Mode
-	out_buf[out_index++] = (0x00 + columLow);
-	// Set Higher Column Start Address for Page Addressing Mode
-	out_buf[out_index++] = (0x10 + columHigh);
-	// Set Page Start Address for Page Addressing Mode
-	out_buf[out_index++] = 0xB0 | _page;
 
-	esp_err_t res;
-	res = i2c_master_transmit(dev->_i2c_dev_handle, out_buf, out_index, I2C_TICKS_TO_WAIT);
-	if (res != ESP_OK)
-		ESP_LOGE(TAG, "Could not write to device [0x%02x at %d]: %d (%s)", dev->_address, dev->_i2c_num, res, esp_err_to_name(res));
+	int _page_start = ssd1306_ram_page(dev, page_start);
+	int _page_end = ssd1306_ram_page(dev, page_end);
+	if (dev->_flip) {
+		_page_start = ssd1306_ram_page(dev, page_end);
+		_page_end = ssd1306_ram_page(dev, page_start);
+	}
 
-	out_buf[0] = OLED_CONTROL_BYTE_DATA_STREAM;
-	memcpy(&out_buf[1], images, width);
+	int out_index = i2c_set_range(dev->_out_buf, _page_start, _page_end, seg, width);
+	for (int _page = _page_start; _page <= _page_end; _page++) {
+		int page = dev->_flip ? page_end - (_page - _page_start) : page_start + (_page - _page_start);
+		memcpy(&dev->_out_buf[out_index], &dev->_page[page]._segs[seg], width);
+		out_index = out_index + width;
+	}
+	i2c_transmit(dev, out_index);
+}
 
-	res = i2c_master_transmit(dev->_i2c_dev_handle, out_buf, width + 1, I2C_TICKS_TO_WAIT);
+void i2c_start_line(SSD1306_t * dev, int line) {
+	uint8_t out_buf[2];
+	out_buf[0] = OLED_CONTROL_BYTE_CMD_SINGLE; // 80
+	out_buf[1] = OLED_CMD_SET_DISPLAY_START_LINE | (line & 0x3F); // 40
+	esp_err_t res = i2c_master_transmit(dev->_i2c_dev_handle, out_buf, 2, I2C_TICKS_TO_WAIT);
 	if (res != ESP_OK)
 		ESP_LOGE(TAG, "Could not write to device [0x%02x at %d]: %d (%s)", dev->_address, dev->_i2c_num, res, esp_err_to_name(res));
-	free(out_buf);
 }
 
 void i2c_contrast(SSD1306_t * dev, int contrast) {
@@ -214,6 +257,17 @@ void i2c_contrast(SSD1306_t * dev, int contrast) {
 		ESP_LOGE(TAG, "Could not write to device [0x%02x at %d]: %d (%s)", dev->_address, dev->_i2c_num, res, esp_err_to_name(res));
 }
 
+void i2c_display_on(SSD1306_t * dev, bool on) {
+	uint8_t out_buf[2];
+	int out_index = 0;
+	out_buf[out_index++] = OLED_CONTROL_BYTE_CMD_SINGLE; // 80
+	out_buf[out_index++] = on ? OLED_CMD_DISPLAY_ON : OLED_CMD_DISPLAY_OFF; // AF / AE
+
+	esp_err_t res = i2c_master_transmit(dev->_i2c_dev_handle, out_buf, out_index, I2C_TICKS_TO_WAIT);
+	if (res != ESP_OK)
+		ESP_LOGE(TAG, "Could not write to device [0x%02x at %d]: %d (%s)", dev->_address, dev->_i2c_num, res, esp_err_to_name(res));
+}
+
 
 void i2c_hardware_scroll(SSD1306_t * dev, ssd1306_scroll_type_t scroll) {
 	uint8_t out_buf[11];
@@ -253,10 +307,10 @@ void i2c_hardware_scroll(SSD1306_t * dev, ssd1306_scroll_type_t scroll) {
 
 		out_buf[out_index++] = OLED_CMD_VERTICAL; // A3
 		out_buf[out_index++] = 0x00;
-		if (dev->_height == 64)
+		if (SSD1306_DEV_HEIGHT(dev) == 64)
 		//out_buf[out_index++] = 0x7F;
 		out_buf[out_index++] = 0x40;
-		if (dev->_height == 32)
+		if (SSD1306_DEV_HEIGHT(dev) == 32)
 		out_buf[out_index++] = 0x20;
 		out_buf[out_index++] = OLED_CMD_ACTIVE_SCROLL; // 2F
 	}
@@ -272,10 +326,10 @@ void i2c_hardware_scroll(SSD1306_t * dev, ssd1306_scroll_type_t scroll) {
 
 		out_buf[out_index++] = OLED_CMD_VERTICAL; // A3
 		out_buf[out_index++] = 0x00;
-		if (dev->_height == 64)
+		if (SSD1306_DEV_HEIGHT(dev) == 64)
 		//out_buf[out_index++] = 0x7F;
 		out_buf[out_index++] = 0x40;
-		if (dev->_height == 32)
+		if (SSD1306_DEV_HEIGHT(dev) == 32)
 		out_buf[out_index++] = 0x20;
 		out_buf[out_index++] = OLED_CMD_ACTIVE_SCROLL; // 2F
 	}
@@ -289,3 +343,13 @@ void i2c_hardware_scroll(SSD1306_t * dev, ssd1306_scroll_type_t scroll) {
 		ESP_LOGE(TAG, "Could not write to device [0x%02x at %d]: %d (%s)", dev->_address, dev->_i2c_num, res, esp_err_to_name(res));
 }
 
+const ssd1306_transport_t ssd1306_i2c_transport = {
+	.init = i2c_init,
+	.display_image = i2c_display_image,
+	.display_rect = i2c_display_rect,
+	.contrast = i2c_contrast,
+	.display_on = i2c_display_on,
+	.start_line = i2c_start_line,
+	.hardware_scroll = i2c_hardware_scroll,
+};
+#endif
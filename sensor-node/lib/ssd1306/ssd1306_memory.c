@@ -0,0 +1,170 @@
+#include <string.h>
+
+#include "ssd1306.h"
+#ifndef SSD1306_HOST
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#endif
+
+#define TAG "SSD1306"
+
+#ifdef SSD1306_HOST
+esp_log_level_t ssd1306_host_log_level = ESP_LOG_WARN;
+#endif
+
+// Transport that keeps the display RAM in memory instead of sending it to a
+// panel, and counts what would have gone over the bus. Together with
+// -DSSD1306_HOST it allows rendering on a PC, e.g.
+//   cc -DSSD1306_HOST -I. ssd1306.c ssd1306_memory.c app.c
+// memory_dump_pbm writes what the panel would show as a plain PBM image.
+
+typedef struct {
+	uint8_t gram[8][128];
+	int start_line;
+	int contrast;
+	bool on;
+	uint32_t transfers;
+	uint32_t bytes;
+} memory_state_t;
+
+static void memory_panel_init(SSD1306_t * dev, int width, int height)
+{
+	memory_state_t * state = dev->_transport_data;
+	dev->_width = width;
+	dev->_height = height;
+	dev->_pages = 8;
+	if (dev->_height == 32) dev->_pages = 4;
+	memset(state->gram, 0, sizeof(state->gram));
+	state->start_line = 0;
+	state->contrast = 0xFF;
+	state->on = true;
+}
+
+static void memory_display_image(SSD1306_t * dev, int page, int seg, uint8_t * images, int width)
+{
+	memory_state_t * state = dev->_transport_data;
+	if (page >= SSD1306_DEV_PAGES(dev)) return;
+	if (seg >= SSD1306_DEV_WIDTH(dev)) return;
+	if (seg + width > SSD1306_DEV_WIDTH(dev)) width = SSD1306_DEV_WIDTH(dev) - seg;
+
+	memcpy(&state->gram[ssd1306_ram_page(dev, page)][seg], images, width);
+	state->transfers++;
+	state->bytes = state->bytes + width;
+}
+
+static void memory_display_rect(SSD1306_t * dev, int page_start, int page_end, int seg, int width)
+{
+	memory_state_t * state = dev->_transport_data;
+	if (page_start > page_end || page_end >= SSD1306_DEV_PAGES(dev)) return;
+	if (seg >= SSD1306_DEV_WIDTH(dev)) return;
+	if (seg + width > SSD1306_DEV_WIDTH(dev)) width = SSD1306_DEV_WIDTH(dev) - seg;
+
+	for (int page = page_start; page <= page_end; page++) {
+		memcpy(&state->gram[ssd1306_ram_page(dev, page)][seg], &dev->_page[page]._segs[seg], width);
+	}
+	state->transfers++;
+	state->bytes = state->bytes + width * (page_end - page_start + 1);
+}
+
+static void memory_contrast(SSD1306_t * dev, int contrast)
+{
+	memory_state_t * state = dev->_transport_data;
+	int _contrast = contrast;
+	if (contrast < 0x0) _contrast = 0;
+	if (contrast > 0xFF) _contrast = 0xFF;
+	state->contrast = _contrast;
+	state->transfers++;
+}
+
+static void memory_display_on(SSD1306_t * dev, bool on)
+{
+	memory_state_t * state = dev->_transport_data;
+	state->on = on;
+	state->transfers++;
+}
+
+static void memory_start_line(SSD1306_t * dev, int line)
+{
+	memory_state_t * state = dev->_transport_data;
+	state->start_line = line & 0x3F;
+	state->transfers++;
+}
+
+static void memory_hardware_scroll(SSD1306_t * dev, ssd1306_scroll_type_t scroll)
+{
+	memory_state_t * state = dev->_transport_data;
+	ESP_LOGW(TAG, "hardware scroll is not emulated");
+	state->transfers++;
+}
+
+static const ssd1306_transport_t memory_transport = {
+	.init = memory_panel_init,
+	.display_image = memory_display_image,
+	.display_rect = memory_display_rect,
+	.contrast = memory_contrast,
+	.display_on = memory_display_on,
+	.start_line = memory_start_line,
+	.hardware_scroll = memory_hardware_scroll,
+};
+
+void memory_init(SSD1306_t * dev)
+{
+	memory_state_t * state = heap_caps_malloc(sizeof(memory_state_t), MALLOC_CAP_8BIT);
+	if (state == NULL) {
+		ESP_LOGE(TAG, "memory transport allocation failed");
+		return;
+	}
+	memset(state, 0, sizeof(memory_state_t));
+	dev->_transport = &memory_transport;
+	dev->_transport_data = state;
+	dev->_address = 0;
+	dev->_flip = false;
+	dev->_out_buf = NULL;
+}
+
+void memory_reset_stats(SSD1306_t * dev)
+{
+	memory_state_t * state = dev->_transport_data;
+	state->transfers = 0;
+	state->bytes = 0;
+}
+
+// Transfers and data bytes sent since memory_init or memory_reset_stats,
+// without the addressing commands a real bus adds to every transfer
+void memory_get_stats(SSD1306_t * dev, uint32_t * transfers, uint32_t * bytes)
+{
+	memory_state_t * state = dev->_transport_data;
+	*transfers = state->transfers;
+	*bytes = state->bytes;
+}
+
+// Pixel the panel shows at xpos, ypos as seen by the viewer, 1 if lit.
+// A flipped panel is assumed to be mounted upside down.
+uint8_t memory_get_pixel(SSD1306_t * dev, int xpos, int ypos)
+{
+	memory_state_t * state = dev->_transport_data;
+	if (xpos < 0 || xpos >= SSD1306_DEV_WIDTH(dev) || ypos < 0 || ypos >= SSD1306_DEV_HEIGHT(dev)) return 0;
+	if (!state->on) return 0;
+	int _row = dev->_flip ? (SSD1306_DEV_HEIGHT(dev) - ypos) - 1 : ypos;
+	_row = (_row + state->start_line) % 64;
+	return (state->gram[_row / 8][xpos] >> (_row % 8)) & 0x01;
+}
+
+// Write the panel content as a plain PBM image, lit pixels are 1 (black)
+bool memory_dump_pbm(SSD1306_t * dev, const char * path)
+{
+	FILE * fp = fopen(path, "w");
+	if (fp == NULL) {
+		ESP_LOGE(TAG, "could not open %s", path);
+		return false;
+	}
+	fprintf(fp, "P1\n%d %d\n", SSD1306_DEV_WIDTH(dev), SSD1306_DEV_HEIGHT(dev));
+	for (int ypos = 0; ypos < SSD1306_DEV_HEIGHT(dev); ypos++) {
+		for (int xpos = 0; xpos < SSD1306_DEV_WIDTH(dev); xpos++) {
+			fputc(memory_get_pixel(dev, xpos, ypos) ? '1' : '0', fp);
+			fputc(xpos == SSD1306_DEV_WIDTH(dev) - 1 ? '\n' : ' ', fp);
+		}
+	}
+	fclose(fp);
+	return true;
+}
@@ -1,3 +1,5 @@
+// The bus transports need ESP-IDF, host builds only have the memory transport
+#ifndef SSD1306_HOST
 #include <string.h>
 
 #include "freertos/FreeRTOS.h"
@@ -76,9 +78,11 @@ void spi_master_init(SSD1306_t * dev, int16_t mosi, int16_t sclk, int16_t cs, in
 	ESP_LOGI(TAG, "spi_bus_add_device=%d",ret);
 	assert(ret==ESP_OK);
 
+	dev->_transport = &ssd1306_spi_transport;
 	dev->_dc = dc;
 	dev->_address = SPI_ADDRESS;
 	dev->_flip = false;
+	dev->_out_buf = NULL;
 	dev->_spi_device_handle = spi_device_handle;
 }
 
@@ -132,9 +136,11 @@ void spi_device_add(SSD1306_t * dev, int16_t cs, int16_t dc, int16_t reset)
 	ESP_LOGI(TAG, "spi_bus_add_device=%d",ret);
 	assert(ret==ESP_OK);
 
+	dev->_transport = &ssd1306_spi_transport;
 	dev->_dc = dc;
 	dev->_address = SPI_ADDRESS;
 	dev->_flip = false;
+	dev->_out_buf = NULL;
 	dev->_spi_device_handle = spi_device_handle;
 }
 
@@ -161,6 +167,12 @@ bool spi_master_write_command(SSD1306_t * dev, uint8_t Command )
 	return spi_master_write_byte( dev->_spi_device_handle, &CommandByte, 1 );
 }
 
+bool spi_master_write_commands(SSD1306_t * dev, const uint8_t* Commands, size_t CommandsLength )
+{
+	gpio_set_level( dev->_dc, SPI_COMMAND_MODE );
+	return spi_master_write_byte( dev->_spi_device_handle, Commands, CommandsLength );
+}
+
 bool spi_master_write_data(SSD1306_t * dev, const uint8_t* Data, size_t DataLength )
 {
 	gpio_set_level( dev->_dc, SPI_DATA_MODE );
@@ -177,8 +189,8 @@ void spi_init(SSD1306_t * dev, int width, int height)
 
 	spi_master_write_command(dev, OLED_CMD_DISPLAY_OFF);			// AE
 	spi_master_write_command(dev, OLED_CMD_SET_MUX_RATIO);			// A8
-	if (dev->_height == 64) spi_master_write_command(dev, 0x3F);
-	if (dev->_height == 32) spi_master_write_command(dev, 0x1F);
+	if (SSD1306_DEV_HEIGHT(dev) == 64) spi_master_write_command(dev, 0x3F);
+	if (SSD1306_DEV_HEIGHT(dev) == 32) spi_master_write_command(dev, 0x1F);
 	spi_master_write_command(dev, OLED_CMD_SET_DISPLAY_OFFSET);		// D3
 	spi_master_write_command(dev, 0x00);
 	spi_master_write_command(dev, OLED_CONTROL_BYTE_DATA_STREAM);	// 40
@@ -192,20 +204,15 @@ void spi_init(SSD1306_t * dev, int width, int height)
 	spi_master_write_command(dev, OLED_CMD_SET_DISPLAY_CLK_DIV);	// D5
 	spi_master_write_command(dev, 0x80);
 	spi_master_write_command(dev, OLED_CMD_SET_COM_PIN_MAP);		// DA
-	if (dev->_height == 64) spi_master_write_command(dev, 0x12);
-	if (dev->_height == 32) spi_master_write_command(dev, 0x02);
+	if (SSD1306_DEV_HEIGHT(dev) == 64) spi_master_write_command(dev, 0x12);
+	if (SSD1306_DEV_HEIGHT(dev) == 32) spi_master_write_command(dev, 0x02);
 	spi_master_write_command(dev, OLED_CMD_SET_CONTRAST);			// 81
 	spi_master_write_command(dev, 0xFF);
 	spi_master_write_command(dev, OLED_CMD_DISPLAY_RAM);			// A4
 	spi_master_write_command(dev, OLED_CMD_SET_VCOMH_DESELCT);		// DB
 	spi_master_write_command(dev, 0x40);
 	spi_master_write_command(dev, OLED_CMD_SET_MEMORY_ADDR_MODE);	// 20
-	//spi_master_write_command(dev, OLED_CMD_SET_HORI_ADDR_MODE);	// 00
-	spi_master_write_command(dev, OLED_CMD_SET_PAGE_ADDR_MODE);		// 02
-	// Set Lower Column Start Address for Page Addressing Mode
-	spi_master_write_command(dev, 0x00);
-	// Set Higher Column Start Address for Page Addressing Mode
-	spi_master_write_command(dev, 0x10);
+	spi_master_write_command(dev, OLED_CMD_SET_HORI_ADDR_MODE);		// 00
 	spi_master_write_command(dev, OLED_CMD_SET_CHARGE_PUMP);		// 8D
 	spi_master_write_command(dev, 0x14);
 	spi_master_write_command(dev, OLED_CMD_DEACTIVE_SCROLL);		// 2E
@@ -214,29 +221,71 @@ void spi_init(SSD1306_t * dev, int width, int height)
 }
 
 
+// Column and page range for horizontal addressing mode, sent as one command transfer
+static void spi_set_range(SSD1306_t * dev, int page_start, int page_end, int seg, int width)
+{
+	uint8_t * commands = dev->_out_buf;
+	commands[0] = OLED_CMD_SET_COLUMN_RANGE;	// 21
+	commands[1] = seg + CONFIG_OFFSETX;
+	commands[2] = seg + CONFIG_OFFSETX + width - 1;
+	commands[3] = OLED_CMD_SET_PAGE_RANGE;		// 22
+	commands[4] = page_start;
+	commands[5] = page_end;
+	spi_master_write_commands(dev, commands, 6);
+}
+
 void spi_display_image(SSD1306_t * dev, int page, int seg, uint8_t * images, int width)
 {
-	if (page >= dev->_pages) return;
-	if (seg >= dev->_width) return;
+	if (page >= SSD1306_DEV_PAGES(dev)) return;
+	if (seg >= SSD1306_DEV_WIDTH(dev)) return;
+	if (seg + width > SSD1306_DEV_WIDTH(dev)) width = SSD1306_DEV_WIDTH(dev) - seg;
 
-	int _seg = seg + CONFIG_OFFSETX;
-	uint8_t columLow = _seg & 0x0F;
-	uint8_t columHigh = (_seg >> 4) & 0x0F;
+	int _page = ssd1306_ram_page(dev, page);
 
-	int _page = page;
-	if (dev->_flip) {
-		_page = (dev->_pages - page) - 1;
+	spi_set_range(dev, _page, _page, seg, width);
+	uint8_t * data = &dev->_out_buf[SSD1306_TRANSFER_HEADER];
+	memcpy(data, images, width);
+	spi_master_write_data(dev, data, width);
+}
+
+// Send segments seg to seg+width-1 of pages page_start to page_end from the
+// internal buffer in one DMA transfer.
+void spi_display_rect(SSD1306_t * dev, int page_start, int page_end, int seg, int width)
+{
+	if (page_start > page_end || page_end >= SSD1306_DEV_PAGES(dev)) return;
+	if (seg >= SSD1306_DEV_WIDTH(dev)) return;
+	if (seg + width > SSD1306_DEV_WIDTH(dev)) width = SSD1306_DEV_WIDTH(dev) - seg;
+
+	// After a hardware scroll the pages may wrap around in display RAM, send each run on its own
+	for (int page = page_start; page < page_end; page++) {
+		int step = ssd1306_ram_page(dev, page + 1) - ssd1306_ram_page(dev, page);
+		if (step != 1 && step != -1) {
+			spi_display_rect(dev, page_start, page, seg, width);
+			spi_display_rect(dev, page + 1, page_end, seg, width);
+			return;
+		}
 	}
 
-	// Set Lower Column Start Address for Page Addressing Mode
-	spi_master_write_command(dev, (0x00 + columLow));
-	// Set Higher Column Start Address for Page Addressing Mode
-	spi_master_write_command(dev, (0x10 + columHigh));
-	// Set Page Start Address for Page Addressing Mode
-	spi_master_write_command(dev, 0xB0 | _page);
+	int _page_start = ssd1306_ram_page(dev, page_start);
+	int _page_end = ssd1306_ram_page(dev, page_end);
+	if (dev->_flip) {
+		_page_start = ssd1306_ram_page(dev, page_end);
+		_page_end = ssd1306_ram_page(dev, page_start);
+	}
 
-	spi_master_write_data(dev, images, width);
+	spi_set_range(dev, _page_start, _page_end, seg, width);
+	uint8_t * data = &dev->_out_buf[SSD1306_TRANSFER_HEADER];
+	int length = 0;
+	for (int _page = _page_start; _page <= _page_end; _page++) {
+		int page = dev->_flip ? page_end - (_page - _page_start) : page_start + (_page - _page_start);
+		memcpy(&data[length], &dev->_page[page]._segs[seg], width);
+		length = length + width;
+	}
+	spi_master_write_data(dev, data, length);
+}
 
+void spi_start_line(SSD1306_t * dev, int line) {
+	spi_master_write_command(dev, OLED_CMD_SET_DISPLAY_START_LINE | (line & 0x3F));	// 40
 }
 
 void spi_contrast(SSD1306_t * dev, int contrast) {
@@ -248,6 +297,10 @@ void spi_contrast(SSD1306_t * dev, int contrast) {
 	spi_master_write_command(dev, _contrast);
 }
 
+void spi_display_on(SSD1306_t * dev, bool on) {
+	spi_master_write_command(dev, on ? OLED_CMD_DISPLAY_ON : OLED_CMD_DISPLAY_OFF);	// AF / AE
+}
+
 void spi_hardware_scroll(SSD1306_t * dev, ssd1306_scroll_type_t scroll)
 {
 
@@ -284,9 +337,9 @@ void spi_hardware_scroll(SSD1306_t * dev, ssd1306_scroll_type_t scroll)
 
 		spi_master_write_command(dev, OLED_CMD_VERTICAL);			// A3
 		spi_master_write_command(dev, 0x00);
-		if (dev->_height == 64)
+		if (SSD1306_DEV_HEIGHT(dev) == 64)
 			spi_master_write_command(dev, 0x40);
-		if (dev->_height == 32)
+		if (SSD1306_DEV_HEIGHT(dev) == 32)
 			spi_master_write_command(dev, 0x20);
 		spi_master_write_command(dev, OLED_CMD_ACTIVE_SCROLL);		// 2F
 	}
@@ -302,9 +355,9 @@ void spi_hardware_scroll(SSD1306_t * dev, ssd1306_scroll_type_t scroll)
 
 		spi_master_write_command(dev, OLED_CMD_VERTICAL);			// A3
 		spi_master_write_command(dev, 0x00);
-		if (dev->_height == 64)
+		if (SSD1306_DEV_HEIGHT(dev) == 64)
 			spi_master_write_command(dev, 0x40);
-		if (dev->_height == 32)
+		if (SSD1306_DEV_HEIGHT(dev) == 32)
 			spi_master_write_command(dev, 0x20);
 		spi_master_write_command(dev, OLED_CMD_ACTIVE_SCROLL);		// 2F
 	}
@@ -313,3 +366,14 @@ void spi_hardware_scroll(SSD1306_t * dev, ssd1306_scroll_type_t scroll)
 		spi_master_write_command(dev, OLED_CMD_DEACTIVE_SCROLL);	// 2E
 	}
 }
+
+const ssd1306_transport_t ssd1306_spi_transport = {
+	.init = spi_init,
+	.display_image = spi_display_image,
+	.display_rect = spi_display_rect,
+	.contrast = spi_contrast,
+	.display_on = spi_display_on,
+	.start_line = spi_start_line,
+	.hardware_scroll = spi_hardware_scroll,
+};
+#endif
@@ -0,0 +1,360 @@
+// Generated by tools/gen_tables.py from font8x8_basic.h, do not edit.
+
+#ifndef MAIN_SSD1306_TABLES_H_
+#define MAIN_SSD1306_TABLES_H_
+
+#include <stdint.h>
+
+// Bit order of every byte reversed, used to flip upside down
+static const uint8_t ssd1306_reverse_table[256] = {
+	0x00, 0x80, 0x40, 0xC0, 0x20, 0xA0, 0x60, 0xE0, 0x10, 0x90, 0x50, 0xD0, 0x30, 0xB0, 0x70, 0xF0,
+	0x08, 0x88, 0x48, 0xC8, 0x28, 0xA8, 0x68, 0xE8, 0x18, 0x98, 0x58, 0xD8, 0x38, 0xB8, 0x78, 0xF8,
+	0x04, 0x84, 0x44, 0xC4, 0x24, 0xA4, 0x64, 0xE4, 0x14, 0x94, 0x54, 0xD4, 0x34, 0xB4, 0x74, 0xF4,
+	0x0C, 0x8C, 0x4C, 0xCC, 0x2C, 0xAC, 0x6C, 0xEC, 0x1C, 0x9C, 0x5C, 0xDC, 0x3C, 0xBC, 0x7C, 0xFC,
+	0x02, 0x82, 0x42, 0xC2, 0x22, 0xA2, 0x62, 0xE2, 0x12, 0x92, 0x52, 0xD2, 0x32, 0xB2, 0x72, 0xF2,
+	0x0A, 0x8A, 0x4A, 0xCA, 0x2A, 0xAA, 0x6A, 0xEA, 0x1A, 0x9A, 0x5A, 0xDA, 0x3A, 0xBA, 0x7A, 0xFA,
+	0x06, 0x86, 0x46, 0xC6, 0x26, 0xA6, 0x66, 0xE6, 0x16, 0x96, 0x56, 0xD6, 0x36, 0xB6, 0x76, 0xF6,
+	0x0E, 0x8E, 0x4E, 0xCE, 0x2E, 0xAE, 0x6E, 0xEE, 0x1E, 0x9E, 0x5E, 0xDE, 0x3E, 0xBE, 0x7E, 0xFE,
+	0x01, 0x81, 0x41, 0xC1, 0x21, 0xA1, 0x61, 0xE1, 0x11, 0x91, 0x51, 0xD1, 0x31, 0xB1, 0x71, 0xF1,
+	0x09, 0x89, 0x49, 0xC9, 0x29, 0xA9, 0x69, 0xE9, 0x19, 0x99, 0x59, 0xD9, 0x39, 0xB9, 0x79, 0xF9,
+	0x05, 0x85, 0x45, 0xC5, 0x25, 0xA5, 0x65, 0xE5, 0x15, 0x95, 0x55, 0xD5, 0x35, 0xB5, 0x75, 0xF5,
+	0x0D, 0x8D, 0x4D, 0xCD, 0x2D, 0xAD, 0x6D, 0xED, 0x1D, 0x9D, 0x5D, 0xDD, 0x3D, 0xBD, 0x7D, 0xFD,
+	0x03, 0x83, 0x43, 0xC3, 0x23, 0xA3, 0x63, 0xE3, 0x13, 0x93, 0x53, 0xD3, 0x33, 0xB3, 0x73, 0xF3,
+	0x0B, 0x8B, 0x4B, 0xCB, 0x2B, 0xAB, 0x6B, 0xEB, 0x1B, 0x9B, 0x5B, 0xDB, 0x3B, 0xBB, 0x7B, 0xFB,
+	0x07, 0x87, 0x47, 0xC7, 0x27, 0xA7, 0x67, 0xE7, 0x17, 0x97, 0x57, 0xD7, 0x37, 0xB7, 0x77, 0xF7,
+	0x0F, 0x8F, 0x4F, 0xCF, 0x2F, 0xAF, 0x6F, 0xEF, 0x1F, 0x9F, 0x5F, 0xDF, 0x3F, 0xBF, 0x7F, 0xFF,
+};
+
+// Column byte scaled to 3x height, one byte per page from top to bottom
+static const uint8_t ssd1306_x3_table[256][3] = {
+	{ 0x00, 0x00, 0x00 }, { 0x07, 0x00, 0x00 }, { 0x38, 0x00, 0x00 }, { 0x3F, 0x00, 0x00 },
+	{ 0xC0, 0x01, 0x00 }, { 0xC7, 0x01, 0x00 }, { 0xF8, 0x01, 0x00 }, { 0xFF, 0x01, 0x00 },
+	{ 0x00, 0x0E, 0x00 }, { 0x07, 0x0E, 0x00 }, { 0x38, 0x0E, 0x00 }, { 0x3F, 0x0E, 0x00 },
+	{ 0xC0, 0x0F, 0x00 }, { 0xC7, 0x0F, 0x00 }, { 0xF8, 0x0F, 0x00 }, { 0xFF, 0x0F, 0x00 },
+	{ 0x00, 0x70, 0x00 }, { 0x07, 0x70, 0x00 }, { 0x38, 0x70, 0x00 }, { 0x3F, 0x70, 0x00 },
+	{ 0xC0, 0x71, 0x00 }, { 0xC7, 0x71, 0x00 }, { 0xF8, 0x71, 0x00 }, { 0xFF, 0x71, 0x00 },
+	{ 0x00, 0x7E, 0x00 }, { 0x07, 0x7E, 0x00 }, { 0x38, 0x7E, 0x00 }, { 0x3F, 0x7E, 0x00 },
+	{ 0xC0, 0x7F, 0x00 }, { 0xC7, 0x7F, 0x00 }, { 0xF8, 0x7F, 0x00 }, { 0xFF, 0x7F, 0x00 },
+	{ 0x00, 0x80, 0x03 }, { 0x07, 0x80, 0x03 }, { 0x38, 0x80, 0x03 }, { 0x3F, 0x80, 0x03 },
+	{ 0xC0, 0x81, 0x03 }, { 0xC7, 0x81, 0x03 }, { 0xF8, 0x81, 0x03 }, { 0xFF, 0x81, 0x03 },
+	{ 0x00, 0x8E, 0x03 }, { 0x07, 0x8E, 0x03 }, { 0x38, 0x8E, 0x03 }, { 0x3F, 0x8E, 0x03 },
+	{ 0xC0, 0x8F, 0x03 }, { 0xC7, 0x8F, 0x03 }, { 0xF8, 0x8F, 0x03 }, { 0xFF, 0x8F, 0x03 },
+	{ 0x00, 0xF0, 0x03 }, { 0x07, 0xF0, 0x03 }, { 0x38, 0xF0, 0x03 }, { 0x3F, 0xF0, 0x03 },
+	{ 0xC0, 0xF1, 0x03 }, { 0xC7, 0xF1, 0x03 }, { 0xF8, 0xF1, 0x03 }, { 0xFF, 0xF1, 0x03 },
+	{ 0x00, 0xFE, 0x03 }, { 0x07, 0xFE, 0x03 }, { 0x38, 0xFE, 0x03 }, { 0x3F, 0xFE, 0x03 },
+	{ 0xC0, 0xFF, 0x03 }, { 0xC7, 0xFF, 0x03 }, { 0xF8, 0xFF, 0x03 }, { 0xFF, 0xFF, 0x03 },
+	{ 0x00, 0x00, 0x1C }, { 0x07, 0x00, 0x1C }, { 0x38, 0x00, 0x1C }, { 0x3F, 0x00, 0x1C },
+	{ 0xC0, 0x01, 0x1C }, { 0xC7, 0x01, 0x1C }, { 0xF8, 0x01, 0x1C }, { 0xFF, 0x01, 0x1C },
+	{ 0x00, 0x0E, 0x1C }, { 0x07, 0x0E, 0x1C }, { 0x38, 0x0E, 0x1C }, { 0x3F, 0x0E, 0x1C },
+	{ 0xC0, 0x0F, 0x1C }, { 0xC7, 0x0F, 0x1C }, { 0xF8, 0x0F, 0x1C }, { 0xFF, 0x0F, 0x1C },
+	{ 0x00, 0x70, 0x1C }, { 0x07, 0x70, 0x1C }, { 0x38, 0x70, 0x1C }, { 0x3F, 0x70, 0x1C },
+	{ 0xC0, 0x71, 0x1C }, { 0xC7, 0x71, 0x1C }, { 0xF8, 0x71, 0x1C }, { 0xFF, 0x71, 0x1C },
+	{ 0x00, 0x7E, 0x1C }, { 0x07, 0x7E, 0x1C }, { 0x38, 0x7E, 0x1C }, { 0x3F, 0x7E, 0x1C },
+	{ 0xC0, 0x7F, 0x1C }, { 0xC7, 0x7F, 0x1C }, { 0xF8, 0x7F, 0x1C }, { 0xFF, 0x7F, 0x1C },
+	{ 0x00, 0x80, 0x1F }, { 0x07, 0x80, 0x1F }, { 0x38, 0x80, 0x1F }, { 0x3F, 0x80, 0x1F },
+	{ 0xC0, 0x81, 0x1F }, { 0xC7, 0x81, 0x1F }, { 0xF8, 0x81, 0x1F }, { 0xFF, 0x81, 0x1F },
+	{ 0x00, 0x8E, 0x1F }, { 0x07, 0x8E, 0x1F }, { 0x38, 0x8E, 0x1F }, { 0x3F, 0x8E, 0x1F },
+	{ 0xC0, 0x8F, 0x1F }, { 0xC7, 0x8F, 0x1F }, { 0xF8, 0x8F, 0x1F }, { 0xFF, 0x8F, 0x1F },
+	{ 0x00, 0xF0, 0x1F }, { 0x07, 0xF0, 0x1F }, { 0x38, 0xF0, 0x1F }, { 0x3F, 0xF0, 0x1F },
+	{ 0xC0, 0xF1, 0x1F }, { 0xC7, 0xF1, 0x1F }, { 0xF8, 0xF1, 0x1F }, { 0xFF, 0xF1, 0x1F },
+	{ 0x00, 0xFE, 0x1F }, { 0x07, 0xFE, 0x1F }, { 0x38, 0xFE, 0x1F }, { 0x3F, 0xFE, 0x1F },
+	{ 0xC0, 0xFF, 0x1F }, { 0xC7, 0xFF, 0x1F }, { 0xF8, 0xFF, 0x1F }, { 0xFF, 0xFF, 0x1F },
+	{ 0x00, 0x00, 0xE0 }, { 0x07, 0x00, 0xE0 }, { 0x38, 0x00, 0xE0 }, { 0x3F, 0x00, 0xE0 },
+	{ 0xC0, 0x01, 0xE0 }, { 0xC7, 0x01, 0xE0 }, { 0xF8, 0x01, 0xE0 }, { 0xFF, 0x01, 0xE0 },
+	{ 0x00, 0x0E, 0xE0 }, { 0x07, 0x0E, 0xE0 }, { 0x38, 0x0E, 0xE0 }, { 0x3F, 0x0E, 0xE0 },
+	{ 0xC0, 0x0F, 0xE0 }, { 0xC7, 0x0F, 0xE0 }, { 0xF8, 0x0F, 0xE0 }, { 0xFF, 0x0F, 0xE0 },
+	{ 0x00, 0x70, 0xE0 }, { 0x07, 0x70, 0xE0 }, { 0x38, 0x70, 0xE0 }, { 0x3F, 0x70, 0xE0 },
+	{ 0xC0, 0x71, 0xE0 }, { 0xC7, 0x71, 0xE0 }, { 0xF8, 0x71, 0xE0 }, { 0xFF, 0x71, 0xE0 },
+	{ 0x00, 0x7E, 0xE0 }, { 0x07, 0x7E, 0xE0 }, { 0x38, 0x7E, 0xE0 }, { 0x3F, 0x7E, 0xE0 },
+	{ 0xC0, 0x7F, 0xE0 }, { 0xC7, 0x7F, 0xE0 }, { 0xF8, 0x7F, 0xE0 }, { 0xFF, 0x7F, 0xE0 },
+	{ 0x00, 0x80, 0xE3 }, { 0x07, 0x80, 0xE3 }, { 0x38, 0x80, 0xE3 }, { 0x3F, 0x80, 0xE3 },
+	{ 0xC0, 0x81, 0xE3 }, { 0xC7, 0x81, 0xE3 }, { 0xF8, 0x81, 0xE3 }, { 0xFF, 0x81, 0xE3 },
+	{ 0x00, 0x8E, 0xE3 }, { 0x07, 0x8E, 0xE3 }, { 0x38, 0x8E, 0xE3 }, { 0x3F, 0x8E, 0xE3 },
+	{ 0xC0, 0x8F, 0xE3 }, { 0xC7, 0x8F, 0xE3 }, { 0xF8, 0x8F, 0xE3 }, { 0xFF, 0x8F, 0xE3 },
+	{ 0x00, 0xF0, 0xE3 }, { 0x07, 0xF0, 0xE3 }, { 0x38, 0xF0, 0xE3 }, { 0x3F, 0xF0, 0xE3 },
+	{ 0xC0, 0xF1, 0xE3 }, { 0xC7, 0xF1, 0xE3 }, { 0xF8, 0xF1, 0xE3 }, { 0xFF, 0xF1, 0xE3 },
+	{ 0x00, 0xFE, 0xE3 }, { 0x07, 0xFE, 0xE3 }, { 0x38, 0xFE, 0xE3 }, { 0x3F, 0xFE, 0xE3 },
+	{ 0xC0, 0xFF, 0xE3 }, { 0xC7, 0xFF, 0xE3 }, { 0xF8, 0xFF, 0xE3 }, { 0xFF, 0xFF, 0xE3 },
+	{ 0x00, 0x00, 0xFC }, { 0x07, 0x00, 0xFC }, { 0x38, 0x00, 0xFC }, { 0x3F, 0x00, 0xFC },
+	{ 0xC0, 0x01, 0xFC }, { 0xC7, 0x01, 0xFC }, { 0xF8, 0x01, 0xFC }, { 0xFF, 0x01, 0xFC },
+	{ 0x00, 0x0E, 0xFC }, { 0x07, 0x0E, 0xFC }, { 0x38, 0x0E, 0xFC }, { 0x3F, 0x0E, 0xFC },
+	{ 0xC0, 0x0F, 0xFC }, { 0xC7, 0x0F, 0xFC }, { 0xF8, 0x0F, 0xFC }, { 0xFF, 0x0F, 0xFC },
+	{ 0x00, 0x70, 0xFC }, { 0x07, 0x70, 0xFC }, { 0x38, 0x70, 0xFC }, { 0x3F, 0x70, 0xFC },
+	{ 0xC0, 0x71, 0xFC }, { 0xC7, 0x71, 0xFC }, { 0xF8, 0x71, 0xFC }, { 0xFF, 0x71, 0xFC },
+	{ 0x00, 0x7E, 0xFC }, { 0x07, 0x7E, 0xFC }, { 0x38, 0x7E, 0xFC }, { 0x3F, 0x7E, 0xFC },
+	{ 0xC0, 0x7F, 0xFC }, { 0xC7, 0x7F, 0xFC }, { 0xF8, 0x7F, 0xFC }, { 0xFF, 0x7F, 0xFC },
+	{ 0x00, 0x80, 0xFF }, { 0x07, 0x80, 0xFF }, { 0x38, 0x80, 0xFF }, { 0x3F, 0x80, 0xFF },
+	{ 0xC0, 0x81, 0xFF }, { 0xC7, 0x81, 0xFF }, { 0xF8, 0x81, 0xFF }, { 0xFF, 0x81, 0xFF },
+	{ 0x00, 0x8E, 0xFF }, { 0x07, 0x8E, 0xFF }, { 0x38, 0x8E, 0xFF }, { 0x3F, 0x8E, 0xFF },
+	{ 0xC0, 0x8F, 0xFF }, { 0xC7, 0x8F, 0xFF }, { 0xF8, 0x8F, 0xFF }, { 0xFF, 0x8F, 0xFF },
+	{ 0x00, 0xF0, 0xFF }, { 0x07, 0xF0, 0xFF }, { 0x38, 0xF0, 0xFF }, { 0x3F, 0xF0, 0xFF },
+	{ 0xC0, 0xF1, 0xFF }, { 0xC7, 0xF1, 0xFF }, { 0xF8, 0xF1, 0xFF }, { 0xFF, 0xF1, 0xFF },
+	{ 0x00, 0xFE, 0xFF }, { 0x07, 0xFE, 0xFF }, { 0x38, 0xFE, 0xFF }, { 0x3F, 0xFE, 0xFF },
+	{ 0xC0, 0xFF, 0xFF }, { 0xC7, 0xFF, 0xFF }, { 0xF8, 0xFF, 0xFF }, { 0xFF, 0xFF, 0xFF },
+};
+
+// font8x8_basic_tr flipped upside down
+static const uint8_t font8x8_basic_flip[128][8] = {
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0000
+	{ 0x00, 0x20, 0x40, 0xFF, 0x40, 0x20, 0x00, 0x00 }, // U+0001
+	{ 0x00, 0x04, 0x02, 0xFF, 0x02, 0x04, 0x00, 0x00 }, // U+0002
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0003
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0004
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0005
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0006
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0007
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0008
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0009
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+000A
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+000B
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+000C
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+000D
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+000E
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+000F
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0010
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0011
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0012
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0013
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0014
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0015
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0016
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0017
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0018
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0019
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+001A
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+001B
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+001C
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+001D
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+001E
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+001F
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0020
+	{ 0x00, 0x00, 0x60, 0xFA, 0xFA, 0x60, 0x00, 0x00 }, // U+0021
+	{ 0x00, 0xC0, 0xC0, 0x00, 0xC0, 0xC0, 0x00, 0x00 }, // U+0022
+	{ 0x28, 0xFE, 0xFE, 0x28, 0xFE, 0xFE, 0x28, 0x00 }, // U+0023
+	{ 0x24, 0x74, 0xD6, 0xD6, 0x5C, 0x48, 0x00, 0x00 }, // U+0024
+	{ 0x62, 0x66, 0x0C, 0x18, 0x30, 0x66, 0x46, 0x00 }, // U+0025
+	{ 0x0C, 0x5E, 0xF2, 0xBA, 0xEC, 0x5E, 0x12, 0x00 }, // U+0026
+	{ 0x20, 0xE0, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0027
+	{ 0x00, 0x38, 0x7C, 0xC6, 0x82, 0x00, 0x00, 0x00 }, // U+0028
+	{ 0x00, 0x82, 0xC6, 0x7C, 0x38, 0x00, 0x00, 0x00 }, // U+0029
+	{ 0x10, 0x54, 0x7C, 0x38, 0x38, 0x7C, 0x54, 0x10 }, // U+002A
+	{ 0x10, 0x10, 0x7C, 0x7C, 0x10, 0x10, 0x00, 0x00 }, // U+002B
+	{ 0x00, 0x01, 0x07, 0x06, 0x00, 0x00, 0x00, 0x00 }, // U+002C
+	{ 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00 }, // U+002D
+	{ 0x00, 0x00, 0x06, 0x06, 0x00, 0x00, 0x00, 0x00 }, // U+002E
+	{ 0x06, 0x0C, 0x18, 0x30, 0x60, 0xC0, 0x80, 0x00 }, // U+002F
+	{ 0x7C, 0xFE, 0x8E, 0x9A, 0xB2, 0xFE, 0x7C, 0x00 }, // U+0030
+	{ 0x02, 0x42, 0xFE, 0xFE, 0x02, 0x02, 0x00, 0x00 }, // U+0031
+	{ 0x46, 0xCE, 0x9A, 0x92, 0xF6, 0x66, 0x00, 0x00 }, // U+0032
+	{ 0x44, 0xC6, 0x92, 0x92, 0xFE, 0x6C, 0x00, 0x00 }, // U+0033
+	{ 0x18, 0x38, 0x68, 0xCA, 0xFE, 0xFE, 0x0A, 0x00 }, // U+0034
+	{ 0xE4, 0xE6, 0xA2, 0xA2, 0xBE, 0x9C, 0x00, 0x00 }, // U+0035
+	{ 0x3C, 0x7E, 0xD2, 0x92, 0x9E, 0x0C, 0x00, 0x00 }, // U+0036
+	{ 0xC0, 0xC0, 0x8E, 0x9E, 0xF0, 0xE0, 0x00, 0x00 }, // U+0037
+	{ 0x6C, 0xFE, 0x92, 0x92, 0xFE, 0x6C, 0x00, 0x00 }, // U+0038
+	{ 0x60, 0xF2, 0x92, 0x96, 0xFC, 0x78, 0x00, 0x00 }, // U+0039
+	{ 0x00, 0x00, 0x66, 0x66, 0x00, 0x00, 0x00, 0x00 }, // U+003A
+	{ 0x00, 0x01, 0x67, 0x66, 0x00, 0x00, 0x00, 0x00 }, // U+003B
+	{ 0x10, 0x38, 0x6C, 0xC6, 0x82, 0x00, 0x00, 0x00 }, // U+003C
+	{ 0x24, 0x24, 0x24, 0x24, 0x24, 0x24, 0x00, 0x00 }, // U+003D
+	{ 0x00, 0x82, 0xC6, 0x6C, 0x38, 0x10, 0x00, 0x00 }, // U+003E
+	{ 0x40, 0xC0, 0x8A, 0x9A, 0xF0, 0x60, 0x00, 0x00 }, // U+003F
+	{ 0x7C, 0xFE, 0x82, 0xBA, 0xBA, 0xF8, 0x78, 0x00 }, // U+0040
+	{ 0x3E, 0x7E, 0xC8, 0xC8, 0x7E, 0x3E, 0x00, 0x00 }, // U+0041
+	{ 0x82, 0xFE, 0xFE, 0x92, 0x92, 0xFE, 0x6C, 0x00 }, // U+0042
+	{ 0x38, 0x7C, 0xC6, 0x82, 0x82, 0xC6, 0x44, 0x00 }, // U+0043
+	{ 0x82, 0xFE, 0xFE, 0x82, 0xC6, 0x7C, 0x38, 0x00 }, // U+0044
+	{ 0x82, 0xFE, 0xFE, 0x92, 0xBA, 0x82, 0xC6, 0x00 }, // U+0045
+	{ 0x82, 0xFE, 0xFE, 0x92, 0xB8, 0x80, 0xC0, 0x00 }, // U+0046
+	{ 0x38, 0x7C, 0xC6, 0x82, 0x8A, 0xCE, 0x4E, 0x00 }, // U+0047
+	{ 0xFE, 0xFE, 0x10, 0x10, 0xFE, 0xFE, 0x00, 0x00 }, // U+0048
+	{ 0x00, 0x82, 0xFE, 0xFE, 0x82, 0x00, 0x00, 0x00 }, // U+0049
+	{ 0x0C, 0x0E, 0x02, 0x82, 0xFE, 0xFC, 0x80, 0x00 }, // U+004A
+	{ 0x82, 0xFE, 0xFE, 0x10, 0x38, 0xEE, 0xC6, 0x00 }, // U+004B
+	{ 0x82, 0xFE, 0xFE, 0x82, 0x02, 0x06, 0x0E, 0x00 }, // U+004C
+	{ 0xFE, 0xFE, 0x70, 0x38, 0x70, 0xFE, 0xFE, 0x00 }, // U+004D
+	{ 0xFE, 0xFE, 0x60, 0x30, 0x18, 0xFE, 0xFE, 0x00 }, // U+004E
+	{ 0x38, 0x7C, 0xC6, 0x82, 0xC6, 0x7C, 0x38, 0x00 }, // U+004F
+	{ 0x82, 0xFE, 0xFE, 0x92, 0x90, 0xF0, 0x60, 0x00 }, // U+0050
+	{ 0x78, 0xFC, 0x84, 0x8E, 0xFE, 0x7A, 0x00, 0x00 }, // U+0051
+	{ 0x82, 0xFE, 0xFE, 0x90, 0x98, 0xFE, 0x66, 0x00 }, // U+0052
+	{ 0x64, 0xF6, 0xB2, 0x9A, 0xCE, 0x4C, 0x00, 0x00 }, // U+0053
+	{ 0xC0, 0x82, 0xFE, 0xFE, 0x82, 0xC0, 0x00, 0x00 }, // U+0054
+	{ 0xFE, 0xFE, 0x02, 0x02, 0xFE, 0xFE, 0x00, 0x00 }, // U+0055
+	{ 0xF8, 0xFC, 0x06, 0x06, 0xFC, 0xF8, 0x00, 0x00 }, // U+0056
+	{ 0xFE, 0xFE, 0x0C, 0x18, 0x0C, 0xFE, 0xFE, 0x00 }, // U+0057
+	{ 0xC2, 0xE6, 0x3C, 0x18, 0x3C, 0xE6, 0xC2, 0x00 }, // U+0058
+	{ 0xE0, 0xF2, 0x1E, 0x1E, 0xF2, 0xE0, 0x00, 0x00 }, // U+0059
+	{ 0xE2, 0xC6, 0x8E, 0x9A, 0xB2, 0xE6, 0xCE, 0x00 }, // U+005A
+	{ 0x00, 0xFE, 0xFE, 0x82, 0x82, 0x00, 0x00, 0x00 }, // U+005B
+	{ 0x80, 0xC0, 0x60, 0x30, 0x18, 0x0C, 0x06, 0x00 }, // U+005C
+	{ 0x00, 0x82, 0x82, 0xFE, 0xFE, 0x00, 0x00, 0x00 }, // U+005D
+	{ 0x10, 0x30, 0x60, 0xC0, 0x60, 0x30, 0x10, 0x00 }, // U+005E
+	{ 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01 }, // U+005F
+	{ 0x00, 0x00, 0xC0, 0xE0, 0x20, 0x00, 0x00, 0x00 }, // U+0060
+	{ 0x04, 0x2E, 0x2A, 0x2A, 0x3C, 0x1E, 0x02, 0x00 }, // U+0061
+	{ 0x82, 0xFE, 0xFC, 0x12, 0x12, 0x1E, 0x0C, 0x00 }, // U+0062
+	{ 0x1C, 0x3E, 0x22, 0x22, 0x36, 0x14, 0x00, 0x00 }, // U+0063
+	{ 0x0C, 0x1E, 0x12, 0x92, 0xFC, 0xFE, 0x02, 0x00 }, // U+0064
+	{ 0x1C, 0x3E, 0x2A, 0x2A, 0x3A, 0x18, 0x00, 0x00 }, // U+0065
+	{ 0x12, 0x7E, 0xFE, 0x92, 0xC0, 0x40, 0x00, 0x00 }, // U+0066
+	{ 0x19, 0x3D, 0x25, 0x25, 0x1F, 0x3E, 0x20, 0x00 }, // U+0067
+	{ 0x82, 0xFE, 0xFE, 0x10, 0x20, 0x3E, 0x1E, 0x00 }, // U+0068
+	{ 0x00, 0x22, 0xBE, 0xBE, 0x02, 0x00, 0x00, 0x00 }, // U+0069
+	{ 0x06, 0x07, 0x01, 0x01, 0xBF, 0xBE, 0x00, 0x00 }, // U+006A
+	{ 0x82, 0xFE, 0xFE, 0x08, 0x1C, 0x36, 0x22, 0x00 }, // U+006B
+	{ 0x00, 0x82, 0xFE, 0xFE, 0x02, 0x00, 0x00, 0x00 }, // U+006C
+	{ 0x3E, 0x3E, 0x18, 0x1C, 0x38, 0x3E, 0x1E, 0x00 }, // U+006D
+	{ 0x3E, 0x3E, 0x20, 0x20, 0x3E, 0x1E, 0x00, 0x00 }, // U+006E
+	{ 0x1C, 0x3E, 0x22, 0x22, 0x3E, 0x1C, 0x00, 0x00 }, // U+006F
+	{ 0x21, 0x3F, 0x1F, 0x25, 0x24, 0x3C, 0x18, 0x00 }, // U+0070
+	{ 0x18, 0x3C, 0x24, 0x25, 0x1F, 0x3F, 0x21, 0x00 }, // U+0071
+	{ 0x22, 0x3E, 0x1E, 0x32, 0x20, 0x38, 0x18, 0x00 }, // U+0072
+	{ 0x12, 0x3A, 0x2A, 0x2A, 0x2E, 0x24, 0x00, 0x00 }, // U+0073
+	{ 0x00, 0x20, 0x7C, 0xFE, 0x22, 0x24, 0x00, 0x00 }, // U+0074
+	{ 0x3C, 0x3E, 0x02, 0x02, 0x3C, 0x3E, 0x02, 0x00 }, // U+0075
+	{ 0x38, 0x3C, 0x06, 0x06, 0x3C, 0x38, 0x00, 0x00 }, // U+0076
+	{ 0x3C, 0x3E, 0x0E, 0x1C, 0x0E, 0x3E, 0x3C, 0x00 }, // U+0077
+	{ 0x22, 0x36, 0x1C, 0x08, 0x1C, 0x36, 0x22, 0x00 }, // U+0078
+	{ 0x39, 0x3D, 0x05, 0x05, 0x3F, 0x3E, 0x00, 0x00 }, // U+0079
+	{ 0x32, 0x26, 0x2E, 0x3A, 0x32, 0x26, 0x00, 0x00 }, // U+007A
+	{ 0x10, 0x10, 0x7C, 0xEE, 0x82, 0x82, 0x00, 0x00 }, // U+007B
+	{ 0x00, 0x00, 0x00, 0xEE, 0xEE, 0x00, 0x00, 0x00 }, // U+007C
+	{ 0x82, 0x82, 0xEE, 0x7C, 0x10, 0x10, 0x00, 0x00 }, // U+007D
+	{ 0x40, 0xC0, 0x80, 0xC0, 0x40, 0xC0, 0x80, 0x00 }, // U+007E
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+007F
+};
+
+// font8x8_basic_tr rotated for ssd1306_display_rotate_text
+static const uint8_t font8x8_basic_rot[128][8] = {
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0000
+	{ 0x10, 0x38, 0x54, 0x10, 0x10, 0x10, 0x10, 0x10 }, // U+0001
+	{ 0x10, 0x10, 0x10, 0x10, 0x10, 0x54, 0x38, 0x10 }, // U+0002
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0003
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0004
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0005
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0006
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0007
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0008
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0009
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+000A
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+000B
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+000C
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+000D
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+000E
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+000F
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0010
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0011
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0012
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0013
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0014
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0015
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0016
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0017
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0018
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0019
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+001A
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+001B
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+001C
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+001D
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+001E
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+001F
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0020
+	{ 0x18, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x18, 0x00 }, // U+0021
+	{ 0x6C, 0x6C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0022
+	{ 0x6C, 0x6C, 0xFE, 0x6C, 0xFE, 0x6C, 0x6C, 0x00 }, // U+0023
+	{ 0x30, 0x7C, 0xC0, 0x78, 0x0C, 0xF8, 0x30, 0x00 }, // U+0024
+	{ 0x00, 0xC6, 0xCC, 0x18, 0x30, 0x66, 0xC6, 0x00 }, // U+0025
+	{ 0x38, 0x6C, 0x38, 0x76, 0xDC, 0xCC, 0x76, 0x00 }, // U+0026
+	{ 0x60, 0x60, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0027
+	{ 0x18, 0x30, 0x60, 0x60, 0x60, 0x30, 0x18, 0x00 }, // U+0028
+	{ 0x60, 0x30, 0x18, 0x18, 0x18, 0x30, 0x60, 0x00 }, // U+0029
+	{ 0x00, 0x66, 0x3C, 0xFF, 0x3C, 0x66, 0x00, 0x00 }, // U+002A
+	{ 0x00, 0x30, 0x30, 0xFC, 0x30, 0x30, 0x00, 0x00 }, // U+002B
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x60 }, // U+002C
+	{ 0x00, 0x00, 0x00, 0xFC, 0x00, 0x00, 0x00, 0x00 }, // U+002D
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x00 }, // U+002E
+	{ 0x06, 0x0C, 0x18, 0x30, 0x60, 0xC0, 0x80, 0x00 }, // U+002F
+	{ 0x7C, 0xC6, 0xCE, 0xDE, 0xF6, 0xE6, 0x7C, 0x00 }, // U+0030
+	{ 0x30, 0x70, 0x30, 0x30, 0x30, 0x30, 0xFC, 0x00 }, // U+0031
+	{ 0x78, 0xCC, 0x0C, 0x38, 0x60, 0xCC, 0xFC, 0x00 }, // U+0032
+	{ 0x78, 0xCC, 0x0C, 0x38, 0x0C, 0xCC, 0x78, 0x00 }, // U+0033
+	{ 0x1C, 0x3C, 0x6C, 0xCC, 0xFE, 0x0C, 0x1E, 0x00 }, // U+0034
+	{ 0xFC, 0xC0, 0xF8, 0x0C, 0x0C, 0xCC, 0x78, 0x00 }, // U+0035
+	{ 0x38, 0x60, 0xC0, 0xF8, 0xCC, 0xCC, 0x78, 0x00 }, // U+0036
+	{ 0xFC, 0xCC, 0x0C, 0x18, 0x30, 0x30, 0x30, 0x00 }, // U+0037
+	{ 0x78, 0xCC, 0xCC, 0x78, 0xCC, 0xCC, 0x78, 0x00 }, // U+0038
+	{ 0x78, 0xCC, 0xCC, 0x7C, 0x0C, 0x18, 0x70, 0x00 }, // U+0039
+	{ 0x00, 0x30, 0x30, 0x00, 0x00, 0x30, 0x30, 0x00 }, // U+003A
+	{ 0x00, 0x30, 0x30, 0x00, 0x00, 0x30, 0x30, 0x60 }, // U+003B
+	{ 0x18, 0x30, 0x60, 0xC0, 0x60, 0x30, 0x18, 0x00 }, // U+003C
+	{ 0x00, 0x00, 0xFC, 0x00, 0x00, 0xFC, 0x00, 0x00 }, // U+003D
+	{ 0x60, 0x30, 0x18, 0x0C, 0x18, 0x30, 0x60, 0x00 }, // U+003E
+	{ 0x78, 0xCC, 0x0C, 0x18, 0x30, 0x00, 0x30, 0x00 }, // U+003F
+	{ 0x7C, 0xC6, 0xDE, 0xDE, 0xDE, 0xC0, 0x78, 0x00 }, // U+0040
+	{ 0x30, 0x78, 0xCC, 0xCC, 0xFC, 0xCC, 0xCC, 0x00 }, // U+0041
+	{ 0xFC, 0x66, 0x66, 0x7C, 0x66, 0x66, 0xFC, 0x00 }, // U+0042
+	{ 0x3C, 0x66, 0xC0, 0xC0, 0xC0, 0x66, 0x3C, 0x00 }, // U+0043
+	{ 0xF8, 0x6C, 0x66, 0x66, 0x66, 0x6C, 0xF8, 0x00 }, // U+0044
+	{ 0xFE, 0x62, 0x68, 0x78, 0x68, 0x62, 0xFE, 0x00 }, // U+0045
+	{ 0xFE, 0x62, 0x68, 0x78, 0x68, 0x60, 0xF0, 0x00 }, // U+0046
+	{ 0x3C, 0x66, 0xC0, 0xC0, 0xCE, 0x66, 0x3E, 0x00 }, // U+0047
+	{ 0xCC, 0xCC, 0xCC, 0xFC, 0xCC, 0xCC, 0xCC, 0x00 }, // U+0048
+	{ 0x78, 0x30, 0x30, 0x30, 0x30, 0x30, 0x78, 0x00 }, // U+0049
+	{ 0x1E, 0x0C, 0x0C, 0x0C, 0xCC, 0xCC, 0x78, 0x00 }, // U+004A
+	{ 0xE6, 0x66, 0x6C, 0x78, 0x6C, 0x66, 0xE6, 0x00 }, // U+004B
+	{ 0xF0, 0x60, 0x60, 0x60, 0x62, 0x66, 0xFE, 0x00 }, // U+004C
+	{ 0xC6, 0xEE, 0xFE, 0xFE, 0xD6, 0xC6, 0xC6, 0x00 }, // U+004D
+	{ 0xC6, 0xE6, 0xF6, 0xDE, 0xCE, 0xC6, 0xC6, 0x00 }, // U+004E
+	{ 0x38, 0x6C, 0xC6, 0xC6, 0xC6, 0x6C, 0x38, 0x00 }, // U+004F
+	{ 0xFC, 0x66, 0x66, 0x7C, 0x60, 0x60, 0xF0, 0x00 }, // U+0050
+	{ 0x78, 0xCC, 0xCC, 0xCC, 0xDC, 0x78, 0x1C, 0x00 }, // U+0051
+	{ 0xFC, 0x66, 0x66, 0x7C, 0x6C, 0x66, 0xE6, 0x00 }, // U+0052
+	{ 0x78, 0xCC, 0xE0, 0x70, 0x1C, 0xCC, 0x78, 0x00 }, // U+0053
+	{ 0xFC, 0xB4, 0x30, 0x30, 0x30, 0x30, 0x78, 0x00 }, // U+0054
+	{ 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xFC, 0x00 }, // U+0055
+	{ 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0x78, 0x30, 0x00 }, // U+0056
+	{ 0xC6, 0xC6, 0xC6, 0xD6, 0xFE, 0xEE, 0xC6, 0x00 }, // U+0057
+	{ 0xC6, 0xC6, 0x6C, 0x38, 0x38, 0x6C, 0xC6, 0x00 }, // U+0058
+	{ 0xCC, 0xCC, 0xCC, 0x78, 0x30, 0x30, 0x78, 0x00 }, // U+0059
+	{ 0xFE, 0xC6, 0x8C, 0x18, 0x32, 0x66, 0xFE, 0x00 }, // U+005A
+	{ 0x78, 0x60, 0x60, 0x60, 0x60, 0x60, 0x78, 0x00 }, // U+005B
+	{ 0xC0, 0x60, 0x30, 0x18, 0x0C, 0x06, 0x02, 0x00 }, // U+005C
+	{ 0x78, 0x18, 0x18, 0x18, 0x18, 0x18, 0x78, 0x00 }, // U+005D
+	{ 0x10, 0x38, 0x6C, 0xC6, 0x00, 0x00, 0x00, 0x00 }, // U+005E
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF }, // U+005F
+	{ 0x30, 0x30, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+0060
+	{ 0x00, 0x00, 0x78, 0x0C, 0x7C, 0xCC, 0x76, 0x00 }, // U+0061
+	{ 0xE0, 0x60, 0x60, 0x7C, 0x66, 0x66, 0xDC, 0x00 }, // U+0062
+	{ 0x00, 0x00, 0x78, 0xCC, 0xC0, 0xCC, 0x78, 0x00 }, // U+0063
+	{ 0x1C, 0x0C, 0x0C, 0x7C, 0xCC, 0xCC, 0x76, 0x00 }, // U+0064
+	{ 0x00, 0x00, 0x78, 0xCC, 0xFC, 0xC0, 0x78, 0x00 }, // U+0065
+	{ 0x38, 0x6C, 0x60, 0xF0, 0x60, 0x60, 0xF0, 0x00 }, // U+0066
+	{ 0x00, 0x00, 0x76, 0xCC, 0xCC, 0x7C, 0x0C, 0xF8 }, // U+0067
+	{ 0xE0, 0x60, 0x6C, 0x76, 0x66, 0x66, 0xE6, 0x00 }, // U+0068
+	{ 0x30, 0x00, 0x70, 0x30, 0x30, 0x30, 0x78, 0x00 }, // U+0069
+	{ 0x0C, 0x00, 0x0C, 0x0C, 0x0C, 0xCC, 0xCC, 0x78 }, // U+006A
+	{ 0xE0, 0x60, 0x66, 0x6C, 0x78, 0x6C, 0xE6, 0x00 }, // U+006B
+	{ 0x70, 0x30, 0x30, 0x30, 0x30, 0x30, 0x78, 0x00 }, // U+006C
+	{ 0x00, 0x00, 0xCC, 0xFE, 0xFE, 0xD6, 0xC6, 0x00 }, // U+006D
+	{ 0x00, 0x00, 0xF8, 0xCC, 0xCC, 0xCC, 0xCC, 0x00 }, // U+006E
+	{ 0x00, 0x00, 0x78, 0xCC, 0xCC, 0xCC, 0x78, 0x00 }, // U+006F
+	{ 0x00, 0x00, 0xDC, 0x66, 0x66, 0x7C, 0x60, 0xF0 }, // U+0070
+	{ 0x00, 0x00, 0x76, 0xCC, 0xCC, 0x7C, 0x0C, 0x1E }, // U+0071
+	{ 0x00, 0x00, 0xDC, 0x76, 0x66, 0x60, 0xF0, 0x00 }, // U+0072
+	{ 0x00, 0x00, 0x7C, 0xC0, 0x78, 0x0C, 0xF8, 0x00 }, // U+0073
+	{ 0x10, 0x30, 0x7C, 0x30, 0x30, 0x34, 0x18, 0x00 }, // U+0074
+	{ 0x00, 0x00, 0xCC, 0xCC, 0xCC, 0xCC, 0x76, 0x00 }, // U+0075
+	{ 0x00, 0x00, 0xCC, 0xCC, 0xCC, 0x78, 0x30, 0x00 }, // U+0076
+	{ 0x00, 0x00, 0xC6, 0xD6, 0xFE, 0xFE, 0x6C, 0x00 }, // U+0077
+	{ 0x00, 0x00, 0xC6, 0x6C, 0x38, 0x6C, 0xC6, 0x00 }, // U+0078
+	{ 0x00, 0x00, 0xCC, 0xCC, 0xCC, 0x7C, 0x0C, 0xF8 }, // U+0079
+	{ 0x00, 0x00, 0xFC, 0x98, 0x30, 0x64, 0xFC, 0x00 }, // U+007A
+	{ 0x1C, 0x30, 0x30, 0xE0, 0x30, 0x30, 0x1C, 0x00 }, // U+007B
+	{ 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00 }, // U+007C
+	{ 0xE0, 0x30, 0x30, 0x1C, 0x30, 0x30, 0xE0, 0x00 }, // U+007D
+	{ 0x76, 0xDC, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+007E
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // U+007F
+};
+
+#endif /* MAIN_SSD1306_TABLES_H_ */
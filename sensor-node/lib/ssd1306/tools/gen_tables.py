@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+"""Generate ssd1306_tables.h from font8x8_basic.h.
+
+Run from the library directory after changing the font:
+
+    python3 tools/gen_tables.py > ssd1306_tables.h
+"""
+
+import os
+import re
+
+LIB_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+
+
+def read_font():
+    with open(os.path.join(LIB_DIR, "font8x8_basic.h")) as f:
+        source = f.read()
+    body = source[source.index("font8x8_basic_tr[128][8]"):]
+    rows = re.findall(r"\{([^{}]*)\}", body)
+    font = [[int(v, 16) for v in row.split(",")] for row in rows[:128]]
+    assert len(font) == 128 and all(len(glyph) == 8 for glyph in font)
+    return font
+
+
+def reverse(byte):
+    return int("{:08b}".format(byte)[::-1], 2)
+
+
+def expand_x3(byte):
+    # Every pixel becomes three pixels high: bit n goes to bits 3n..3n+2
+    out = 0
+    for bit in range(8):
+        if byte & (1 << bit):
+            out |= 0b111 << (bit * 3)
+    return [(out >> (8 * i)) & 0xFF for i in range(3)]
+
+
+def rotate(glyph):
+    # Same as ssd1306_rotate_image without flip
+    out = []
+    for i in range(8):
+        value = 0
+        for j in range(8):
+            if glyph[j] & (1 << i):
+                value |= 0x80 >> j
+        out.append(value)
+    return out
+
+
+def hex_row(values):
+    return ", ".join("0x{:02X}".format(v) for v in values)
+
+
+def glyph_table(name, comment, glyphs):
+    lines = ["// " + comment, "static const uint8_t {}[128][8] = {{".format(name)]
+    for code, glyph in enumerate(glyphs):
+        lines.append("\t{{ {} }}, // U+{:04X}".format(hex_row(glyph), code))
+    lines.append("};")
+    return lines
+
+
+def main():
+    font = read_font()
+    out = [
+        "// Generated by tools/gen_tables.py from font8x8_basic.h, do not edit.",
+        "",
+        "#ifndef MAIN_SSD1306_TABLES_H_",
+        "#define MAIN_SSD1306_TABLES_H_",
+        "",
+        "#include <stdint.h>",
+        "",
+        "// Bit order of every byte reversed, used to flip upside down",
+        "static const uint8_t ssd1306_reverse_table[256] = {",
+    ]
+    for row in range(0, 256, 16):
+        out.append("\t{},".format(hex_row(reverse(b) for b in range(row, row + 16))))
+    out += ["};", "", "// Column byte scaled to 3x height, one byte per page from top to bottom",
+            "static const uint8_t ssd1306_x3_table[256][3] = {"]
+    for row in range(0, 256, 4):
+        out.append("\t" + " ".join("{{ {} }},".format(hex_row(expand_x3(b))) for b in range(row, row + 4)))
+    out += ["};", ""]
+    out += glyph_table("font8x8_basic_flip", "font8x8_basic_tr flipped upside down",
+                       [[reverse(b) for b in glyph] for glyph in font])
+    out.append("")
+    out += glyph_table("font8x8_basic_rot", "font8x8_basic_tr rotated for ssd1306_display_rotate_text",
+                       [rotate(glyph) for glyph in font])
+    out += ["", "#endif /* MAIN_SSD1306_TABLES_H_ */"]
+    print("\n".join(out))
+
+
+if __name__ == "__main__":
+    main()
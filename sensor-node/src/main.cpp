@@ -105,14 +105,32 @@ extern "C" void app_main(void)
 #include "esp_adc_cal.h"
 #include "esp_sleep.h"
 #include "esp_timer.h"
+#include "esp_attr.h"
+#include "esp_rom_crc.h"
+#include "esp32/ulp.h"
+#include "ulp_main.h"
+#include "ulp_policy.h"
+#include "mesh_wire.h"
+#include "ssd1306.h"
 
 #define LED_GPIO GPIO_NUM_2
-
-typedef struct __attribute__((packed)) {
-    uint8_t id[16];
-    uint16_t moisture;
-    uint16_t version;
-} sensor_node_message;
+#define CONFIG_LAYOUT_VERSION 2
+#define ULP_SAMPLE_PERIOD_S 10
+#define ULP_WAKE_DELTA 200 // Raw ADC counts
+#define ULP_FALLBACK_INTERVALS 3 // Timer wake if the ULP missed this many report intervals, e.g. after a hang
+#define BATTERY_ADC_CHANNEL ADC1_CHANNEL_7 // GPIO35
+#define BATTERY_DIVIDER 2 // Supply is measured through a 1:1 resistor divider
+#define TELEMETRY_EVERY_N_WAKES 6
+#define MAX_SEND_ATTEMPTS 3
+#define CONFIG_READ_ATTEMPTS 3
+#define STATUS_DISPLAY 1 // Show moisture, link quality and config version on an SSD1306
+#define DISPLAY_SDA_GPIO GPIO_NUM_21
+#define DISPLAY_SCL_GPIO GPIO_NUM_22
+#define DISPLAY_WIDTH 128
+#define DISPLAY_HEIGHT 64
+
+extern const uint8_t ulp_main_bin_start[] asm("_binary_ulp_main_bin_start");
+extern const uint8_t ulp_main_bin_end[] asm("_binary_ulp_main_bin_end");
 
 typedef struct __attribute__((packed)) {
     uint8_t id[16];
@@ -132,10 +150,76 @@ node_config config = {
     led_state: 0,
 };
 
+// Whole config is stored as one blob, CRC covers everything before the crc field
+typedef struct __attribute__((packed)) {
+    uint8_t layout;
+    node_config config;
+    uint16_t node_index;
+    uint32_t crc;
+} stored_config;
+
+// Layout 1 had no node index
+#define CONFIG_LAYOUT_V1_SIZE (1 + sizeof(node_config) + sizeof(uint32_t))
+
+// What load_config found. Only CONFIG_NOT_FOUND gives the node a new uuid, on anything
+// else a new one would enroll it a second time and orphan its readings.
+typedef enum {
+    CONFIG_LOADED,
+    CONFIG_NOT_FOUND,  // Nothing stored, first boot
+    CONFIG_UNREADABLE, // NVS failed or the blob is damaged, and there was no copy of the uuid
+} config_status;
+
+// Short address assigned by the master, 0 until the node is enrolled
+uint16_t node_index = 0;
+
+// Mirror of the last committed config, survives deep sleep so warm wakes skip NVS
+RTC_DATA_ATTR stored_config rtc_config;
+
+// Moisture sent in the last uplink, the ULP wakes us when the reading moves away from it
+uint16_t reported_moisture = 0;
+
+// Uplink of this wake, kept for resending
+uint8_t uplink_frame[MESH_WIRE_MAX_FRAME_SIZE];
+size_t uplink_frame_len = 0;
+uint8_t send_attempts = 0;
+bool send_delivered = false;
+uint32_t config_rtt_ms = 0;
+
+// Wake cost telemetry, always about the previous wake since the current one is not over yet
+RTC_DATA_ATTR uint32_t wake_count = 0;
+RTC_DATA_ATTR uint32_t last_wake_ms = 0;
+RTC_DATA_ATTR uint8_t last_send_attempts = 0;
+RTC_DATA_ATTR uint32_t last_config_rtt_ms = 0;
+// 0 if the last uplink was not delivered, MAX_SEND_ATTEMPTS if it went through on the first attempt
+RTC_DATA_ATTR uint8_t last_link_quality = 0;
+
+// What the status screen shows. The panel keeps its RAM through deep sleep, so a
+// wake only sends the lines that changed and leaves the bus alone otherwise.
+typedef struct {
+    bool initialized;
+    uint16_t moisture;
+    uint8_t link_quality;
+    uint16_t version;
+} status_screen_state;
+
+RTC_DATA_ATTR status_screen_state status_screen = {};
+SSD1306_t display;
+bool is_display_on = false;
+
 static esp_adc_cal_characteristics_t adc1_chars;
 extern "C" void zh_network_event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data);
-void write_config(node_config new_config);
+config_status load_config();
+config_status read_config();
+esp_err_t read_legacy_config(nvs_handle_t nvs_handle);
+void erase_legacy_config();
+bool is_config_valid(const stored_config *stored);
+bool write_config(node_config new_config);
+void start_ulp_sampling(uint16_t interval);
+void enter_deep_sleep(uint16_t interval);
 void uuid_generate(uint8_t out[16]);
+void status_screen_update(uint16_t moisture, uint8_t link_quality, uint16_t version);
+void status_screen_line(int page, const char *text);
+void status_screen_sleep();
 
 extern "C" void app_main(void)
 {
@@ -157,33 +241,14 @@ extern "C" void app_main(void)
     esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_12, ADC_WIDTH_BIT_12, 0, &adc1_chars);
     adc1_config_width(ADC_WIDTH_BIT_12);
     adc1_config_channel_atten(ADC1_CHANNEL_4, ADC_ATTEN_DB_12);
+    adc1_config_channel_atten(BATTERY_ADC_CHANNEL, ADC_ATTEN_DB_12);
 
     gpio_reset_pin(LED_GPIO);
     gpio_set_direction(LED_GPIO, GPIO_MODE_OUTPUT);
 
     // --- READ CONFIG FROM ONBOARD MEMORY ---
-    nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open("config", NVS_READONLY, &nvs_handle);
-    if (err == ESP_OK) {
-        uint8_t stored_id[16];
-        uint16_t stored_version;
-        uint32_t stored_interval;
-        uint8_t stored_led_state;
-
-        size_t required_id_size = sizeof(config.id);
-
-        if (nvs_get_blob(nvs_handle, "id", stored_id, &required_id_size) == ESP_OK &&
-            nvs_get_u16(nvs_handle, "version", &stored_version) == ESP_OK &&
-            nvs_get_u32(nvs_handle, "interval", &stored_interval) == ESP_OK &&
-            nvs_get_u8(nvs_handle, "led_state", &stored_led_state) == ESP_OK) {
-
-            memcpy(config.id, &stored_id, sizeof(stored_id));
-            config.version = stored_version;
-            config.interval = stored_interval;
-            config.led_state = stored_led_state;
-        }
-        nvs_close(nvs_handle);
-    } else if (err == ESP_ERR_NVS_NOT_FOUND) {
+    config_status status = load_config();
+    if (status == CONFIG_NOT_FOUND) {
         printf("Config not found, creating default config...\n");
 
         uint8_t device_uuid[16];
@@ -191,39 +256,67 @@ extern "C" void app_main(void)
         memcpy(config.id, &device_uuid, sizeof(device_uuid));
 
         write_config(config);
-    } else {
-        printf("ERROR: nvs_open FAILED\n");
+    } else if (status == CONFIG_UNREADABLE) {
+        // Stored config is left as it is, try again on the next wake
+        printf("Config unreadable, sleeping...\n");
+        esp_sleep_enable_timer_wakeup((uint64_t)config.interval * 1000000);
+        esp_deep_sleep_start();
     }
 
-    sensor_node_message message = {
-        id: "",
-        moisture: 0,
-        version: 0
-    };
-
-    // Assign message parameters from config
-    memcpy(message.id, &config.id, sizeof(config.id));
-    message.version = config.version;
-
+    printf("NODE INDEX: \t%d\n", node_index);
     printf("VERSION: \t%d\n", config.version);
     printf("INTERVAL: \t%d\n", config.interval);
 
-    message.moisture = adc1_get_raw(ADC1_CHANNEL_4);
-    printf("MOISTURE: \t%d\n", message.moisture);
+    uint16_t moisture;
+    if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_ULP) {
+        // ULP already sampled the sensor, no need to touch the ADC again
+        moisture = ulp_last_result & UINT16_MAX;
+        printf("ULP WAKE: \t%lu (min %lu, max %lu, avg %lu)\n", ulp_wake_reason & UINT16_MAX,
+            ulp_min_value & UINT16_MAX, ulp_max_value & UINT16_MAX, ulp_average & UINT16_MAX);
+    } else {
+        ESP_ERROR_CHECK(ulp_load_binary(0, ulp_main_bin_start, (ulp_main_bin_end - ulp_main_bin_start) / sizeof(uint32_t)));
+        moisture = adc1_get_raw(ADC1_CHANNEL_4);
+    }
+    reported_moisture = moisture;
+    printf("MOISTURE: \t%d\n", moisture);
+
+    mesh_wire_frame_t message;
+    mesh_wire_init(&message, MESH_WIRE_MSG_READING);
+    // The uuid only goes on air until the master assigned us a node index
+    message.node_index = node_index;
+    memcpy(message.uuid, config.id, sizeof(config.id));
+    mesh_wire_set(&message, MESH_WIRE_FIELD_MOISTURE, moisture);
+    mesh_wire_set(&message, MESH_WIRE_FIELD_VERSION, config.version);
+
+    if (wake_count++ % TELEMETRY_EVERY_N_WAKES == 0) {
+        uint32_t battery_mv = esp_adc_cal_raw_to_voltage(adc1_get_raw(BATTERY_ADC_CHANNEL), &adc1_chars) * BATTERY_DIVIDER;
+        printf("BATTERY: \t%lu mV\n", battery_mv);
+        mesh_wire_set(&message, MESH_WIRE_FIELD_BATTERY_MV, battery_mv);
+        mesh_wire_set(&message, MESH_WIRE_FIELD_WAKE_MS, last_wake_ms);
+        mesh_wire_set(&message, MESH_WIRE_FIELD_SEND_ATTEMPTS, last_send_attempts);
+        mesh_wire_set(&message, MESH_WIRE_FIELD_CONFIG_RTT_MS, last_config_rtt_ms);
+    }
+
+    uplink_frame_len = mesh_wire_encode(&message, uplink_frame, sizeof(uplink_frame));
+
+#if STATUS_DISPLAY
+    status_screen_update(moisture, last_link_quality, config.version);
+#endif
 
     gpio_set_level(LED_GPIO, config.led_state);
     printf("LED: \t\t%d\n", config.led_state);
 
     start = esp_timer_get_time();
-    zh_network_send(NULL, (uint8_t *)&message, sizeof(message));
+    printf("BOOT TO SEND: \t%lld us\n", start);
+    send_attempts = 1;
+    zh_network_send(NULL, uplink_frame, uplink_frame_len);
 
     // TODO: Add config response wait time to config (default 500ms)
     vTaskDelay(500 / portTICK_PERIOD_MS); // 500 (ms)
 
     printf("------------------------------------\n");
     if(!is_processing_api_response) {
-        esp_sleep_enable_timer_wakeup(config.interval * 1000000);
-        esp_deep_sleep_start();
+        enter_deep_sleep(config.interval);
     }
 }
 
@@ -233,58 +326,229 @@ extern "C" void zh_network_event_handler(void *arg, esp_event_base_t event_base,
     {
         zh_network_event_on_recv_t *recv_data = (zh_network_event_on_recv_t *)event_data;
 
-        if (recv_data->data_len != sizeof(node_config)) {
-            printf("Invalid data size: expected %zu bytes, got %zu bytes\n", 
-                sizeof(node_config), recv_data->data_len);
-            heap_caps_free(recv_data->data);
+        mesh_wire_frame_t frame;
+        bool is_valid = mesh_wire_decode(&frame, recv_data->data, recv_data->data_len);
+        heap_caps_free(recv_data->data); // Do not delete to avoid memory leaks!
+
+        // Readings of other sensors are flooded through the mesh as well
+        if (!is_valid) {
+            return;
+        }
+
+        bool is_for_us = frame.node_index != 0
+            ? frame.node_index == node_index
+            : memcmp(config.id, frame.uuid, 16) == 0;
+        if (!is_for_us) {
+            return;
+        }
+
+        if (frame.type == MESH_WIRE_MSG_ENROLL) {
+            node_index = mesh_wire_get(&frame, MESH_WIRE_FIELD_NODE_INDEX, 0);
+            printf("ENROLLED - Node index: %d\n", node_index);
+            write_config(config);
+            return;
+        }
+
+        if (frame.type == MESH_WIRE_MSG_REENROLL) {
+            // Master doesn't know our index (e.g. its flash was erased), send the reading again with the uuid
+            printf("INDEX %d UNKNOWN TO MASTER, ENROLLING AGAIN\n", node_index);
+            node_index = 0;
+            write_config(config);
+
+            mesh_wire_frame_t message;
+            if (mesh_wire_decode(&message, uplink_frame, uplink_frame_len)) {
+                message.node_index = 0;
+                memcpy(message.uuid, config.id, sizeof(config.id));
+                uplink_frame_len = mesh_wire_encode(&message, uplink_frame, sizeof(uplink_frame));
+                zh_network_send(NULL, uplink_frame, uplink_frame_len);
+            }
+            return;
+        }
+
+        if (frame.type != MESH_WIRE_MSG_CONFIG) {
             return;
         }
 
         is_processing_api_response = true;
 
-        node_config *recv_message = (node_config *)recv_data->data;
-        printf("NEW CONFIG RECEIVED - Version: %d, Interval: %d\n", recv_message->version, recv_message->interval);
+        node_config recv_config = config;
+        recv_config.version = mesh_wire_get(&frame, MESH_WIRE_FIELD_VERSION, config.version);
+        recv_config.interval = mesh_wire_get(&frame, MESH_WIRE_FIELD_INTERVAL, config.interval);
+        recv_config.led_state = mesh_wire_get(&frame, MESH_WIRE_FIELD_LED_STATE, config.led_state);
+
+        printf("NEW CONFIG RECEIVED - Version: %d, Interval: %d\n", recv_config.version, recv_config.interval);
         int64_t end = esp_timer_get_time();
         int64_t duration = end - start;
         printf("Api config response came in %lld microseconds\n", duration);
+        config_rtt_ms = duration / 1000;
 
-        printf("OLD ID: \t%s\n", config.id);
-        printf("NEW ID: \t%s\n", recv_message->id);
-
-        if (memcmp(config.id, recv_message->id, 16) == 0) {
-            printf("IDs are identical\n");
-            if(config.version != recv_message->version) {
-                write_config(*recv_message);
-            } else {
-                printf("Config versions are the same\n");
-            }
+        if(config.version != recv_config.version) {
+            write_config(recv_config);
         } else {
-            printf("IDs are different\n");
+            printf("Config versions are the same\n");
         }
 
         // TODO: Send acknowledgement response to api of success or error
 
-        esp_sleep_enable_timer_wakeup(recv_message->interval * 1000000);
-        heap_caps_free(recv_data->data); // Do not delete to avoid memory leaks!
-        esp_deep_sleep_start();
+        enter_deep_sleep(recv_config.interval);
+    } else if (event_id == ZH_NETWORK_ON_SEND_EVENT) {
+        zh_network_event_on_send_t *send_data = (zh_network_event_on_send_t *)event_data;
+        if (send_data->status == ZH_NETWORK_SEND_SUCCESS) {
+            send_delivered = true;
+        } else if (send_attempts < MAX_SEND_ATTEMPTS) {
+            send_attempts++;
+            printf("Send failed, attempt %d\n", send_attempts);
+            zh_network_send(NULL, uplink_frame, uplink_frame_len);
+        }
     }
 }
 
-void write_config(node_config new_config) {
+config_status load_config() {
+    // Warm wake from deep sleep, RTC memory still holds the committed config
+    if (esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_UNDEFINED && is_config_valid(&rtc_config)) {
+        config = rtc_config.config;
+        node_index = rtc_config.node_index;
+        return CONFIG_LOADED;
+    }
+
+    config_status status = read_config();
+    for (int attempt = 1; attempt < CONFIG_READ_ATTEMPTS && status == CONFIG_UNREADABLE; attempt++) {
+        vTaskDelay(10 / portTICK_PERIOD_MS);
+        status = read_config();
+    }
+    if (status == CONFIG_UNREADABLE && is_config_valid(&rtc_config)) {
+        // RTC memory survives a reset, its copy still has our uuid
+        printf("Config unreadable, using the copy in RTC memory\n");
+        config = rtc_config.config;
+        node_index = rtc_config.node_index;
+        return CONFIG_LOADED;
+    }
+    return status;
+}
+
+config_status read_config() {
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open("config", NVS_READONLY, &nvs_handle);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        return CONFIG_NOT_FOUND;
+    } else if (err != ESP_OK) {
+        printf("ERROR: nvs_open FAILED\n");
+        return CONFIG_UNREADABLE;
+    }
+
+    stored_config stored;
+    size_t stored_size = sizeof(stored);
+
+    esp_err_t err_read = nvs_get_blob(nvs_handle, "node_config", &stored, &stored_size);
+
+    if (err_read == ESP_OK && stored_size == sizeof(stored) && is_config_valid(&stored)) {
+        config = stored.config;
+        node_index = stored.node_index;
+        rtc_config = stored;
+        nvs_close(nvs_handle);
+        return CONFIG_LOADED;
+    } else if (err_read == ESP_OK && stored_size == CONFIG_LAYOUT_V1_SIZE && stored.layout == 1) {
+        // Blob written before node indexes existed, keep the config and enroll again
+        const uint8_t *stored_v1 = (const uint8_t *)&stored;
+        uint32_t crc;
+        memcpy(&crc, &stored_v1[1 + sizeof(node_config)], sizeof(crc));
+        if (crc == esp_rom_crc32_le(0, stored_v1, 1 + sizeof(node_config))) {
+            printf("Migrating config layout 1...\n");
+            config = stored.config;
+            nvs_close(nvs_handle);
+            if (write_config(config)) {
+                erase_legacy_config();
+            }
+            return CONFIG_LOADED;
+        }
+    }
+
+    // Config written by older firmware as separate keys, move it into the blob
+    esp_err_t err_legacy = read_legacy_config(nvs_handle);
+    nvs_close(nvs_handle);
+    if (err_legacy == ESP_OK) {
+        printf("Migrating legacy config...\n");
+        if (write_config(config)) {
+            erase_legacy_config();
+        }
+        return CONFIG_LOADED;
+    }
+    if (err_read == ESP_ERR_NVS_NOT_FOUND && err_legacy == ESP_ERR_NVS_NOT_FOUND) {
+        return CONFIG_NOT_FOUND;
+    }
+    printf("ERROR: stored config unreadable\n");
+    return CONFIG_UNREADABLE;
+}
+
+// ESP_ERR_NVS_NOT_FOUND only if no uuid was stored, the other keys fall back to the defaults
+esp_err_t read_legacy_config(nvs_handle_t nvs_handle) {
+    uint8_t stored_id[16];
+    uint16_t stored_version;
+    uint32_t stored_interval;
+    uint8_t stored_led_state;
+
+    size_t required_id_size = sizeof(config.id);
+    esp_err_t err = nvs_get_blob(nvs_handle, "id", stored_id, &required_id_size);
+    if (err != ESP_OK) {
+        return err;
+    }
+    memcpy(config.id, &stored_id, sizeof(stored_id));
+
+    if (nvs_get_u16(nvs_handle, "version", &stored_version) == ESP_OK &&
+        nvs_get_u32(nvs_handle, "interval", &stored_interval) == ESP_OK &&
+        nvs_get_u8(nvs_handle, "led_state", &stored_led_state) == ESP_OK) {
+        config.version = stored_version;
+        config.interval = stored_interval;
+        config.led_state = stored_led_state;
+    } else {
+        // Version 0 makes the master send its config again
+        config.version = 0;
+    }
+    return ESP_OK;
+}
+
+// Only once the blob is committed, until then the keys are the only copy of the uuid
+void erase_legacy_config() {
+    nvs_handle_t nvs_handle;
+    if (nvs_open("config", NVS_READWRITE, &nvs_handle) != ESP_OK) {
+        return;
+    }
+    const char *keys[] = { "id", "version", "interval", "led_state" };
+    for (const char *key : keys) {
+        nvs_erase_key(nvs_handle, key);
+    }
+    if (nvs_commit(nvs_handle) != ESP_OK) {
+        printf("Failed to erase legacy config\n");
+    }
+    nvs_close(nvs_handle);
+}
+
+bool is_config_valid(const stored_config *stored) {
+    return stored->layout == CONFIG_LAYOUT_VERSION &&
+        stored->crc == esp_rom_crc32_le(0, (const uint8_t *)stored, offsetof(stored_config, crc));
+}
+
+// True once the config is committed
+bool write_config(node_config new_config) {
+    stored_config stored;
+    stored.layout = CONFIG_LAYOUT_VERSION;
+    stored.config = new_config;
+    stored.node_index = node_index;
+    stored.crc = esp_rom_crc32_le(0, (const uint8_t *)&stored, offsetof(stored_config, crc));
+
     nvs_handle_t nvs_handle;
     esp_err_t err = nvs_open("config", NVS_READWRITE, &nvs_handle);
+    bool committed = false;
 
     if (err == ESP_OK) {
-        esp_err_t err_write = 
-            nvs_set_blob(nvs_handle, "id", new_config.id, sizeof(new_config.id)) |
-            nvs_set_u16(nvs_handle, "version", new_config.version) |
-            nvs_set_u32(nvs_handle, "interval", new_config.interval) |
-            nvs_set_u8(nvs_handle, "led_state", new_config.led_state);
+        esp_err_t err_write = nvs_set_blob(nvs_handle, "node_config", &stored, sizeof(stored));
 
         if (err_write == ESP_OK) {
             // Commit written value
             err = nvs_commit(nvs_handle);
             if (err == ESP_OK) {
+                rtc_config = stored;
+                committed = true;
                 printf("Config committed successfully\n");
             } else {
                 printf("Failed to commit config\n");
@@ -296,12 +560,49 @@ void write_config(node_config new_config) {
     } else {
         printf("Failed to open NVS in write mode\n");
     }
+    return committed;
+}
+
+void start_ulp_sampling(uint16_t interval) {
+    ulp_policy_state_t state;
+    ulp_policy_reset(&state, reported_moisture, ULP_WAKE_DELTA, ulp_policy_report_samples(interval, ULP_SAMPLE_PERIOD_S));
+
+    ulp_last_result = state.last_result;
+    ulp_min_value = state.min_value;
+    ulp_max_value = state.max_value;
+    ulp_average = state.average;
+    ulp_report_value = state.report_value;
+    ulp_wake_delta = state.wake_delta;
+    ulp_samples_until_report = state.samples_until_report;
+    ulp_wake_reason = state.wake_reason;
+
+    // Hand the ADC over to the ULP for the time we are asleep
+    adc1_ulp_enable();
+    ulp_set_wakeup_period(0, ULP_SAMPLE_PERIOD_S * 1000000);
+    ESP_ERROR_CHECK(ulp_run(&ulp_entry - RTC_SLOW_MEM));
+}
+
+void enter_deep_sleep(uint16_t interval) {
+    last_wake_ms = esp_timer_get_time() / 1000;
+    last_send_attempts = send_attempts;
+    last_config_rtt_ms = config_rtt_ms;
+    last_link_quality = send_delivered ? MAX_SEND_ATTEMPTS + 1 - send_attempts : 0;
+
+#if STATUS_DISPLAY
+    status_screen_sleep();
+#endif
+    start_ulp_sampling(interval);
+    esp_sleep_enable_ulp_wakeup();
+    // A timer wake reloads the ULP program and reads the ADC itself
+    uint64_t fallback_s = (uint64_t)(interval > ULP_SAMPLE_PERIOD_S ? interval : ULP_SAMPLE_PERIOD_S) * ULP_FALLBACK_INTERVALS;
+    esp_sleep_enable_timer_wakeup(fallback_s * 1000000);
+    esp_deep_sleep_start();
 }
 
 // https://github.com/typester/esp32-uuid/blob/master/uuid.c
 void uuid_generate(uint8_t out[16])
 {
-    esp_fill_random(out, sizeof(uint8_t));
+    esp_fill_random(out, 16);
 
     /* uuid version */
     out[6] = 0x40 | (out[6] & 0xF);
@@ -309,3 +610,73 @@ void uuid_generate(uint8_t out[16])
     /* uuid variant */
     out[8] = (0x80 | out[8]) & ~0x40;
 }
+
+// Redraw the lines of the status screen whose value changed and switch the panel on
+// for the rest of the wake. Nothing goes over the bus when nothing changed.
+void status_screen_update(uint16_t moisture, uint8_t link_quality, uint16_t version) {
+    // RTC memory also survives resets, but only a deep sleep wake guarantees the panel was set up by us
+    if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_UNDEFINED) {
+        status_screen.initialized = false;
+    }
+    bool moisture_changed = !status_screen.initialized || status_screen.moisture != moisture;
+    bool link_changed = !status_screen.initialized || status_screen.link_quality != link_quality;
+    bool version_changed = !status_screen.initialized || status_screen.version != version;
+    if (!moisture_changed && !link_changed && !version_changed) {
+        return;
+    }
+
+    i2c_master_init(&display, DISPLAY_SDA_GPIO, DISPLAY_SCL_GPIO, -1);
+    if (status_screen.initialized) {
+        // Panel is configured and still holds the other lines, it was only switched off
+        ssd1306_resume(&display, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    } else {
+        ssd1306_init(&display, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    }
+
+    char text[17];
+    if (moisture_changed) {
+        snprintf(text, sizeof(text), "Moisture: %u", moisture);
+        status_screen_line(0, text);
+    }
+    if (link_changed) {
+        if (link_quality == 0) {
+            snprintf(text, sizeof(text), "Link: lost");
+        } else {
+            snprintf(text, sizeof(text), "Link: %u/%u", link_quality, MAX_SEND_ATTEMPTS);
+        }
+        status_screen_line(2, text);
+    }
+    if (version_changed) {
+        snprintf(text, sizeof(text), "Config: v%u", version);
+        status_screen_line(4, text);
+    }
+
+    if (status_screen.initialized) {
+        ssd1306_flush(&display);
+        ssd1306_display_on(&display, true);
+    } else {
+        // Panel RAM is random after power up, send the whole frame once
+        ssd1306_show_buffer(&display);
+    }
+    is_display_on = true;
+
+    status_screen.initialized = true;
+    status_screen.moisture = moisture;
+    status_screen.link_quality = link_quality;
+    status_screen.version = version;
+}
+
+// Render a line padded to the full width, the buffer does not know what the panel showed before
+void status_screen_line(int page, const char *text) {
+    char line[16];
+    memset(line, ' ', sizeof(line));
+    memcpy(line, text, strnlen(text, sizeof(line)));
+    _ssd1306_display_text(&display, page, line, sizeof(line), false);
+}
+
+void status_screen_sleep() {
+    if (is_display_on) {
+        ssd1306_display_on(&display, false);
+        is_display_on = false;
+    }
+}
@@ -0,0 +1,51 @@
+#include "ulp_policy.h"
+
+void ulp_policy_reset(ulp_policy_state_t *state, uint16_t report_value, uint16_t wake_delta, uint16_t report_samples)
+{
+    state->last_result = report_value;
+    state->min_value = UINT16_MAX;
+    state->max_value = 0;
+    state->average = report_value;
+    state->report_value = report_value;
+    state->wake_delta = wake_delta;
+    state->samples_until_report = report_samples;
+    state->wake_reason = ULP_WAKE_NONE;
+}
+
+ulp_wake_reason_t ulp_policy_step(ulp_policy_state_t *state, uint16_t sample)
+{
+    state->last_result = sample;
+
+    if (sample < state->min_value) state->min_value = sample;
+    if (sample > state->max_value) state->max_value = sample;
+
+    if (sample >= state->average) {
+        state->average += (sample - state->average) >> 3;
+    } else {
+        state->average -= (state->average - sample) >> 3;
+    }
+
+    uint16_t diff = sample >= state->report_value ? sample - state->report_value : state->report_value - sample;
+    if (diff > state->wake_delta) {
+        state->wake_reason = ULP_WAKE_THRESHOLD;
+        return ULP_WAKE_THRESHOLD;
+    }
+
+    // Countdown stays at zero until the main core resets it, so a wake that
+    // could not be delivered is retried on the next sample
+    if (state->samples_until_report != 0) state->samples_until_report--;
+    if (state->samples_until_report == 0) {
+        state->wake_reason = ULP_WAKE_REPORT;
+        return ULP_WAKE_REPORT;
+    }
+
+    return ULP_WAKE_NONE;
+}
+
+uint16_t ulp_policy_report_samples(uint32_t interval_s, uint32_t sample_period_s)
+{
+    uint32_t samples = interval_s / sample_period_s;
+    if (samples == 0) samples = 1;
+    if (samples > UINT16_MAX) samples = UINT16_MAX;
+    return samples;
+}
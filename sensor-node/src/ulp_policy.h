@@ -0,0 +1,41 @@
+#ifndef ULP_POLICY_H_
+#define ULP_POLICY_H_
+
+#include <stdint.h>
+
+// Reference model of the wake decision made by ulp/moisture.S.
+// Plain C without ESP-IDF dependencies so it can be built and checked on a host.
+// Any change here has to be mirrored in the ULP program and the other way around.
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef enum {
+    ULP_WAKE_NONE = 0,
+    ULP_WAKE_THRESHOLD = 1, // Moisture moved more than wake_delta away from the last report
+    ULP_WAKE_REPORT = 2     // Report interval has elapsed
+} ulp_wake_reason_t;
+
+// Same fields, order and width as the variables in RTC memory used by the ULP program
+typedef struct {
+    uint16_t last_result;
+    uint16_t min_value;
+    uint16_t max_value;
+    uint16_t average;              // Exponential moving average, 1/8 weight per sample
+    uint16_t report_value;         // Moisture sent in the last uplink
+    uint16_t wake_delta;
+    uint16_t samples_until_report;
+    uint16_t wake_reason;
+} ulp_policy_state_t;
+
+void ulp_policy_reset(ulp_policy_state_t *state, uint16_t report_value, uint16_t wake_delta, uint16_t report_samples);
+ulp_wake_reason_t ulp_policy_step(ulp_policy_state_t *state, uint16_t sample);
+uint16_t ulp_policy_report_samples(uint32_t interval_s, uint32_t sample_period_s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ULP_POLICY_H_ */
@@ -0,0 +1,180 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ssd1306.h"
+
+// The transposing blit of _ssd1306_bitmaps and ssd1306_rotate_image, checked against one pixel at a time
+
+#define PAGES 8
+
+static SSD1306_t dev;
+static uint8_t bitmap[16 * 64 + 8]; // Room to start a bitmap at any of the first 8 bytes
+static uint32_t seed;
+
+static uint32_t random_number(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+}
+
+// Buffer bit of pixel x, y, flipped pages hold their rows in reverse bit order
+static uint8_t pixel_mask(int y)
+{
+    return dev._flip ? 0x80 >> (y % 8) : 1 << (y % 8);
+}
+
+// Writes every covered pixel, set or not, the way the blit overwrites its area
+static void reference_bitmaps(uint8_t segs[PAGES][128], int xpos, int ypos, const uint8_t *bits, int width, int height, bool invert)
+{
+    for (int row = 0; row < height; row++) {
+        int y = ypos + row;
+        if (y >= PAGES * 8) continue;
+        for (int column = 0; column < width; column++) {
+            int x = xpos + column;
+            if (x < 0 || x >= 128) continue;
+            bool on = (bits[row * (width / 8) + column / 8] >> (7 - column % 8)) & 1;
+            if (invert) on = !on;
+            uint8_t *seg = &segs[y / 8][x];
+            *seg = on ? *seg | pixel_mask(y) : *seg & ~pixel_mask(y);
+        }
+    }
+}
+
+void setUp(void)
+{
+    seed = 1;
+    memset(&dev, 0, sizeof(dev));
+    memory_init(&dev);
+    ssd1306_init(&dev, 128, 64);
+    // Most random bitmaps are clipped, each would log a warning
+    esp_log_level_set("*", ESP_LOG_ERROR);
+    for (size_t i = 0; i < sizeof(bitmap); i++) bitmap[i] = random_number();
+}
+
+void tearDown(void)
+{
+    esp_log_level_set("*", ESP_LOG_WARN);
+    free(dev._out_buf);
+    free(dev._transport_data);
+}
+
+static void test_random_bitmaps_match_the_reference(void)
+{
+    uint8_t expected[PAGES][128];
+    for (int n = 0; n < 4000; n++) {
+        dev._flip = n & 1;
+        int width = 8 * (1 + random_number() % 16);
+        int height = 1 + random_number() % 64;
+        int x = (int)(random_number() % 160) - 16;
+        int y = random_number() % 64;
+        const uint8_t *bits = bitmap + random_number() % 8;
+        bool invert = random_number() & 1;
+
+        for (int page = 0; page < PAGES; page++) {
+            memcpy(expected[page], dev._page[page]._segs, 128);
+            dev._page[page]._dirtyStart = -1;
+            dev._page[page]._dirtyEnd = -1;
+        }
+        reference_bitmaps(expected, x, y, bits, width, height, invert);
+        _ssd1306_bitmaps(&dev, x, y, bits, width, height, invert);
+
+        int first = x < 0 ? 0 : x;
+        int last = x + width - 1 > 127 ? 127 : x + width - 1;
+        for (int page = 0; page < PAGES; page++) {
+            char message[64];
+            snprintf(message, sizeof(message), "bitmap %d page %d", n, page);
+            TEST_ASSERT_EQUAL_HEX8_ARRAY_MESSAGE(expected[page], dev._page[page]._segs, 128, message);
+            // Every page the bitmap covers has to be sent
+            bool covered = page >= y / 8 && page <= (y + height - 1) / 8 && first <= last;
+            if (covered) {
+                TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(first, dev._page[page]._dirtyStart, message);
+                TEST_ASSERT_GREATER_OR_EQUAL_MESSAGE(last, dev._page[page]._dirtyEnd, message);
+                TEST_ASSERT_GREATER_OR_EQUAL_MESSAGE(0, dev._page[page]._dirtyStart, message);
+            }
+        }
+    }
+}
+
+static void test_width_must_be_a_multiple_of_8(void)
+{
+    _ssd1306_bitmaps(&dev, 0, 0, bitmap, 12, 8, false);
+    for (int page = 0; page < PAGES; page++) {
+        TEST_ASSERT_EACH_EQUAL_HEX8(0, dev._page[page]._segs, 128);
+    }
+}
+
+static void test_pixel_sets_one_bit(void)
+{
+    for (int flip = 0; flip < 2; flip++) {
+        dev._flip = flip;
+        for (int y = 0; y < 64; y++) {
+            int x = (y * 37) % 128;
+            uint8_t before = dev._page[y / 8]._segs[x];
+            _ssd1306_pixel(&dev, x, y, false);
+            TEST_ASSERT_EQUAL_HEX8(before | pixel_mask(y), dev._page[y / 8]._segs[x]);
+            _ssd1306_pixel(&dev, x, y, true);
+            TEST_ASSERT_EQUAL_HEX8(before & ~pixel_mask(y), dev._page[y / 8]._segs[x]);
+        }
+    }
+}
+
+static void test_rotate_image(void)
+{
+    for (int n = 0; n < 1000; n++) {
+        bool flip = n & 1;
+        uint8_t image[8], rotated[8];
+        for (int i = 0; i < 8; i++) image[i] = random_number();
+        memcpy(rotated, image, 8);
+        ssd1306_rotate_image(rotated, flip);
+        // Column i of the image, with its top row in bit 7, or in bit 0 when flipped
+        for (int column = 0; column < 8; column++) {
+            uint8_t expected = 0;
+            for (int row = 0; row < 8; row++) {
+                if ((image[row] >> column) & 1) expected |= flip ? 1 << row : 0x80 >> row;
+            }
+            TEST_ASSERT_EQUAL_HEX8(expected, rotated[column]);
+        }
+    }
+}
+
+static void benchmark(const char *name, int x, int y, int width, int height, int rounds)
+{
+    for (int flip = 0; flip < 2; flip++) {
+        dev._flip = flip;
+        clock_t started = clock();
+        for (int i = 0; i < rounds; i++) _ssd1306_bitmaps(&dev, x, y, bitmap, width, height, false);
+        double seconds = (double)(clock() - started) / CLOCKS_PER_SEC;
+        printf("_ssd1306_bitmaps %s flip=%d: %.2f us, %.0f Mpixel/s\n", name, flip,
+               seconds / rounds * 1e6, (double)width * height * rounds / seconds / 1e6);
+    }
+}
+
+static void test_benchmark(void)
+{
+    benchmark("128x64 full screen", 0, 0, 128, 64, 20000);
+    benchmark("16x16 icon", 40, 16, 16, 16, 500000);
+    benchmark("16x16 icon y+3", 40, 19, 16, 16, 500000);
+
+    uint8_t image[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    const int rounds = 10000000;
+    clock_t started = clock();
+    for (int i = 0; i < rounds; i++) {
+        ssd1306_rotate_image(image, false);
+        image[0] += i;
+    }
+    double seconds = (double)(clock() - started) / CLOCKS_PER_SEC;
+    printf("ssd1306_rotate_image: %.1f ns\n", seconds / rounds * 1e9);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_random_bitmaps_match_the_reference);
+    RUN_TEST(test_width_must_be_a_multiple_of_8);
+    RUN_TEST(test_pixel_sets_one_bit);
+    RUN_TEST(test_rotate_image);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,302 @@
+#include <unity.h>
+#include <string.h>
+#include "ssd1306.h"
+
+// Frames drawn by the driver into the memory transport, compared pixel by pixel with what the panel should show
+
+static SSD1306_t dev;
+
+static const char *hi_frame[] = {
+    "XX..XX....XX....",
+    "XX..XX..........",
+    "XX..XX...XXX....",
+    "XXXXXX....XX....",
+    "XX..XX....XX....",
+    "XX..XX....XX....",
+    "XX..XX...XXXX...",
+    "................",
+};
+
+// Arrow of 16x8 pixels, rows top to bottom with the leftmost pixel in bit 7
+static uint8_t arrow[] = {
+    0x18, 0x00, 0x3C, 0x00, 0x7E, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0x7E, 0x00, 0x3C, 0x00, 0x18, 0x01,
+};
+
+static const char *arrow_frame[] = {
+    "...XX...........",
+    "..XXXX..........",
+    ".XXXXXX.........",
+    "XXXXXXXXXXXXXXXX",
+    "XXXXXXXXXXXXXXXX",
+    ".XXXXXX.........",
+    "..XXXX..........",
+    "...XX..........X",
+};
+
+static void start(int height, bool flip)
+{
+    memset(&dev, 0, sizeof(dev));
+    memory_init(&dev);
+    dev._flip = flip;
+    ssd1306_init(&dev, 128, height);
+    memory_reset_stats(&dev);
+}
+
+// Checks that the panel shows the frame at xpos, ypos and nothing else
+static void expect_frame(const char **frame, int rows, int xpos, int ypos)
+{
+    int lit = 0;
+    for (int row = 0; row < rows; row++) {
+        for (int col = 0; frame[row][col]; col++) {
+            bool expected = frame[row][col] == 'X';
+            lit += expected;
+            char message[48];
+            snprintf(message, sizeof(message), "pixel %d,%d", xpos + col, ypos + row);
+            TEST_ASSERT_EQUAL_MESSAGE(expected, memory_get_pixel(&dev, xpos + col, ypos + row), message);
+        }
+    }
+    int total = 0;
+    for (int y = 0; y < dev._height; y++) {
+        for (int x = 0; x < 128; x++) total += memory_get_pixel(&dev, x, y);
+    }
+    TEST_ASSERT_EQUAL_INT(lit, total);
+}
+
+// Every pixel of the panel matches the internal buffer
+static void expect_panel_shows_buffer(void)
+{
+    for (int y = 0; y < dev._height; y++) {
+        for (int x = 0; x < 128; x++) {
+            int bit = dev._flip ? 7 - y % 8 : y % 8;
+            int page = dev._flip ? dev._pages - 1 - y / 8 : y / 8;
+            TEST_ASSERT_EQUAL((dev._page[page]._segs[x] >> bit) & 1, memory_get_pixel(&dev, x, y));
+        }
+    }
+}
+
+static uint32_t flushed_bytes(void)
+{
+    uint32_t transfers, bytes;
+    memory_reset_stats(&dev);
+    ssd1306_flush(&dev);
+    memory_get_stats(&dev, &transfers, &bytes);
+    return bytes;
+}
+
+void setUp(void)
+{
+    start(64, false);
+}
+
+void tearDown(void)
+{
+    if (dev._back != NULL) {
+        free(dev._back->_out_buf);
+        free(dev._back);
+    }
+    free(dev._out_buf);
+    free(dev._transport_data);
+}
+
+static void test_text(void)
+{
+    ssd1306_display_text(&dev, 1, "Hi", 2, false);
+    expect_frame(hi_frame, 8, 0, 8);
+}
+
+static void test_text_on_a_flipped_panel(void)
+{
+    tearDown();
+    start(64, true);
+    ssd1306_display_text(&dev, 1, "Hi", 2, false);
+    expect_frame(hi_frame, 8, 0, 8);
+}
+
+static void test_text_on_a_32_line_panel(void)
+{
+    tearDown();
+    start(32, false);
+    ssd1306_display_text(&dev, 3, "Hi", 2, false);
+    expect_frame(hi_frame, 8, 0, 24);
+    // Pages past the panel are ignored
+    ssd1306_display_text(&dev, 4, "Hi", 2, false);
+    expect_frame(hi_frame, 8, 0, 24);
+}
+
+static void test_text_is_only_drawn_on_flush(void)
+{
+    _ssd1306_display_text(&dev, 1, "Hi", 2, false);
+    expect_frame(hi_frame, 0, 0, 0);
+    ssd1306_flush(&dev);
+    expect_frame(hi_frame, 8, 0, 8);
+}
+
+static void test_display_text_leaves_nothing_to_flush(void)
+{
+    ssd1306_display_text(&dev, 1, "Hi", 2, false);
+    TEST_ASSERT_EQUAL_UINT32(0, flushed_bytes());
+}
+
+static void test_display_text_keeps_other_changes_dirty(void)
+{
+    _ssd1306_pixel(&dev, 100, 8, false);
+    ssd1306_display_text(&dev, 1, "Hi", 2, false);
+    // Segments 16 to 100 are left, the line itself was sent
+    TEST_ASSERT_EQUAL_UINT32(85, flushed_bytes());
+    expect_panel_shows_buffer();
+}
+
+static void test_flush_sends_only_dirty_spans(void)
+{
+    _ssd1306_pixel(&dev, 5, 0, false);
+    _ssd1306_pixel(&dev, 120, 20, false);
+    uint32_t transfers, bytes;
+    ssd1306_flush(&dev);
+    memory_get_stats(&dev, &transfers, &bytes);
+    // Their bounding rectangle costs more than a second transfer, so the two spans go separately
+    TEST_ASSERT_EQUAL_UINT32(2, transfers);
+    TEST_ASSERT_EQUAL_UINT32(2, bytes);
+    expect_panel_shows_buffer();
+    TEST_ASSERT_EQUAL_UINT32(0, flushed_bytes());
+}
+
+static void test_flush_merges_close_spans(void)
+{
+    _ssd1306_pixel(&dev, 5, 0, false);
+    _ssd1306_pixel(&dev, 6, 8, false);
+    uint32_t transfers, bytes;
+    ssd1306_flush(&dev);
+    memory_get_stats(&dev, &transfers, &bytes);
+    TEST_ASSERT_EQUAL_UINT32(1, transfers);
+    TEST_ASSERT_EQUAL_UINT32(4, bytes);
+    expect_panel_shows_buffer();
+}
+
+static void test_bitmap(void)
+{
+    ssd1306_bitmaps(&dev, 3, 5, arrow, 16, 8, false);
+    expect_frame(arrow_frame, 8, 3, 5);
+}
+
+static void test_bitmap_on_a_flipped_panel(void)
+{
+    tearDown();
+    start(64, true);
+    ssd1306_bitmaps(&dev, 3, 5, arrow, 16, 8, false);
+    expect_frame(arrow_frame, 8, 3, 5);
+}
+
+static void test_bitmap_is_clipped(void)
+{
+    static const char *clipped[] = {
+        "XXX..XXX",
+        "XX....XX",
+        "X......X",
+        "........",
+    };
+    ssd1306_bitmaps(&dev, 120, 60, arrow, 16, 8, true);
+    expect_frame(clipped, 4, 120, 60);
+}
+
+static void test_bitmap_keeps_pixels_around_it(void)
+{
+    ssd1306_display_text(&dev, 0, "Hi", 2, false);
+    ssd1306_display_text(&dev, 1, "Hi", 2, false);
+    // Replaces rows 4 to 11 of the first 8 columns, only the first two are lit
+    uint8_t block[] = { 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0 };
+    ssd1306_bitmaps(&dev, 0, 4, block, 8, 8, false);
+    for (int y = 0; y < 16; y++) {
+        bool covered = y >= 4 && y < 12;
+        for (int x = 0; x < 16; x++) {
+            bool lit = covered && x < 8 ? x < 2 : hi_frame[y % 8][x] == 'X';
+            TEST_ASSERT_EQUAL(lit, memory_get_pixel(&dev, x, y));
+        }
+    }
+}
+
+static void test_init_again_keeps_the_transfer_buffer(void)
+{
+    uint8_t *out_buf = dev._out_buf;
+    TEST_ASSERT_NOT_NULL(out_buf);
+    ssd1306_init(&dev, 128, 64);
+    TEST_ASSERT_TRUE(out_buf == dev._out_buf);
+    ssd1306_resume(&dev, 128, 64);
+    TEST_ASSERT_TRUE(out_buf == dev._out_buf);
+}
+
+static void test_resume_resets_the_start_line(void)
+{
+    // Start line left three pages down by a scroll before the deep sleep
+    dev._scOffset = 3;
+    dev._transport->start_line(&dev, 24);
+    ssd1306_resume(&dev, 128, 64);
+    TEST_ASSERT_EQUAL_INT(0, dev._scOffset);
+
+    ssd1306_clear_screen(&dev, false);
+    ssd1306_display_text(&dev, 1, "Hi", 2, false);
+    expect_frame(hi_frame, 8, 0, 8);
+}
+
+// Pixels on pages 2 and 4 around segment 10, flushed as one rectangle that includes page 3
+static void flush_async_around_page_3(void)
+{
+    _ssd1306_pixel(&dev, 10, 20, false);
+    _ssd1306_pixel(&dev, 10, 36, false);
+    uint32_t transfers, bytes;
+    memory_reset_stats(&dev);
+    ssd1306_flush_async(&dev);
+    TEST_ASSERT_TRUE(ssd1306_flush_wait(&dev, 1000));
+    memory_get_stats(&dev, &transfers, &bytes);
+    TEST_ASSERT_EQUAL_UINT32(1, transfers);
+    TEST_ASSERT_EQUAL_UINT32(3, bytes);
+}
+
+static void test_async_flush_keeps_direct_text(void)
+{
+    TEST_ASSERT_TRUE(ssd1306_async_init(&dev, 1));
+    _ssd1306_display_text(&dev, 3, "Old", 3, false);
+    ssd1306_flush_async(&dev);
+    ssd1306_display_text(&dev, 3, "New", 3, false);
+    flush_async_around_page_3();
+    expect_panel_shows_buffer();
+}
+
+static void test_async_flush_keeps_direct_writes(void)
+{
+    TEST_ASSERT_TRUE(ssd1306_async_init(&dev, 1));
+    ssd1306_display_text_x3(&dev, 2, "AB", 2, false);
+    uint8_t image[16];
+    memset(image, 0xAA, sizeof(image));
+    ssd1306_display_image(&dev, 3, 4, image, sizeof(image));
+    flush_async_around_page_3();
+    expect_panel_shows_buffer();
+
+    // Scrolling the whole panel moves the start line, the back buffer has to move with it
+    ssd1306_software_scroll(&dev, 0, 7);
+    ssd1306_scroll_text(&dev, "One", 3, false);
+    ssd1306_scroll_text(&dev, "Two", 3, false);
+    flush_async_around_page_3();
+    expect_panel_shows_buffer();
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_text);
+    RUN_TEST(test_text_on_a_flipped_panel);
+    RUN_TEST(test_text_on_a_32_line_panel);
+    RUN_TEST(test_text_is_only_drawn_on_flush);
+    RUN_TEST(test_display_text_leaves_nothing_to_flush);
+    RUN_TEST(test_display_text_keeps_other_changes_dirty);
+    RUN_TEST(test_flush_sends_only_dirty_spans);
+    RUN_TEST(test_flush_merges_close_spans);
+    RUN_TEST(test_bitmap);
+    RUN_TEST(test_bitmap_on_a_flipped_panel);
+    RUN_TEST(test_bitmap_is_clipped);
+    RUN_TEST(test_bitmap_keeps_pixels_around_it);
+    RUN_TEST(test_init_again_keeps_the_transfer_buffer);
+    RUN_TEST(test_resume_resets_the_start_line);
+    RUN_TEST(test_async_flush_keeps_direct_text);
+    RUN_TEST(test_async_flush_keeps_direct_writes);
+    return UNITY_END();
+}
@@ -0,0 +1,176 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ssd1306.h"
+
+// ssd1306_scroll_text on the memory transport, the panel must show the scrolled lines whether the driver
+// moved the display start line or sent the moved pages
+
+#define SCROLLS 20
+
+static SSD1306_t dev;
+static SSD1306_t expected; // Drawn without scrolling
+
+static void start(SSD1306_t *device, int height, bool flip)
+{
+    memset(device, 0, sizeof(SSD1306_t));
+    memory_init(device);
+    device->_flip = flip;
+    ssd1306_init(device, 128, height);
+}
+
+static void stop(SSD1306_t *device)
+{
+    free(device->_out_buf);
+    free(device->_transport_data);
+}
+
+static void expect_same_panel(void)
+{
+    for (int y = 0; y < dev._height; y++) {
+        for (int x = 0; x < 128; x++) {
+            char message[48];
+            snprintf(message, sizeof(message), "pixel %d,%d", x, y);
+            TEST_ASSERT_EQUAL_MESSAGE(memory_get_pixel(&expected, x, y), memory_get_pixel(&dev, x, y), message);
+        }
+    }
+}
+
+static void line_text(char text[17], int line)
+{
+    snprintf(text, 17, "line %d", line);
+}
+
+// Scrolls SCROLLS lines through the pages start to end and checks the panel after every one
+static void scroll(int height, bool flip, int first, int last)
+{
+    start(&dev, height, flip);
+    start(&expected, height, flip);
+    ssd1306_software_scroll(&dev, first, last);
+    int direction = first <= last ? 1 : -1;
+    for (int line = 0; line < SCROLLS; line++) {
+        char text[17];
+        line_text(text, line);
+        ssd1306_scroll_text(&dev, text, strlen(text), line & 1);
+
+        // The newest line is on page first, older ones follow towards last
+        int count = abs(last - first) + 1;
+        for (int i = 0; i < count; i++) {
+            int page = first + i * direction;
+            ssd1306_clear_line(&expected, page, false);
+            if (line - i >= 0) {
+                line_text(text, line - i);
+                _ssd1306_display_text(&expected, page, text, strlen(text), (line - i) & 1);
+            }
+        }
+        ssd1306_flush(&expected);
+        expect_same_panel();
+    }
+    stop(&dev);
+    stop(&expected);
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static void test_full_screen_down(void)
+{
+    scroll(64, false, 0, 7);
+}
+
+static void test_full_screen_up(void)
+{
+    scroll(64, false, 7, 0);
+}
+
+static void test_full_screen_flipped(void)
+{
+    scroll(64, true, 0, 7);
+    scroll(64, true, 7, 0);
+}
+
+static void test_part_of_the_screen(void)
+{
+    scroll(64, false, 1, 6);
+    scroll(64, true, 6, 1);
+}
+
+static void test_32_line_panel(void)
+{
+    scroll(32, false, 0, 3);
+    scroll(32, true, 3, 0);
+    scroll(32, false, 1, 2);
+}
+
+static void test_pending_changes_move_with_their_page(void)
+{
+    start(&dev, 64, false);
+    ssd1306_software_scroll(&dev, 0, 7);
+    ssd1306_scroll_text(&dev, "first", 5, false);
+    _ssd1306_display_text(&dev, 4, "pending", 7, false);
+    ssd1306_scroll_text(&dev, "second", 6, false);
+    ssd1306_flush(&dev);
+
+    start(&expected, 64, false);
+    _ssd1306_display_text(&expected, 0, "second", 6, false);
+    _ssd1306_display_text(&expected, 1, "first", 5, false);
+    _ssd1306_display_text(&expected, 5, "pending", 7, false);
+    ssd1306_flush(&expected);
+    expect_same_panel();
+    stop(&dev);
+    stop(&expected);
+}
+
+// Transfers and data bytes of one scroll
+static void scroll_cost(int height, int first, int last, uint32_t *transfers, uint32_t *bytes)
+{
+    start(&dev, height, false);
+    ssd1306_software_scroll(&dev, first, last);
+    ssd1306_scroll_text(&dev, "warm up", 7, false);
+    memory_reset_stats(&dev);
+    ssd1306_scroll_text(&dev, "measured", 8, false);
+    memory_get_stats(&dev, transfers, bytes);
+    stop(&dev);
+}
+
+static void test_full_screen_moves_the_start_line(void)
+{
+    uint32_t transfers, bytes;
+    scroll_cost(64, 0, 7, &transfers, &bytes);
+    // The start line command and the new page
+    TEST_ASSERT_EQUAL_UINT32(2, transfers);
+    TEST_ASSERT_EQUAL_UINT32(128, bytes);
+}
+
+static void test_other_areas_send_the_moved_pages_at_once(void)
+{
+    uint32_t transfers, bytes;
+    scroll_cost(64, 1, 6, &transfers, &bytes);
+    TEST_ASSERT_EQUAL_UINT32(1, transfers);
+    TEST_ASSERT_EQUAL_UINT32(6 * 128, bytes);
+
+    // MUX 32 shows only half of the RAM, moving the start line would show rows outside the buffer
+    scroll_cost(32, 0, 3, &transfers, &bytes);
+    TEST_ASSERT_EQUAL_UINT32(1, transfers);
+    TEST_ASSERT_EQUAL_UINT32(4 * 128, bytes);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_full_screen_down);
+    RUN_TEST(test_full_screen_up);
+    RUN_TEST(test_full_screen_flipped);
+    RUN_TEST(test_part_of_the_screen);
+    RUN_TEST(test_32_line_panel);
+    RUN_TEST(test_pending_changes_move_with_their_page);
+    RUN_TEST(test_full_screen_moves_the_start_line);
+    RUN_TEST(test_other_areas_send_the_moved_pages_at_once);
+    return UNITY_END();
+}
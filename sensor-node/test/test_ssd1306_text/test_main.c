@@ -0,0 +1,191 @@
+#include <unity.h>
+#include <string.h>
+#include <time.h>
+#include "ssd1306.h"
+#include "font8x8_basic.h"
+#include "ssd1306_tables.h"
+
+// Text rendering from the tables of tools/gen_tables.py, checked against the font it was generated from
+
+static SSD1306_t dev;
+
+static uint8_t reverse_bits(uint8_t byte)
+{
+    uint8_t reversed = 0;
+    for (int bit = 0; bit < 8; bit++) {
+        if (byte & (1 << bit)) reversed |= 0x80 >> bit;
+    }
+    return reversed;
+}
+
+// Glyph pixel with the top row at y = 0 and the leftmost column at x = 0
+static bool glyph_pixel(char ch, int x, int y)
+{
+    return (font8x8_basic_tr[(uint8_t)ch & 0x7F][x] >> y) & 1;
+}
+
+static void start(bool flip)
+{
+    memset(&dev, 0, sizeof(dev));
+    memory_init(&dev);
+    dev._flip = flip;
+    ssd1306_init(&dev, 128, 64);
+}
+
+void setUp(void)
+{
+    start(false);
+}
+
+void tearDown(void)
+{
+    free(dev._out_buf);
+    free(dev._transport_data);
+}
+
+static void test_reverse_table(void)
+{
+    for (int byte = 0; byte < 256; byte++) {
+        TEST_ASSERT_EQUAL_HEX8(reverse_bits(byte), ssd1306_reverse_table[byte]);
+        TEST_ASSERT_EQUAL_HEX8(reverse_bits(byte), ssd1306_rotate_byte(byte));
+    }
+}
+
+static void test_x3_table(void)
+{
+    for (int byte = 0; byte < 256; byte++) {
+        for (int y = 0; y < 24; y++) {
+            TEST_ASSERT_EQUAL((byte >> (y / 3)) & 1, (ssd1306_x3_table[byte][y / 8] >> (y % 8)) & 1);
+        }
+    }
+}
+
+static void test_flipped_font(void)
+{
+    for (int code = 0; code < 128; code++) {
+        for (int col = 0; col < 8; col++) {
+            TEST_ASSERT_EQUAL_HEX8(reverse_bits(font8x8_basic_tr[code][col]), font8x8_basic_flip[code][col]);
+        }
+    }
+}
+
+static void test_rotated_font(void)
+{
+    for (int code = 0; code < 128; code++) {
+        uint8_t image[8];
+        memcpy(image, font8x8_basic_tr[code], 8);
+        ssd1306_rotate_image(image, false);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(image, font8x8_basic_rot[code], 8);
+    }
+}
+
+// Buffer bytes of a text line, built from the font the way the driver did before the tables
+static void expect_line(int page, const char *text, bool invert)
+{
+    for (int i = 0; i < 16; i++) {
+        for (int col = 0; col < 8; col++) {
+            uint8_t expected = font8x8_basic_tr[(uint8_t)text[i] & 0x7F][col];
+            if (invert) expected = ~expected;
+            if (dev._flip) expected = reverse_bits(expected);
+            TEST_ASSERT_EQUAL_HEX8(expected, dev._page[page]._segs[i * 8 + col]);
+        }
+    }
+}
+
+static void test_every_glyph(void)
+{
+    for (int mode = 0; mode < 4; mode++) {
+        tearDown();
+        start(mode & 2);
+        bool invert = mode & 1;
+        for (int first = 0; first < 128; first += 16) {
+            char text[16];
+            for (int i = 0; i < 16; i++) text[i] = first + i;
+            ssd1306_display_text(&dev, first / 16, text, 16, invert);
+            expect_line(first / 16, text, invert);
+        }
+    }
+}
+
+static void test_codes_above_127_use_the_font_below(void)
+{
+    char text[16];
+    for (int i = 0; i < 16; i++) text[i] = (char)(0xC1 + i);
+    ssd1306_display_text(&dev, 0, text, 16, false);
+    for (int i = 0; i < 16; i++) text[i] = 0x41 + i;
+    expect_line(0, text, false);
+}
+
+static void test_x3_text(void)
+{
+    ssd1306_display_text_x3(&dev, 2, "Ab9", 3, false);
+    for (int y = 0; y < 24; y++) {
+        for (int x = 0; x < 72; x++) {
+            TEST_ASSERT_EQUAL(glyph_pixel("Ab9"[x / 24], x % 24 / 3, y / 3), memory_get_pixel(&dev, x, 16 + y));
+        }
+    }
+}
+
+static void test_x3_text_stops_at_the_last_page(void)
+{
+    // Only the top two thirds fit, nothing may be written past the buffer
+    ssd1306_display_text_x3(&dev, 6, "W", 1, true);
+    for (int y = 0; y < 16; y++) {
+        for (int x = 0; x < 24; x++) {
+            TEST_ASSERT_EQUAL(!glyph_pixel('W', x / 3, y / 3), memory_get_pixel(&dev, x, 48 + y));
+        }
+    }
+}
+
+static void test_rotated_text(void)
+{
+    ssd1306_display_rotate_text(&dev, 100, "Hi", 2, false);
+    // The first character is on the bottom page, turned a quarter counterclockwise
+    for (int c = 0; c < 2; c++) {
+        int page = 7 - c;
+        for (int x = 0; x < 8; x++) {
+            for (int y = 0; y < 8; y++) {
+                TEST_ASSERT_EQUAL(glyph_pixel("Hi"[c], 7 - y, x), memory_get_pixel(&dev, 100 + x, page * 8 + y));
+            }
+        }
+    }
+}
+
+static void benchmark(bool flip, bool invert)
+{
+    tearDown();
+    start(flip);
+    char line[17] = "Moisture: 1234% ";
+    const int rounds = 200000;
+    clock_t started = clock();
+    for (int i = 0; i < rounds; i++) {
+        line[15] = 'a' + (i & 15);
+        _ssd1306_display_text(&dev, i & 7, line, 16, invert);
+    }
+    double seconds = (double)(clock() - started) / CLOCKS_PER_SEC;
+    printf("_ssd1306_display_text flip=%d invert=%d: %.1f Mchar/s\n", flip, invert, rounds * 16 / seconds / 1e6);
+}
+
+static void test_benchmark(void)
+{
+    benchmark(false, false);
+    benchmark(false, true);
+    benchmark(true, false);
+    benchmark(true, true);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_reverse_table);
+    RUN_TEST(test_x3_table);
+    RUN_TEST(test_flipped_font);
+    RUN_TEST(test_rotated_font);
+    RUN_TEST(test_every_glyph);
+    RUN_TEST(test_codes_above_127_use_the_font_below);
+    RUN_TEST(test_x3_text);
+    RUN_TEST(test_x3_text_stops_at_the_last_page);
+    RUN_TEST(test_rotated_text);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,108 @@
+#include <unity.h>
+#include "ulp_policy.h"
+
+// Checks the C model of ulp/moisture.S, the ULP program itself can only be checked on the device
+
+static ulp_policy_state_t state;
+
+void setUp(void)
+{
+    ulp_policy_reset(&state, 1000, 200, 3);
+}
+
+void tearDown(void)
+{
+}
+
+static void test_reset_starts_from_the_last_report(void)
+{
+    TEST_ASSERT_EQUAL_UINT16(1000, state.last_result);
+    TEST_ASSERT_EQUAL_UINT16(UINT16_MAX, state.min_value);
+    TEST_ASSERT_EQUAL_UINT16(0, state.max_value);
+    TEST_ASSERT_EQUAL_UINT16(1000, state.average);
+    TEST_ASSERT_EQUAL_UINT16(1000, state.report_value);
+    TEST_ASSERT_EQUAL_UINT16(200, state.wake_delta);
+    TEST_ASSERT_EQUAL_UINT16(3, state.samples_until_report);
+    TEST_ASSERT_EQUAL_UINT16(ULP_WAKE_NONE, state.wake_reason);
+}
+
+static void test_small_changes_do_not_wake(void)
+{
+    TEST_ASSERT_EQUAL(ULP_WAKE_NONE, ulp_policy_step(&state, 1200));
+    TEST_ASSERT_EQUAL(ULP_WAKE_NONE, ulp_policy_step(&state, 800));
+    TEST_ASSERT_EQUAL_UINT16(ULP_WAKE_NONE, state.wake_reason);
+}
+
+static void test_wakes_above_and_below_the_delta(void)
+{
+    TEST_ASSERT_EQUAL(ULP_WAKE_THRESHOLD, ulp_policy_step(&state, 1201));
+    TEST_ASSERT_EQUAL_UINT16(ULP_WAKE_THRESHOLD, state.wake_reason);
+
+    ulp_policy_reset(&state, 1000, 200, 3);
+    TEST_ASSERT_EQUAL(ULP_WAKE_THRESHOLD, ulp_policy_step(&state, 799));
+}
+
+static void test_threshold_wake_keeps_the_countdown(void)
+{
+    ulp_policy_step(&state, 1300);
+    TEST_ASSERT_EQUAL_UINT16(3, state.samples_until_report);
+}
+
+static void test_report_wake_after_the_interval(void)
+{
+    TEST_ASSERT_EQUAL(ULP_WAKE_NONE, ulp_policy_step(&state, 1000));
+    TEST_ASSERT_EQUAL(ULP_WAKE_NONE, ulp_policy_step(&state, 1000));
+    TEST_ASSERT_EQUAL(ULP_WAKE_REPORT, ulp_policy_step(&state, 1000));
+    TEST_ASSERT_EQUAL_UINT16(ULP_WAKE_REPORT, state.wake_reason);
+}
+
+static void test_missed_report_wake_is_retried(void)
+{
+    for (int i = 0; i < 3; i++) ulp_policy_step(&state, 1000);
+    TEST_ASSERT_EQUAL(ULP_WAKE_REPORT, ulp_policy_step(&state, 1000));
+    TEST_ASSERT_EQUAL_UINT16(0, state.samples_until_report);
+}
+
+static void test_tracks_min_max_and_average(void)
+{
+    ulp_policy_step(&state, 1080);
+    ulp_policy_step(&state, 960);
+    TEST_ASSERT_EQUAL_UINT16(960, state.last_result);
+    TEST_ASSERT_EQUAL_UINT16(960, state.min_value);
+    TEST_ASSERT_EQUAL_UINT16(1080, state.max_value);
+    // 1000 + 80/8 = 1010, then 1010 - 50/8 = 1004
+    TEST_ASSERT_EQUAL_UINT16(1004, state.average);
+}
+
+static void test_average_does_not_wrap(void)
+{
+    ulp_policy_reset(&state, 4095, 4095, 100);
+    for (int i = 0; i < 50; i++) ulp_policy_step(&state, 0);
+    TEST_ASSERT_LESS_THAN(4095, state.average);
+    for (int i = 0; i < 50; i++) ulp_policy_step(&state, 4095);
+    TEST_ASSERT_LESS_OR_EQUAL(4095, state.average);
+    TEST_ASSERT_GREATER_THAN(4000, state.average);
+}
+
+static void test_report_samples(void)
+{
+    TEST_ASSERT_EQUAL_UINT16(360, ulp_policy_report_samples(3600, 10));
+    TEST_ASSERT_EQUAL_UINT16(1, ulp_policy_report_samples(5, 10));
+    TEST_ASSERT_EQUAL_UINT16(1, ulp_policy_report_samples(0, 10));
+    TEST_ASSERT_EQUAL_UINT16(UINT16_MAX, ulp_policy_report_samples(UINT32_MAX, 1));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_reset_starts_from_the_last_report);
+    RUN_TEST(test_small_changes_do_not_wake);
+    RUN_TEST(test_wakes_above_and_below_the_delta);
+    RUN_TEST(test_threshold_wake_keeps_the_countdown);
+    RUN_TEST(test_report_wake_after_the_interval);
+    RUN_TEST(test_missed_report_wake_is_retried);
+    RUN_TEST(test_tracks_min_max_and_average);
+    RUN_TEST(test_average_does_not_wrap);
+    RUN_TEST(test_report_samples);
+    return UNITY_END();
+}